@@ -0,0 +1,92 @@
+#ifndef AUDIO_SIMD_H
+#define AUDIO_SIMD_H
+
+#ifdef TESTING
+#include "../tests/mock_3ds.h"
+#else
+#include <3ds/types.h>
+#endif
+
+#include <stddef.h>
+
+// Packed int16 kernels for the buffer fills. On the ARM11 (armv6k, no NEON) they use the DSP
+// extension (SSAT, SMULWB/SMULWT, PKHBT); elsewhere the C fallbacks compute the same bits, which
+// is what the host tests check. A stereo frame is one u32: left in the low halfword, right in the
+// high one, as NDSP expects.
+
+#if defined(__arm__) && defined(__ARM_ARCH_6K__) && !defined(__thumb__) && !defined(TESTING)
+#define AUDIO_SIMD_ARMV6 1
+#else
+#define AUDIO_SIMD_ARMV6 0
+#endif
+
+// Gains are Q16: 65536 is unity
+#define GAIN_Q16_ONE 65536
+
+static inline s32 ssat16(s32 x) {
+#if AUDIO_SIMD_ARMV6
+    s32 r;
+    __asm__("ssat %0, #16, %1" : "=r"(r) : "r"(x));
+    return r;
+#else
+    return x < -32768 ? -32768 : (x > 32767 ? 32767 : x);
+#endif
+}
+
+// Low halfword of lo and of hi into one frame
+static inline u32 packStereo16(s32 lo, s32 hi) {
+#if AUDIO_SIMD_ARMV6
+    u32 r;
+    __asm__("pkhbt %0, %1, %2, lsl #16" : "=r"(r) : "r"(lo), "r"(hi));
+    return r;
+#else
+    return ((u32) hi << 16) | ((u32) lo & 0xffff);
+#endif
+}
+
+// (gain * halfword) >> 16, the top 32 bits of the 48-bit product
+static inline s32 mulGainQ16Low(s32 gain, u32 frame) {
+#if AUDIO_SIMD_ARMV6
+    s32 r;
+    __asm__("smulwb %0, %1, %2" : "=r"(r) : "r"(gain), "r"(frame));
+    return r;
+#else
+    return (s32) (((int64_t) gain * (s16) (frame & 0xffff)) >> 16);
+#endif
+}
+
+static inline s32 mulGainQ16High(s32 gain, u32 frame) {
+#if AUDIO_SIMD_ARMV6
+    s32 r;
+    __asm__("smulwt %0, %1, %2" : "=r"(r) : "r"(gain), "r"(frame));
+    return r;
+#else
+    return (s32) (((int64_t) gain * (s16) (frame >> 16)) >> 16);
+#endif
+}
+
+// Same rounding as floatToInt16: scale, truncate towards zero, saturate
+static inline s16 floatToInt16Sat(float x) {
+    float scaled = x * 32768.0f;
+#if !AUDIO_SIMD_ARMV6
+    // VFP conversion saturates on its own, C leaves out of range values undefined
+    scaled = scaled < -32768.0f ? -32768.0f : (scaled > 32767.0f ? 32767.0f : scaled);
+#endif
+    return (s16) ssat16((s32) scaled);
+}
+
+static inline s32 floatToGainQ16(float gain) {
+    return (s32) (gain * (float) GAIN_Q16_ONE);
+}
+
+static inline u32 stereoGainQ16(u32 frame, s32 gain) {
+    return packStereo16(ssat16(mulGainQ16Low(gain, frame)), ssat16(mulGainQ16High(gain, frame)));
+}
+
+// Mono float in [-1, 1] to saturated int16, duplicated into both halves of each frame
+extern void floatToStereoInt16(const float *in, u32 *out, size_t n);
+
+// out[i] = in[i] with both channels scaled by gain[i] (Q16) and saturated
+extern void applyStereoGainQ16(const u32 *in, u32 *out, const s32 *gain, size_t n);
+
+#endif // AUDIO_SIMD_H
@@ -0,0 +1,69 @@
+#ifndef AUDIO_STATS_H
+#define AUDIO_STATS_H
+
+#ifdef TESTING
+#include "../tests/mock_3ds.h"
+#else
+#include <3ds/types.h>
+#endif
+
+#include "engine_constants.h"
+
+#include <stdbool.h>
+
+// Timing of the audio thread, written by the audio thread only and read by the UI without locks.
+// Durations are system ticks (SYSCLOCK_ARM11 per second) kept in log-spaced histograms: every
+// power of two is split into 2^STATS_SUB_BITS buckets, so percentiles are within 12.5%.
+#define STATS_SUB_BITS 3
+#define STATS_BUCKETS ((33 - STATS_SUB_BITS) << STATS_SUB_BITS)
+// CPU load is averaged over windows of this many ticks (half a second)
+#define STATS_LOAD_WINDOW (SYSCLOCK_ARM11 / 2)
+
+typedef enum {
+    STAGE_EVENTS,    // draining the event queue
+    STAGE_SEQUENCER, // advancing the clock and scheduling steps
+    STAGE_TRACK_0,   // rendering each track's block, one stage per track
+    STAGE_MIX_BUS = STAGE_TRACK_0 + N_TRACKS, // bus conversion and submit
+    STAGE_WAKE,                               // everything done in one wake-up
+    AUDIO_STAGE_COUNT
+} AudioStage;
+
+typedef struct {
+    u32 buckets[STATS_BUCKETS];
+    u32 count;
+    u32 max;
+} StageHistogram;
+
+typedef struct {
+    volatile u32   seq; // odd while the audio thread is updating
+    StageHistogram stages[AUDIO_STAGE_COUNT];
+    u32            underruns;     // blocks where a channel had played out all its wavebufs
+    u32            load_permille; // share of the last window the audio thread was busy
+    u32            block_ticks;   // duration of one block, the deadline for each wake-up
+    u32            skipped_blocks[N_TRACKS]; // silent blocks each track did not render
+    u64            window_start;
+    u64            window_busy;
+} AudioStats;
+
+extern AudioStats g_audio_stats;
+
+extern void audioStatsReset(AudioStats *stats);
+extern void audioStatsBeginWrite(AudioStats *stats);
+extern void audioStatsEndWrite(AudioStats *stats);
+extern void audioStatsRecord(AudioStats *stats, AudioStage stage, u64 ticks);
+// Adds one wake-up's busy time and refreshes the load once a window is complete
+extern void audioStatsAddBusy(AudioStats *stats, u64 busy, u64 now);
+// Copies a consistent view of stats into out. Returns false if the writer kept it busy.
+extern bool audioStatsSnapshot(const AudioStats *stats, AudioStats *out);
+
+extern u32 statsBucketIndex(u32 ticks);
+// Largest duration that falls in bucket idx
+extern u32 statsBucketUpper(u32 idx);
+// Upper bound of the bucket holding the given percentile (0-100), 0 when empty
+extern u32 statsPercentile(const StageHistogram *hist, u32 percent);
+
+static inline u32 statsTicksToUs(u32 ticks) {
+    return (u32) ((u64) ticks * 1000000 / SYSCLOCK_ARM11);
+}
+
+#endif // AUDIO_STATS_H
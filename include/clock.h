@@ -11,6 +11,10 @@
 #define MAXSUBDIVBEAT 8
 // note resolution (I'd recc 2 * 3 * maxSubDivisionNeeded, ex. 4 for 16th notes)
 #define STEPS_PER_BEAT (3 * MAXSUBDIVBEAT)
+// Ticks one audio block can report with their offsets (200 BPM in a 120 ms block is ~10)
+#define MAX_TICKS_PER_BLOCK 32
+// The clock counts rendered sample frames as Q32.32 fixed point
+#define CLOCK_FRAME_SHIFT 32
 
 typedef enum { STOPPED = 0, PLAYING = 1, PAUSED = 2 } ClockStatus;
 
@@ -23,11 +27,20 @@ typedef struct {
     ClockStatus status;
     int         cur_step;
     int         beats_per_bar;
+    int         latency_profile; // LatencyProfileId the audio thread is running
 } ClockDisplay;
 
-extern LightLock    g_clock_display_lock;
-extern ClockDisplay g_clock_display;
-extern void         clock_display_init(void);
+// Transport state as the audio thread last left it, published without a lock: the audio thread
+// is the only writer and readers retry while a publish is in progress
+typedef struct {
+    volatile u32 seq; // odd while the audio thread is updating
+    ClockDisplay display;
+} ClockDisplayState;
+
+extern ClockDisplayState g_clock_display;
+extern void              clockDisplayPublish(ClockDisplayState *state, const ClockDisplay *display);
+// Latest consistent transport state, or the last one this thread read if the writer kept it busy
+extern ClockDisplay clockDisplayRead(const ClockDisplayState *state);
 
 typedef struct {
     int bar;
@@ -37,23 +50,31 @@ typedef struct {
     int beats_per_bar;
 } MusicalTime;
 
+// Owned by the audio thread once it runs; other threads read the transport through
+// g_clock_display and change it with events
 typedef struct {
     float        bpm;
-    u64          last_tick_time;
-    u64          time_accumulator;
-    u64          ticks_per_step;
+    float        samplerate;      // frames per second of the audio the clock is driven by
+    u64          frames_per_step; // Q32.32 frames between two clock steps
+    u64          phase;           // Q32.32 frames since the last step
     ClockStatus  status;
     MusicalTime *barBeats;
 } Clock;
 
+// Frame a block offset from advanceClock falls on, rounded to the nearest one
+static inline u32 clockOffsetToFrames(u16 offset, u32 frames) {
+    return ((u32) offset * frames + 0x8000) >> 16;
+}
+
 extern void setBpm(Clock *clock, float bpm);
+extern void setClockSamplerate(Clock *clock, float samplerate);
 extern void setBeatsPerBar(Clock *clock, int beats);
-extern int  updateClock(Clock *clock);
-extern void resetClock(Clock *clock);
+extern int  advanceClock(Clock *clock, u32 frames, u16 *offsets, int max_ticks);
 extern void stopClock(Clock *clock);
 extern void pauseClock(Clock *clock);
 extern void resumeClock(Clock *clock);
 extern void startClock(Clock *clock);
 extern void resetBarBeats(Clock *clock);
+extern void advanceMusicalTime(Clock *clock);
 
 #endif // CLOCK_H
@@ -9,6 +9,9 @@
 bool handle_continuous_press(u32 kDown, u32 kHeld, u64 now, u32 key, u64 *timer,
                              const u64 delay_initial, const u64 delay_repeat);
 
+// Latency profile the audio thread is currently running
+int currentLatencyProfile(void);
+
 void sessionControllerHandleInput(SessionContext *ctx, u32 kDown, u32 kHeld, u64 now,
                                   bool *should_break_loop);
 
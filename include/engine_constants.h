@@ -3,6 +3,11 @@
 
 #define N_TRACKS 5
 
+// ARM11 data cache line
+#define CACHE_LINE_BYTES 32
+
+// Buffer sizes are for the longest latency profile (see latency.h), the running block size is
+// picked at runtime
 #define SAMPLERATE 32000
 #define SAMPLESPERBUF (SAMPLERATE * 120 / 1000)
 #define NCHANNELS 2
@@ -10,4 +15,19 @@
 #define OPUSSAMPLERATE 48000
 #define OPUSSAMPLESPERFBUF (OPUSSAMPLERATE * 120 / 1000)
 
+// Shared silence buffer queued for tracks with nothing to play, sized for the longest wavebuf
+#define SILENCE_SAMPLES OPUSSAMPLESPERFBUF
+
+// Instruments render in chunks of this many samples (envelopes, oscillators) before conversion
+#define RENDER_CHUNK 64
+
+// Mix bus mode: tracks are summed in software and played on a single NDSP channel.
+// All instruments then run at the bus rate. Build with -DUSE_MIX_BUS=1 to enable.
+#ifndef USE_MIX_BUS
+#define USE_MIX_BUS 0
+#endif
+#define MIXBUS_CHANNEL N_TRACKS
+#define MIXBUS_SAMPLERATE OPUSSAMPLERATE
+#define MIXBUS_SAMPLESPERBUF OPUSSAMPLESPERFBUF
+
 #endif // ENGINE_CONSTANTS_H
\ No newline at end of file
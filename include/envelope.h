@@ -7,6 +7,12 @@
 #include <3ds/types.h>
 #endif
 
+#include <stdbool.h>
+#include <stddef.h>
+
+// Per-step rounding budget used when emitting unchecked ramps (2^-23, twice the worst case)
+#define ENVELOPE_RAMP_ERROR 1.1920929e-7f
+
 typedef enum {
     ENVELOPE_STATE_IDLE,
     ENVELOPE_STATE_ATTACK,
@@ -34,6 +40,13 @@ extern void triggerEnvelope(Envelope *env);
 extern void updateEnvelope(Envelope *env, int attack_ms, int decay_ms, float sustain_level,
                            int release_ms, int dur_ms);
 
+static inline bool envelopeIsIdle(const Envelope *env) {
+    return !env || env->state == ENVELOPE_STATE_IDLE;
+}
+
+// Renders n samples, emitting each segment as a ramp instead of stepping the state machine
+extern void renderEnvelopeBlock(Envelope *env, float *out, size_t n);
+
 extern float nextEnvelopeSample(Envelope *env);
 
 extern void releaseEnvelope(Envelope *env);
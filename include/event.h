@@ -15,7 +15,6 @@ typedef enum {
     TRIGGER_STEP,
     UPDATE_STEP,
     CLOCK_TICK,
-    TOGGLE_STEP,
     SET_MUTE,
     RESET_SEQUENCERS,
     START_CLOCK,
@@ -24,7 +23,8 @@ typedef enum {
     RESUME_CLOCK,
     SET_BPM,
     SET_BEATS_PER_BAR,
-    SWAP_SAMPLE
+    SWAP_SAMPLE,
+    SET_LATENCY_PROFILE
 
 } EventType;
 
@@ -33,6 +33,13 @@ typedef struct {
     Sample *new_sample_ptr;
 } SwapSampleData;
 
+// What a TRIGGER_STEP or UPDATE_STEP applies: a copy of one step's record. It travels outside
+// the Event, which only names where it is, so queueing the small events stays cheap.
+typedef struct {
+    InstrumentType instrument_type;
+    StepParameters params;
+} StepPayload;
+
 typedef struct {
     EventType type;
     int       track_id; // Used by most events
@@ -40,14 +47,7 @@ typedef struct {
     union {
         // For TRIGGER_STEP, UPDATE_STEP
         struct {
-            TrackParameters base_params;
-            InstrumentType  instrument_type;
-            union {
-                SubSynthParameters    subsynth_params;
-                OpusSamplerParameters sampler_params;
-                FMSynthParameters     fm_synth_params;
-                NoiseSynthParameters  noise_synth_params;
-            } instrument_specific_params;
+            u32 payload; // slot in the queue's payload pool, see eventQueuePushStep
         } step_data;
 
         // For CLOCK_TICK
@@ -55,11 +55,6 @@ typedef struct {
             int ticks_to_process;
         } clock_data;
 
-        // For TOGGLE_STEP
-        struct {
-            int step_id;
-        } toggle_step_data;
-
         // For SET_MUTE
         struct {
             bool muted;
@@ -77,7 +72,14 @@ typedef struct {
 
         SwapSampleData swap_sample_data;
 
+        // For SET_LATENCY_PROFILE
+        struct {
+            LatencyProfileId profile;
+        } latency_data;
+
     } data;
 } Event;
 
+_Static_assert(sizeof(Event) <= 32, "events are queued by value and should stay small");
+
 #endif // EVENT_H
\ No newline at end of file
@@ -3,25 +3,36 @@
 
 #include <stdbool.h>
 #include <stdatomic.h>
+#include "engine_constants.h"
 #include "event.h"
 
 #ifdef TESTING
 #include "mock_3ds.h"
 #else
-#include <3ds/synchronization.h>
+#include <3ds/types.h>
 #endif
 
-#define EVENT_QUEUE_SIZE 32
+#define EVENT_QUEUE_SIZE 32    // power of two
+#define EVENT_PAYLOAD_SLOTS 32 // one bit each in free_payloads
+
+typedef struct {
+    atomic_uint sequence; // which lap of the ring the cell is ready for, see event_queue.c
+    Event       event;
+} EventCell;
 
 /**
- * @brief A thread-safe, multi-producer, single-consumer (MPSC) circular event queue.
- * The queue has a capacity of EVENT_QUEUE_SIZE - 1.
+ * @brief A lock-free, multi-producer, single-consumer (MPSC) ring of small events.
+ * The queue has a capacity of EVENT_QUEUE_SIZE. Step parameters do not fit in an Event; they
+ * wait in a pool of EVENT_PAYLOAD_SLOTS payloads that the step events name.
+ * Producers claim cells and payloads with compare-and-swap and never wait on each other or on
+ * the consumer: a full queue fails the push instead.
  */
 typedef struct {
-    Event      events[EVENT_QUEUE_SIZE];
-    atomic_int head;
-    atomic_int tail;
-    LightLock  lock;
+    _Alignas(CACHE_LINE_BYTES) atomic_uint head; // next cell a producer claims
+    _Alignas(CACHE_LINE_BYTES) atomic_uint tail; // next cell the consumer reads
+    _Alignas(CACHE_LINE_BYTES) EventCell cells[EVENT_QUEUE_SIZE];
+    atomic_uint free_payloads; // bit i set while payloads[i] is free
+    StepPayload payloads[EVENT_PAYLOAD_SLOTS];
 } EventQueue;
 
 /**
@@ -32,13 +43,25 @@ typedef struct {
 void eventQueueInit(EventQueue *q);
 
 /**
- * @brief Pushes an event to the queue.
+ * @brief Pushes an event to the queue. Step events go through eventQueuePushStep instead.
  * @param q The event queue.
  * @param e The event to push.
  * @return true if the event was pushed successfully, false if the queue was full.
  */
 bool eventQueuePush(EventQueue *q, Event e);
 
+/**
+ * @brief Copies a step's parameters into the payload pool and pushes a step event naming them.
+ * @param q The event queue.
+ * @param type TRIGGER_STEP or UPDATE_STEP.
+ * @param track_id The track the step belongs to.
+ * @param instrument_type The instrument reading the parameters.
+ * @param params The step's record.
+ * @return true if the event was pushed, false if the queue or the payload pool was full.
+ */
+bool eventQueuePushStep(EventQueue *q, EventType type, int track_id,
+                        InstrumentType instrument_type, const StepParameters *params);
+
 /**
  * @brief Pops an event from the queue.
  * @param q The event queue.
@@ -48,4 +71,19 @@ bool eventQueuePush(EventQueue *q, Event e);
  */
 bool eventQueuePop(EventQueue *q, Event *e);
 
+/**
+ * @brief The payload a popped TRIGGER_STEP or UPDATE_STEP names, read in place.
+ * @param q The event queue.
+ * @param e The popped step event.
+ * @return The payload, valid until eventQueueReleasePayload is called for the event.
+ */
+const StepPayload *eventQueuePayload(const EventQueue *q, const Event *e);
+
+/**
+ * @brief Hands a popped step event's payload back to the producers.
+ * @param q The event queue.
+ * @param e The popped step event, whose payload must not be read afterwards.
+ */
+void eventQueueReleasePayload(EventQueue *q, const Event *e);
+
 #endif // EVENT_QUEUE_H
@@ -2,21 +2,63 @@
 #define FM_OSC_H
 
 #include "envelope.h"
-#include "polybleposc.h"
+#include "sine_table.h"
+
+// Four-operator phase modulation synth. Every operator is an integer phase accumulator reading the
+// shared sine table; modulators offset the phase of the operators below them, as chosen by the
+// algorithm. Operator 0 is always a carrier and modulators always sit above what they modulate, so
+// one pass from the top operator down renders a sample.
+
+#define FM_OPERATORS 4
+#define FM_MAX_MOD_INDEX 8.0f // phase deviation in radians of a full-scale modulator at index 1
+
+typedef enum {
+    FM_ALGO_STACK,          // 4 > 3 > 2 > 1
+    FM_ALGO_TWIN_MODS,      // (3 + 4) > 2 > 1
+    FM_ALGO_BRANCH,         // (2 + 4 > 3) > 1
+    FM_ALGO_THREE_MODS,     // (2 + 3 + 4) > 1
+    FM_ALGO_TWO_STACKS,     // 2 > 1, 4 > 3
+    FM_ALGO_ONE_TO_THREE,   // 4 > (1, 2, 3)
+    FM_ALGO_STACK_PLUS_ONE, // 3 > 2 > 1, 4
+    FM_ALGO_ADDITIVE,       // 1, 2, 3, 4
+    FM_ALGORITHM_COUNT
+} FMAlgorithm;
+
+extern const char *fm_algorithm_names[];
 
 typedef struct {
-    PolyBLEPOscillator *carrier;
-    PolyBLEPOscillator *modulator;
-    Envelope           *mod_envelope;
-    float               mod_index;
-    float               mod_depth;
-    float               base_frequency;
+    Envelope env;
+    u32      phase;
+    u32      phase_inc;
+    float    ratio; // of the synth's base frequency
+    float    level; // 0..1, as a modulator full level deviates by the synth's mod index
 } FMOperator;
 
-extern void  FMOpSetCarrierFrequency(FMOperator *op, float freq);
-extern void  FMOpSetModRatio(FMOperator *op, float ratio);
-extern float nextFMOscillatorSample(FMOperator *op);
-extern void  FMOpSetModIndex(FMOperator *op, float index);
-extern void  FMOpSetModDepth(FMOperator *op, float depth);
+typedef struct {
+    FMOperator  ops[FM_OPERATORS];
+    FMAlgorithm algorithm;
+    float       samplerate;
+    float       base_frequency;
+    float       mod_index; // radians
+    float       feedback;  // self-modulation of the top operator, 0..1
+    s32         feedback_hist[2];
+} FMSynth;
+
+extern void initFMSynth(FMSynth *fm, float samplerate);
+extern void FMSetFrequency(FMSynth *fm, float freq);
+extern void FMSetOperator(FMSynth *fm, int op, float ratio, float level);
+extern void FMSetAlgorithm(FMSynth *fm, int algorithm);
+extern void FMSetModIndex(FMSynth *fm, float index);
+extern void FMSetFeedback(FMSynth *fm, float feedback);
+extern bool FMIsCarrier(const FMSynth *fm, int op);
+// Restarts every operator envelope and resets the phases, so each note starts the same way
+extern void triggerFMSynth(FMSynth *fm);
+// True once every carrier envelope is idle, the modulators alone are inaudible
+extern bool FMIsIdle(const FMSynth *fm);
+
+// Renders n <= RENDER_CHUNK mono samples, the envelopes rendered once per block
+extern void renderFMBlock(FMSynth *fm, s16 *out, size_t n);
+// Same output one sample at a time, stepping each envelope per sample
+extern float nextFMOscillatorSample(FMSynth *fm);
 
 #endif // FM_OSC_H
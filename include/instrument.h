@@ -0,0 +1,27 @@
+#ifndef INSTRUMENT_H
+#define INSTRUMENT_H
+
+#ifdef TESTING
+#include "../tests/mock_3ds.h"
+#else
+#include <3ds/types.h>
+#endif
+
+#include <stdbool.h>
+#include <stddef.h>
+
+// Dispatch over the instrument behind a track, shared by the audio thread and host tools. The
+// instrument pointer is a SubSynth, Sampler, FMSynth or NoiseSynth, params the matching
+// *Parameters struct from track_parameters.h.
+
+typedef enum { SUB_SYNTH, OPUS_SAMPLER, FM_SYNTH, NOISE_SYNTH } InstrumentType;
+
+extern bool instrumentIsSilent(InstrumentType type, const void *instrument);
+// Renders n stereo frames into dest, zeros if the instrument is silent
+extern void renderInstrumentAudio(InstrumentType type, void *instrument, u32 *dest, size_t n);
+// Applies a step's parameters, restarting the envelopes when retrigger is set. Choosing a
+// sampler's sample is left to the caller, which owns the sample references.
+extern void applyInstrumentStep(InstrumentType type, void *instrument, const void *params,
+                                bool retrigger);
+
+#endif // INSTRUMENT_H
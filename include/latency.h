@@ -0,0 +1,44 @@
+#ifndef LATENCY_H
+#define LATENCY_H
+
+#ifdef TESTING
+#include "../tests/mock_3ds.h"
+#else
+#include <3ds/types.h>
+#include <3ds/ndsp/ndsp.h>
+#endif
+
+#include <stdbool.h>
+
+// Output latency is set by how long each wavebuf is and how many of them are queued per channel.
+// Audio buffers are allocated once for the deepest profile, switching only re-slices them.
+#define MAX_WAVEBUFS 4
+#define LATENCY_MAX_QUEUED_MS 240
+
+typedef enum {
+    LATENCY_10MS,
+    LATENCY_20MS,
+    LATENCY_40MS,
+    LATENCY_120MS,
+    LATENCY_PROFILE_COUNT
+} LatencyProfileId;
+
+#define DEFAULT_LATENCY_PROFILE LATENCY_40MS
+
+typedef struct {
+    const char *name;
+    u32         block_ms;
+    int         n_wavebufs;
+} LatencyProfile;
+
+extern const LatencyProfile latency_profiles[LATENCY_PROFILE_COUNT];
+
+extern u32  latencyBlockFrames(LatencyProfileId id, float rate);
+// Slices buffer into n_wavebufs consecutive blocks of block_frames, zeroes them and queues them all
+// on chan_id. Anything still queued on the channel must have been cleared first.
+extern void queueWaveBufs(int chan_id, ndspWaveBuf *waveBufs, u32 *buffer, u32 block_frames,
+                          int n_wavebufs);
+// True when every wavebuf has played out and the channel has nothing left to play
+extern bool waveBufsStarved(const ndspWaveBuf *waveBufs, int n_wavebufs);
+
+#endif // LATENCY_H
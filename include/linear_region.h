@@ -0,0 +1,64 @@
+#ifndef LINEAR_REGION_H
+#define LINEAR_REGION_H
+
+#ifdef TESTING
+#include "../tests/mock_3ds.h"
+#else
+#include <3ds/types.h>
+#endif
+
+#include <stdbool.h>
+#include <stddef.h>
+
+// Accounting for the linear heap, the only memory NDSP can read and the scarcest on the system.
+// Every block is charged to the subsystem that asked for it, so the current and peak use of
+// each can be read back (and budgeted by the host tests). Main thread only.
+//
+// A LinearRegion is one tagged block handed out by bumping an offset, and released all at once
+// by a reset, for data that lives and dies together.
+
+typedef enum {
+    LINEAR_TAG_SAMPLES,
+    LINEAR_TAG_INSTRUMENTS,
+    LINEAR_TAG_BUFFERS,
+    LINEAR_TAG_UI,
+    LINEAR_TAG_COUNT
+} LinearTag;
+
+extern const char *linear_tag_names[];
+
+typedef struct {
+    size_t in_use; // bytes
+    size_t peak;
+    u32    n_blocks;
+} LinearUsage;
+
+extern void *linearAllocTagged(LinearTag tag, size_t size);
+extern void  linearFreeTagged(LinearTag tag, void *ptr);
+
+extern LinearUsage linearUsage(LinearTag tag);
+extern size_t      linearUsageTotal(void);
+// Drops each tag's peak to what it currently uses
+extern void linearUsageResetPeaks(void);
+
+typedef struct {
+    u8       *base;
+    size_t    capacity;
+    size_t    used;
+    size_t    peak;
+    LinearTag tag;
+} LinearRegion;
+
+extern bool  linearRegionInit(LinearRegion *region, LinearTag tag, size_t capacity);
+// NULL once the region is full. align must be a power of two.
+extern void *linearRegionAlloc(LinearRegion *region, size_t size, size_t align);
+extern void  linearRegionReset(LinearRegion *region);
+extern void  linearRegionDestroy(LinearRegion *region);
+
+#ifdef TESTING
+// Host heap stand-in: allocations fail once the tags together would hold more than capacity
+// bytes, 0 for no limit
+extern void linearMockSetCapacity(size_t capacity);
+#endif
+
+#endif // LINEAR_REGION_H
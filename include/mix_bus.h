@@ -0,0 +1,45 @@
+#ifndef MIX_BUS_H
+#define MIX_BUS_H
+
+#ifdef TESTING
+#include "../tests/mock_3ds.h"
+#else
+#include <3ds/types.h>
+#include <3ds/ndsp/ndsp.h>
+#endif
+
+#include "latency.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+
+// Software master bus: every track is summed into accum_buffer (interleaved stereo floats, with
+// the track's gain/pan already applied), then converted, flushed and queued on one NDSP channel.
+// audio_buffer must be DSP visible (linear heap), hold LATENCY_MAX_QUEUED_MS of frames and stays
+// the caller's to free; accum_buffer comes from malloc, holds one num_samples block and is freed
+// by MixBus_deinit.
+
+typedef struct {
+    int          chan_id;
+    float        mix[12];
+    ndspWaveBuf  waveBuf[MAX_WAVEBUFS];
+    int          n_wavebufs;
+    u32         *audioBuffer;
+    float       *accumBuffer;
+    size_t       samples_per_buf;
+    float        rate;
+    int          fillBlock;
+} MixBus;
+
+extern void   initializeMixBus(MixBus *bus, int chan_id, float rate, u32 num_samples,
+                               u32 *audio_buffer, float *accum_buffer);
+extern bool   mixBusReady(MixBus *bus);
+extern float *mixBusBegin(MixBus *bus);
+extern void   mixBusSubmit(MixBus *bus);
+// Queues an already zeroed and flushed buffer (at least samples_per_buf frames) instead of mixing
+extern void   mixBusSubmitSilence(MixBus *bus, const u32 *silence);
+// Restarts the bus with the profile's block size and wavebuf count, never longer than num_samples
+extern void   mixBusSetLatency(MixBus *bus, LatencyProfileId profile);
+extern void   MixBus_deinit(MixBus *bus);
+
+#endif // MIX_BUS_H
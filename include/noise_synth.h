@@ -10,11 +10,40 @@
 #include <3ds/ndsp/ndsp.h>
 #endif
 
+// Game Boy style LFSR noise. The 15-bit mode is white noise with a 32767 sample period; the 7-bit
+// mode only runs the bottom of the register, a 127 sample period that sounds metallic.
+typedef enum { NOISE_MODE_15BIT, NOISE_MODE_7BIT, NOISE_MODE_COUNT } NoiseMode;
+
+#define NOISE_MAX_RATE_DIV 64
+
+extern const char *noise_mode_names[];
+
 typedef struct {
     Envelope *env;
     u16       lfsr_register;
+    NoiseMode mode;
+    u16       rate_div; // samples each LFSR output is held for, 0 and 1 both mean every sample
+
+    // Playback state: LFSR outputs generated a word at a time, and the value being held
+    u32 bits;
+    u8  bits_left;
+    u8  held_bit;
+    u16 hold;
 } NoiseSynth;
 
+void setNoiseMode(NoiseSynth *noiseSynth, NoiseMode mode);
+void setNoiseRateDiv(NoiseSynth *noiseSynth, int rate_div);
+
+// Next LFSR output bit, one shift at a time: the reference the word-wide generator must match
+u8 stepNoiseLfsr(NoiseSynth *noiseSynth);
+
+bool isNoiseSynthSilent(const NoiseSynth *noiseSynth);
+
+void renderNoiseSynthAudio(u32 *dest, size_t size, NoiseSynth *noiseSynth);
+
 void fillNoiseSynthAudiobuffer(ndspWaveBuf *waveBuf, size_t size, NoiseSynth *noiseSynth);
 
+void mixNoiseSynthAudiobuffer(float *mix_buf, size_t size, NoiseSynth *noiseSynth, float gain_l,
+                              float gain_r);
+
 #endif // NOISE_SYNTH_H
@@ -0,0 +1,48 @@
+#ifndef PARAM_SMOOTHER_H
+#define PARAM_SMOOTHER_H
+
+#include "engine_constants.h"
+
+#ifdef TESTING
+#include "../tests/mock_3ds.h"
+#else
+#include <3ds/types.h>
+#endif
+
+#include <stdbool.h>
+#include <stddef.h>
+
+// Track volume and pan, applied in the fill loop. A step that moves a gain by more than
+// GAIN_RAMP_THRESHOLD ramps to it over GAIN_RAMP_MS instead of jumping, smaller changes (and
+// repeats of the current values) cost nothing.
+
+#define GAIN_RAMP_MS 5
+#define GAIN_RAMP_THRESHOLD (1.0f / 256.0f)
+
+typedef struct {
+    float gain[NCHANNELS]; // applied to the next frame
+    float target[NCHANNELS];
+    float step[NCHANNELS]; // per frame while ramping
+    u32   ramp_frames;
+    u32   frames_left;
+} GainSmoother;
+
+// Constant-power pan law, pan from -1 (L) to 1 (R), read from the sine table
+extern void panLawGains(float pan, float volume, float *gain_l, float *gain_r);
+
+extern void initGainSmoother(GainSmoother *smoother, float rate, float gain_l, float gain_r);
+
+// Returns false when the gains were already there
+extern bool gainSmootherSetTarget(GainSmoother *smoother, float gain_l, float gain_r);
+
+static inline bool gainSmootherIsRamping(const GainSmoother *smoother) {
+    return smoother->frames_left > 0;
+}
+
+// Scales n stereo int16 frames in place, following the ramp
+extern void applyGainSmoother(GainSmoother *smoother, u32 *frames, size_t n);
+
+// Adds n stereo int16 frames into the float mix buffer, following the ramp
+extern void mixGainSmoother(GainSmoother *smoother, float *mix_buf, const u32 *frames, size_t n);
+
+#endif // PARAM_SMOOTHER_H
@@ -2,6 +2,7 @@
 #define POLYBLEPOSC_H
 
 #include "audio_utils.h"
+#include "sine_table.h"
 
 #include <math.h>
 
@@ -15,8 +16,8 @@ typedef struct {
     float    frequency;
     float    samplerate;
     Waveform waveform;
-    float    phase_inc;
-    float    phase;
+    u32      phase_inc; // 2^32 per cycle, wraps for free
+    u32      phase;
     float    pulse_width;
 } PolyBLEPOscillator;
 
@@ -27,6 +28,9 @@ extern void setOscFrequency(PolyBLEPOscillator *osc, float frequency);
 
 extern float nextOscillatorSample(PolyBLEPOscillator *osc);
 
+// Same output as n calls to nextOscillatorSample, with the waveform dispatch done once per block
+extern void renderOscillatorBlock(PolyBLEPOscillator *osc, float *out, size_t n);
+
 extern float polyBLEP(PolyBLEPOscillator *osc, float t);
 
 #endif // POLYBLEPOSC_H
\ No newline at end of file
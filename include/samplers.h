@@ -27,6 +27,13 @@ typedef struct {
 
 bool samplerIsLooping(Sampler *sampler);
 
+bool isSamplerSilent(const Sampler *sampler);
+
+void renderSamplerAudio(u32 *dest, size_t size, Sampler *sampler);
+
 void fillSamplerAudioBuffer(ndspWaveBuf *waveBuf_, size_t size, Sampler *sampler);
 
+void mixSamplerAudioBuffer(float *mix_buf, size_t size, Sampler *sampler, float gain_l,
+                           float gain_r);
+
 #endif // SAMPLERS_H
\ No newline at end of file
@@ -10,26 +10,92 @@
 #include "clock.h"
 #include "track_parameters.h"
 
+#include <stdatomic.h>
+
 #define MAXSEQUENCELENGTH                                                                          \
     (STEPS_PER_BEAT * MAXSUBDIVBEAT) // 384, should be more than enough for most use cases
 
+#define SEQ_ACTIVE_WORDS ((MAXSEQUENCELENGTH + 31) / 32)
+
+#define SEQ_RETIRED_SLOTS 4 // snapshots waiting for the main thread to reclaim them, plus one
+
+// One version of a track's steps. The step table is dense: whether a step plays is one bit, and
+// its parameters are a fixed-size record at the same index, so a tick tests a word and, for a
+// live step, reads one record. There is room for MAXSEQUENCELENGTH steps whatever the length, so
+// changing it never allocates; steps past the end keep their records for when it grows again.
 typedef struct {
-    bool             active;
-    TrackParameters *data;
-} SeqStep;
+    int             n_beats;
+    int             steps_per_beat;
+    u32             active[SEQ_ACTIVE_WORDS]; // bit i of word i / 32 set when step i plays
+    StepParameters *params;                   // MAXSEQUENCELENGTH records
+} Pattern;
 
+// A track's pattern shared between the UI and the audio thread, read-copy-update style. The main
+// thread edits its private copy and publishes it as a new snapshot with one atomic pointer swap.
+// The audio thread picks the newest snapshot up between steps and never writes one; snapshots it
+// has moved past go back to the main thread through a cleanup queue, as released samples do.
 typedef struct {
-    int              n_beats;
-    int              steps_per_beat;
-    size_t           cur_step;
-    SeqStep         *steps;
-    void            *instrument_params_array;
-    TrackParameters *track_params_array;
+    // Main thread
+    Pattern *edit;
+    Pattern *spare; // reclaimed snapshot the next publish copies into, so two take turns
+
+    _Atomic(Pattern *) pending; // published, not yet picked up by the audio thread
+
+    // Audio thread
+    const Pattern *playing;
+    size_t         cur_step;
+
+    // SPSC, audio thread to main thread
+    Pattern   *retired[SEQ_RETIRED_SLOTS];
+    atomic_int retired_write;
+    atomic_int retired_read;
 } Sequencer;
 
-extern void    updateSeqLength(Sequencer *seq, size_t newLength);
-extern SeqStep updateSequencer(Sequencer *seq);
-extern void    setSteps(Sequencer *seq, SeqStep *steps);
-extern void    cleanupSequencer(Sequencer *seq);
+static inline size_t patternLength(const Pattern *pattern) {
+    return (size_t) (pattern->n_beats * pattern->steps_per_beat);
+}
+
+static inline bool patternStepActive(const Pattern *pattern, size_t step) {
+    return (pattern->active[step / 32] >> (step % 32)) & 1u;
+}
+
+extern void patternSetStepActive(Pattern *pattern, size_t step, bool active);
+extern void patternToggleStep(Pattern *pattern, size_t step);
+// NULL when step is past the end of the pattern
+extern StepParameters *patternStepParams(Pattern *pattern, size_t step);
+
+// Main thread. Fills every step with defaults, makes the first n_steps the pattern in four steps
+// a beat and has the audio thread start on it, before that thread runs.
+extern bool initSequencer(Sequencer *seq, size_t n_steps, const StepParameters *defaults);
+// Main thread. Changes the length of the edit copy in place: steps it brings back play as they
+// were last left
+extern void updateSeqLength(Sequencer *seq, size_t newLength);
+// Main thread. Copies the edit copy into a snapshot and hands it to the audio thread. Edits made
+// since the last call take effect together; false if no snapshot could be allocated.
+extern bool sequencerPublish(Sequencer *seq);
+// Main thread. Takes back the snapshots the audio thread is done with.
+extern void sequencerReclaim(Sequencer *seq);
+
+// Heap taken by pattern blocks across every sequencer. Blocks are only allocated and freed on
+// the main thread, so these are plain counters.
+typedef struct {
+    size_t in_use; // bytes
+    size_t peak;
+    u32    n_blocks;
+} SequencerUsage;
+
+extern SequencerUsage sequencerUsage(void);
+// Drops the peak to what is currently in use
+extern void sequencerUsageResetPeak(void);
+
+// Audio thread. Advances one step of the playing pattern, first switching to a newly published
+// one, and returns the parameters of the step passed, NULL if it does not play
+extern const StepParameters *updateSequencer(Sequencer *seq);
+extern bool                  sequencerStepDue(const Sequencer *seq, int clock_steps);
+// Clock step the step after one on clock_steps falls on, on the grid sequencerStepDue follows.
+// 0 when the playing pattern has no steps to fire.
+extern int sequencerNextStepTick(const Sequencer *seq, int clock_steps);
+// Frees the edit copy and every snapshot, once the audio thread no longer runs
+extern void cleanupSequencer(Sequencer *seq);
 
 #endif // SEQUENCER_H
\ No newline at end of file
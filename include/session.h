@@ -35,6 +35,7 @@ struct Session {
     TopScreenView    main_screen_view;
     BottomScreenView touch_screen_view;
     BottomScreenView previous_touch_screen_view;
+    bool             show_audio_stats; // audio thread timing overlay, toggled with SELECT
 };
 typedef struct Session Session;
 
@@ -64,16 +65,15 @@ typedef struct {
 
     // Pointers to global state
     Track                 *tracks;
-    Clock                 *clock;
     EventQueue            *event_queue;
     SampleBank            *sample_bank;
     SampleBrowser         *sample_browser;
+    StepParameters        *editing_step; // the step record being edited, the next five view it
     TrackParameters       *editing_step_params;
     SubSynthParameters    *editing_subsynth_params;
     OpusSamplerParameters *editing_sampler_params;
     FMSynthParameters     *editing_fm_synth_params;
     NoiseSynthParameters  *editing_noise_synth_params;
-    LightLock             *clock_lock;
 
     int           last_edited_param_unique_id;
     ParameterType last_edited_param_type;
@@ -0,0 +1,57 @@
+#ifndef SINE_TABLE_H
+#define SINE_TABLE_H
+
+#ifdef TESTING
+#include "../tests/mock_3ds.h"
+#else
+#include <3ds/types.h>
+#endif
+
+// One sine period as Q15 values (2 KB, stays in cache), plus a guard entry so interpolation never
+// has to wrap. Oscillators keep their phase in a u32 where 2^32 is one cycle: the top
+// SINE_TABLE_BITS select the entry and the next 15 bits interpolate towards the following one.
+
+#define SINE_TABLE_BITS 10
+#define SINE_TABLE_SIZE (1 << SINE_TABLE_BITS)
+#define SINE_FRAC_BITS (32 - SINE_TABLE_BITS)
+
+// One full cycle of a u32 phase accumulator
+#define PHASE_RANGE 4294967296.0f
+
+extern s16 sine_table[SINE_TABLE_SIZE + 1];
+
+extern void initSineTable(void);
+
+static inline float sineFromPhase(u32 phase) {
+    u32   idx  = phase >> SINE_FRAC_BITS;
+    float frac = (float) ((phase >> (SINE_FRAC_BITS - 15)) & 0x7fff) * (1.0f / 32768.0f);
+    float a    = sine_table[idx];
+    float b    = sine_table[idx + 1];
+    return (a + (b - a) * frac) * (1.0f / 32767.0f);
+}
+
+// Integer version of sineFromPhase, Q15 out
+static inline s32 sineQ15FromPhase(u32 phase) {
+    u32 idx  = phase >> SINE_FRAC_BITS;
+    s32 frac = (phase >> (SINE_FRAC_BITS - 15)) & 0x7fff;
+    s32 a    = sine_table[idx];
+    return a + (((sine_table[idx + 1] - a) * frac) >> 15);
+}
+
+// Phase position in [0, 1), exact for every u32 phase
+static inline float phaseToUnit(u32 phase) {
+    return (float) (phase >> 8) * (1.0f / 16777216.0f);
+}
+
+// Inverse of phaseToUnit for x in [0, 1], without overflowing at 1
+static inline u32 unitToPhase(float x) {
+    if (x <= 0.0f) {
+        return 0;
+    }
+    if (x >= 1.0f) {
+        return 0xffffffffu;
+    }
+    return (u32) (x * 16777216.0f) << 8;
+}
+
+#endif // SINE_TABLE_H
@@ -0,0 +1,32 @@
+#ifndef STEP_SCHEDULER_H
+#define STEP_SCHEDULER_H
+
+#include "engine_constants.h"
+
+#include <limits.h>
+#include <stdbool.h>
+
+// The clock step each track's sequencer fires on next, kept in a min-heap so the audio thread
+// goes straight from one due step to the next instead of asking every track on every clock step
+typedef struct {
+    int tick;  // clock step (MusicalTime.steps) the track's next step falls on
+    int track; // index into the tracks array, breaks ties between steps on the same tick
+} ScheduledTrack;
+
+typedef struct {
+    ScheduledTrack heap[N_TRACKS];
+    int            count;
+} StepScheduler;
+
+extern void stepSchedulerClear(StepScheduler *sched);
+// Schedules a track's next step on the given clock step. Returns false when the heap is full.
+extern bool stepSchedulerPush(StepScheduler *sched, int track, int tick);
+// Removes and returns the track whose step falls on or before tick, or -1 when none is due
+extern int stepSchedulerPopDue(StepScheduler *sched, int tick);
+
+// Clock step the earliest scheduled step falls on, INT_MAX when nothing is scheduled
+static inline int stepSchedulerNextTick(const StepScheduler *sched) {
+    return sched->count > 0 ? sched->heap[0].tick : INT_MAX;
+}
+
+#endif // STEP_SCHEDULER_H
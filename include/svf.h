@@ -0,0 +1,77 @@
+#ifndef SVF_H
+#define SVF_H
+
+#include "engine_constants.h"
+#include "envelope.h"
+
+#ifdef TESTING
+#include "../tests/mock_3ds.h"
+#else
+#include <3ds/types.h>
+#endif
+
+#include <math.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+// Software state-variable filter for a track's rendered frames (trapezoidal SVF, as in Cytomic's
+// "SvfLinearTrapOptimised2"). The cutoff can be swept by its own envelope, triggered with the
+// track's steps. Coefficients only change every SVF_CONTROL_SAMPLES frames.
+
+#define SVF_CONTROL_SAMPLES 16
+#define SVF_MIN_CUTOFF 20.0f
+#define SVF_MAX_ENV_OCTAVES 8.0f
+// Integrator level, in samples, below which the filter's output rounds to silence
+#define SVF_SETTLED_LEVEL 1.0f
+
+typedef enum { SVF_OFF, SVF_LOWPASS, SVF_BANDPASS, SVF_HIGHPASS, SVF_MODE_COUNT } SVFMode;
+
+extern const char *svf_mode_names[];
+
+typedef struct {
+    SVFMode  mode;
+    float    samplerate;
+    float    cutoff;     // Hz, before the envelope
+    float    resonance;  // 0..1, self-oscillates just short of 1
+    float    env_amount; // octaves the envelope moves the cutoff at full level, may be negative
+    Envelope env;
+
+    // Coefficients of the current control period, and the integrator state per channel
+    float k, a1, a2, a3;
+    float ic1eq[NCHANNELS];
+    float ic2eq[NCHANNELS];
+} SVFilter;
+
+extern void initSVF(SVFilter *svf, float samplerate);
+extern void SVFSetParams(SVFilter *svf, SVFMode mode, float cutoff, float resonance,
+                         float env_amount, int env_decay_ms);
+extern void triggerSVF(SVFilter *svf);
+// Zeroes the integrators, dropping whatever is still ringing
+extern void clearSVFState(SVFilter *svf);
+
+static inline bool SVFIsBypassed(const SVFilter *svf) {
+    return !svf || svf->mode == SVF_OFF;
+}
+
+// Bypassed, or rung out: with no input it would only render zeros. A resonant filter keeps
+// ringing well after its instrument has gone quiet.
+static inline bool SVFIsSettled(const SVFilter *svf) {
+    if (SVFIsBypassed(svf)) {
+        return true;
+    }
+    for (int c = 0; c < NCHANNELS; c++) {
+        if (fabsf(svf->ic1eq[c]) >= SVF_SETTLED_LEVEL ||
+            fabsf(svf->ic2eq[c]) >= SVF_SETTLED_LEVEL) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// tan(x) from its [3/2] Pade approximant: within 0.1% up to pi/4, 3% at the 0.45 fs cutoff limit
+extern float SVFFastTan(float x);
+
+// Filters n interleaved stereo int16 frames in place
+extern void processSVFFrames(SVFilter *svf, u32 *frames, size_t n);
+
+#endif // SVF_H
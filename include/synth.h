@@ -15,12 +15,22 @@ typedef struct {
     PolyBLEPOscillator *osc;
 } SubSynth;
 
-typedef struct {
-    Envelope   *carrierEnv;
-    FMOperator *fm_op;
-} FMSynth;
+// True when the next block would be all zeros, so the caller can skip rendering it
+extern bool isSubSynthSilent(const SubSynth *subsynth);
+extern bool isFMSynthSilent(const FMSynth *fmsynth);
+
+// Render size stereo frames into dest without touching the cache, so a block can be built from
+// several calls (e.g. split at a trigger) and flushed once
+extern void renderSubSynthAudio(u32 *dest, size_t size, SubSynth *subsynth);
+extern void renderFMSynthAudio(u32 *dest, size_t size, FMSynth *fmsynth);
 
 extern void fillSubSynthAudiobuffer(ndspWaveBuf *waveBuf, size_t size, SubSynth *subsynth);
 extern void fillFMSynthAudiobuffer(ndspWaveBuf *waveBuf, size_t size, FMSynth *fmsynth);
 
+// Mix bus variants: accumulate into an interleaved stereo float buffer with per-track gains
+extern void mixSubSynthAudiobuffer(float *mix_buf, size_t size, SubSynth *subsynth, float gain_l,
+                                   float gain_r);
+extern void mixFMSynthAudiobuffer(float *mix_buf, size_t size, FMSynth *fmsynth, float gain_l,
+                                  float gain_r);
+
 #endif // SYNTH_H
\ No newline at end of file
@@ -3,6 +3,7 @@
 
 #include <3ds.h>
 #include "track.h"
+#include "mix_bus.h"
 #include "event_queue.h"
 #include "sample_bank.h"
 #include "engine_constants.h"
@@ -21,9 +22,15 @@
  * @param tracks_ptr Pointer to the array of Track objects. The thread will read and modify this
  * data. Must be protected by tracks_lock_ptr. The caller retains ownership.
  * @param tracks_lock_ptr Pointer to the lock protecting the shared Track objects.
- * @param event_queue_ptr Pointer to the event queue for receiving sequencer events. The caller
- * retains ownership.
+ * @param event_queue_ptr Pointer to the event queue for receiving UI and transport events. Steps
+ * from the sequencer are scheduled on the audio thread itself. The caller retains ownership.
  * @param sample_bank_ptr Pointer to the sample bank. The caller retains ownership.
+ * @param mix_bus_ptr Pointer to an initialised mix bus, or NULL to give every track its own NDSP
+ * channel. When set, all tracks are summed into the bus each block. The caller retains ownership.
+ * @param silence_buffer Zeroed, cache-flushed linear memory of at least SILENCE_SAMPLES frames.
+ * Queued instead of rendering whenever a track is silent for a whole block. Never written.
+ * @param clock_ptr Pointer to the transport clock. Once the thread runs it is the only one to touch
+ * the clock: other threads change it through events and read it through g_clock_display.
  * @param should_exit_ptr Pointer to a volatile boolean flag. When set to true, the thread will
  * clean up and exit.
  * @param main_thread_prio The priority of the main application thread, used to calculate the
@@ -31,8 +38,8 @@
  * @return 0 on success, or a libctru error code on failure.
  */
 s32 audioThreadInit(Track *tracks_ptr, EventQueue *event_queue_ptr, SampleBank *sample_bank_ptr,
-                    Clock *clock_ptr, LightLock *clock_lock_ptr, volatile bool *should_exit_ptr,
-                    s32 main_thread_prio);
+                    MixBus *mix_bus_ptr, const u32 *silence_buffer, Clock *clock_ptr,
+                    volatile bool *should_exit_ptr, s32 main_thread_prio);
 
 /**
  * @brief Starts the audio thread.
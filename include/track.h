@@ -3,37 +3,46 @@
 
 #include "clock.h"
 #include "filters.h"
+#include "instrument.h"
+#include "latency.h"
+#include "param_smoother.h"
 #include "sequencer.h"
+#include "svf.h"
+#include "track_arena.h"
 #include "track_parameters.h"
 
 #ifndef TESTING
 #include <3ds.h>
 #endif
 
-typedef enum { SUB_SYNTH, OPUS_SAMPLER, FM_SYNTH, NOISE_SYNTH } InstrumentType;
-
 typedef struct Track {
     int              chan_id;
-    float            mix[12];
+    float            mix[12]; // NDSP channel mix, set once: volume and pan are in `gain`
     InstrumentType   instrument_type;
-    void            *instrument_data;
-    ndspWaveBuf      waveBuf[2];
-    u32             *audioBuffer;
+    void            *instrument_data; // in arena, as are sequencer and default_parameters
+    TrackArena       arena;
+    ndspWaveBuf      waveBuf[MAX_WAVEBUFS];
+    int              n_wavebufs;
+    u32             *audioBuffer; // LATENCY_MAX_QUEUED_MS of frames at rate
+    float            rate;
     NdspBiquad       filter;
+    SVFilter         svf; // software filter on the rendered frames, next to the instrument state
     bool             is_muted;
     bool             is_soloed;
-    bool             fillBlock;
+    int              fillBlock; // next wavebuf to render, cycles through n_wavebufs
+    bool             on_mix_bus; // rendered through the shared MixBus, owns no NDSP channel
+    u32              skipped_blocks; // silent blocks not rendered, written by the audio thread
     Sequencer       *sequencer;
     float            volume;
     float            pan;
-    TrackParameters *default_parameters;
+    GainSmoother     gain; // volume and pan, applied by the render loop
+    StepParameters  *default_parameters;
 } Track;
 
 extern void initializeTrack(Track *track, int chan_id, InstrumentType instrument_type, float rate,
                             u32 num_samples, u32 *audio_buffer);
 extern void resetTrack(Track *track);
-extern void updateTrack(Track *track, Clock *clock);
-extern void updateTrackParameters(Track *track, TrackParameters *params);
+extern void trackSetLatency(Track *track, LatencyProfileId profile);
 extern void Track_deinit(Track *track);
 extern void cleanupTracks(Track *tracks, int n_tracks);
 
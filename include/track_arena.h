@@ -0,0 +1,52 @@
+#ifndef TRACK_ARENA_H
+#define TRACK_ARENA_H
+
+#include "engine_constants.h"
+#include "instrument.h"
+#include "sequencer.h"
+
+#ifdef TESTING
+#include "../tests/mock_3ds.h"
+#else
+#include <3ds/types.h>
+#endif
+
+#include <stdbool.h>
+#include <stddef.h>
+
+// Everything one track owns besides its NDSP buffer, in a single linear heap block (0x80 aligned
+// on the 3DS, charged to LINEAR_TAG_INSTRUMENTS). The objects the audio thread reads every block
+// come first, each on its own cache line; the sequencer and the default parameters the UI edits
+// follow. Pointers between the objects (a synth's envelope) stay within the block, and one call
+// frees them all. The step tables themselves are versioned snapshots the sequencer allocates.
+
+#define TRACK_ARENA_STEPS 16
+
+typedef struct {
+    u8            *base;
+    size_t         size;
+    InstrumentType type;
+    size_t         n_steps;
+
+    // Hot, byte offsets from base. osc is only laid out for a SubSynth and env for every
+    // instrument but the FMSynth, whose operators embed theirs.
+    size_t instrument;
+    size_t osc;
+    size_t env;
+
+    // Cold: the sequencer, whose pattern starts n_steps long, and the track's default record
+    size_t sequencer;
+    size_t default_params;
+} TrackArena;
+
+static inline void *trackArenaAt(const TrackArena *arena, size_t offset) {
+    return arena->base + offset;
+}
+
+// Lays out and zeroes the block, wires the pointers between its objects and fills the pattern and
+// default parameters with the type's defaults. Instrument state is left for the caller to set.
+extern bool createTrackArena(TrackArena *arena, int track_id, InstrumentType type,
+                             size_t n_steps);
+extern void destroyTrackArena(TrackArena *arena);
+
+#endif // TRACK_ARENA_H
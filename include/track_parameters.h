@@ -2,9 +2,12 @@
 #define TRACK_PARAMETERS_H
 
 #include "filters.h"
+#include "fm_osc.h"
+#include "instrument.h"
 #include "polybleposc.h"
 #include "samplers.h"
 #include "noise_synth.h"
+#include "svf.h"
 
 // a poor attempt at serialisable track parameters for each step
 
@@ -14,9 +17,13 @@ typedef struct {
     float          pan;
     float          ndsp_filter_cutoff;
     NdspFilterType ndsp_filter_type;
+    SVFMode        svf_mode; // software filter after the instrument, SVF_OFF bypasses it
+    float          svf_cutoff;
+    float          svf_resonance;
+    float          svf_env_amount; // octaves
+    int            svf_env_decay;  // ms
     bool           is_muted;
     bool           is_soloed;
-    void          *instrument_data;
 } TrackParameters;
 
 typedef struct {
@@ -60,24 +67,76 @@ typedef struct {
 
     int mod_env_rel;
 
-    float mod_index;
+    float mod_index; // 0..1 of FM_MAX_MOD_INDEX
 
-    float mod_depth;
+    float mod_depth; // percent of each modulator's level
 
     float carrier_freq;
 
-    float mod_freq_ratio;
+    float mod_freq_ratio; // multiplies the modulator ratios
+
+    FMAlgorithm algorithm;
+
+    float feedback;
+
+    float op_ratio[FM_OPERATORS];
+
+    float op_level[FM_OPERATORS];
 
 } FMSynthParameters;
 
 typedef struct {
-    int   env_atk;
-    int   env_dec;
-    float env_sus_level;
-    int   env_rel;
-    int   env_dur; // Duration for triggered envelopes
+    int       env_atk;
+    int       env_dec;
+    float     env_sus_level;
+    int       env_rel;
+    int       env_dur; // Duration for triggered envelopes
+    NoiseMode mode;
+    int       rate_div; // samples each noise value is held for
 } NoiseSynthParameters;
 
+// Any instrument's parameters, so every step's record has the same size whatever the track plays
+typedef union {
+    SubSynthParameters    subsynth_params;
+    OpusSamplerParameters sampler_params;
+    FMSynthParameters     fm_synth_params;
+    NoiseSynthParameters  noise_synth_params;
+} InstrumentParameters;
+
+// One step: the track's settings and the instrument's, side by side with no pointers between
+typedef struct {
+    TrackParameters      track;
+    InstrumentParameters instrument;
+} StepParameters;
+
+// The single settings the step editor changes across many steps at once, see copyStepField
+typedef enum {
+    STEP_FIELD_NONE,
+    STEP_FIELD_VOLUME,
+    STEP_FIELD_PAN,
+    STEP_FIELD_FILTER_CUTOFF,
+    STEP_FIELD_FILTER_TYPE,
+    STEP_FIELD_SVF_MODE,
+    STEP_FIELD_SVF_CUTOFF,
+    STEP_FIELD_SVF_RESONANCE,
+    STEP_FIELD_SVF_ENV_AMOUNT,
+    STEP_FIELD_SVF_ENV_DECAY,
+    STEP_FIELD_PULSE_WIDTH,
+    STEP_FIELD_MOD_INDEX,
+    STEP_FIELD_MOD_DEPTH,
+    STEP_FIELD_START_POSITION,
+    STEP_FIELD_NOTE,
+    STEP_FIELD_MOD_RATIO,
+    STEP_FIELD_WAVEFORM,
+    STEP_FIELD_FM_ALGORITHM,
+    STEP_FIELD_NOISE_MODE,
+    STEP_FIELD_PLAYBACK_MODE,
+    STEP_FIELD_SAMPLE_INDEX,
+    STEP_FIELD_ENV_DURATION,
+    STEP_FIELD_RATE_DIV,
+    STEP_FIELD_INSTRUMENT, // the whole instrument record, for envelope edits
+} StepField;
+
 extern SubSynthParameters defaultSubSynthParameters();
 
 extern OpusSamplerParameters defaultOpusSamplerParameters();
@@ -86,8 +145,15 @@ extern FMSynthParameters defaultFMSynthParameters();
 
 extern NoiseSynthParameters defaultNoiseSynthParameters();
 
-extern NoiseSynthParameters defaultNoiseSynthParameters();
+extern InstrumentParameters defaultInstrumentParameters(InstrumentType type);
+
+extern TrackParameters defaultTrackParameters(int track_id);
+
+extern StepParameters defaultStepParameters(int track_id, InstrumentType type);
 
-extern TrackParameters defaultTrackParameters(int track_id, void *instrument_data);
+// Copies one field from src to dst, leaving the rest of dst alone. Instrument fields are only
+// copied when the instrument type has them.
+extern void copyStepField(StepParameters *dst, const StepParameters *src, InstrumentType type,
+                          StepField field);
 
 #endif // TRACK_PARAMETERS_H
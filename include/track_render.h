@@ -0,0 +1,56 @@
+#ifndef TRACK_RENDER_H
+#define TRACK_RENDER_H
+
+#include "event.h"
+#include "track.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+
+// Steps the sequencer has produced but the renderer has not reached yet. Each one is tagged with
+// the block it falls in and its position inside that block, so a trigger starts on the sample the
+// clock put it on instead of at the start of the next buffer.
+#define STEP_SCHEDULE_SIZE 32 // power of two, two blocks at the fastest tempo fit comfortably
+
+typedef struct {
+    u32         block;  // index of the block the step sounds in
+    u16         offset; // position inside that block, as a fraction of it (0..65535)
+    StepPayload payload;
+} ScheduledStep;
+
+typedef struct {
+    ScheduledStep steps[STEP_SCHEDULE_SIZE];
+    u32           head;
+    u32           tail;
+    u32           rendered_blocks;
+} TrackSchedule;
+
+// Applies a step to its track, retriggering it when trigger is set
+typedef void (*StepApplyFn)(Track *track, const StepPayload *step, bool trigger);
+// Renders n frames of the track into dest from frame pos onwards
+typedef void (*RenderSegmentFn)(Track *track, void *dest, size_t pos, size_t n);
+
+// Takes a step's track parameters: mute, the gains' target and both filters
+extern void updateTrackParameters(Track *track, const TrackParameters *params);
+// The instrument is idle and the filter has rung out
+extern bool trackIsSilent(const Track *track);
+
+extern void scheduleStep(TrackSchedule *schedule, u32 block, u16 offset, InstrumentType type,
+                         const StepParameters *params);
+extern void applyTrackStep(Track *track, const StepPayload *step, bool trigger);
+
+// Silent for the whole block: idle now and nothing scheduled to wake it up
+extern bool trackBlockIsSilent(const Track *track, const TrackSchedule *schedule);
+// Moves past a block without rendering it, counting it in the track's skipped_blocks
+extern void skipTrackBlock(Track *track, TrackSchedule *schedule);
+// Renders the track's next block of n frames into dest, splitting it at every scheduled step so
+// each trigger lands on its own frame. A silent block is skipped instead and dest left untouched:
+// returns false then.
+extern bool renderTrackBlock(Track *track, TrackSchedule *schedule, void *dest, size_t n,
+                             StepApplyFn apply, RenderSegmentFn render);
+
+// Segment renderers: into a channel's interleaved s16 frames, or summed into a float mix bus
+extern void renderTrackSegment(Track *track, void *dest, size_t pos, size_t n);
+extern void mixTrackSegment(Track *track, void *dest, size_t pos, size_t n);
+
+#endif // TRACK_RENDER_H
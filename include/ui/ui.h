@@ -22,7 +22,10 @@ typedef enum {
     PARAM_TYPE_SAMPLE_INDEX,
     PARAM_TYPE_PLAYBACK_MODE,
     PARAM_TYPE_MOD_RATIO, // For FM_SYNTH
+    PARAM_TYPE_FM_ALGORITHM,
+    PARAM_TYPE_NOISE_MODE,
     PARAM_TYPE_ENVELOPE_BUTTON,
+    PARAM_TYPE_SVF_BUTTON, // Software filter: mode, cutoff, resonance, env amount and decay
     PARAM_TYPE_INT,
     // ... add more types as needed
 } ParameterType;
@@ -49,6 +52,7 @@ extern void drawTracksSequencers(Track *tracks, int cur_step);
 extern void drawMainView(Track *tracks, int selected_row, int selected_col, ScreenFocus focus);
 extern void drawClockSettingsView(int selected_option);
 extern void drawQuitMenu(const char *options[], int num_options, int selected_option);
+extern void drawAudioStatsOverlay(void);
 extern void drawTouchScreenSettingsView(int selected_option, ScreenFocus focus);
 extern void drawTouchClockSettingsView(int selected_option);
 extern void drawSampleManagerView(SampleBank *bank, int selected_row, int selected_col,
@@ -57,11 +61,12 @@ extern void drawSampleManagerView(SampleBank *bank, int selected_row, int select
 extern void drawStepSettingsView(Session *session, Track *tracks, int selected_row,
                                  int selected_col, int selected_step_option,
                                  SampleBank *sample_bank, ScreenFocus focus);
-extern void drawStepSettingsEditView(Track *track, TrackParameters *params,
+extern void drawStepSettingsEditView(Track *track, const StepParameters *params,
                                      int selected_step_option, int selected_adsr_option,
                                      SampleBank *sample_bank);
 
-extern int generateParameterList(Track *track, TrackParameters *params, SampleBank *sample_bank,
-                                 ParameterInfo *list_buffer, int max_params);
+extern int generateParameterList(Track *track, const StepParameters *params,
+                                 SampleBank *sample_bank, ParameterInfo *list_buffer,
+                                 int max_params);
 
 #endif // UI_H
\ No newline at end of file
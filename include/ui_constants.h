@@ -32,7 +32,7 @@
 
 // Menu dimensions
 #define CLOCK_MENU_WIDTH 300.0f
-#define CLOCK_MENU_HEIGHT 100.0f
+#define CLOCK_MENU_HEIGHT 125.0f
 #define QUIT_MENU_WIDTH 150.0f
 #define QUIT_MENU_HEIGHT 80.0f
 #define SAMPLE_BROWSER_WIDTH 200.0f
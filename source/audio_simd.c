@@ -0,0 +1,14 @@
+#include "audio_simd.h"
+
+void floatToStereoInt16(const float *in, u32 *out, size_t n) {
+    for (size_t i = 0; i < n; i++) {
+        s32 s  = floatToInt16Sat(in[i]);
+        out[i] = packStereo16(s, s);
+    }
+}
+
+void applyStereoGainQ16(const u32 *in, u32 *out, const s32 *gain, size_t n) {
+    for (size_t i = 0; i < n; i++) {
+        out[i] = stereoGainQ16(in[i], gain[i]);
+    }
+}
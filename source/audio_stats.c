@@ -0,0 +1,101 @@
+#include "audio_stats.h"
+
+#include <string.h>
+
+AudioStats g_audio_stats = { 0 };
+
+void audioStatsReset(AudioStats *stats) {
+    memset((void *) stats, 0, sizeof(*stats));
+}
+
+// Single writer seqlock: readers retry whenever seq was odd or changed under them
+void audioStatsBeginWrite(AudioStats *stats) {
+    stats->seq++;
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+}
+
+void audioStatsEndWrite(AudioStats *stats) {
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+    stats->seq++;
+}
+
+u32 statsBucketIndex(u32 ticks) {
+    if (ticks < (1u << STATS_SUB_BITS)) {
+        return ticks;
+    }
+    u32 msb = 31 - __builtin_clz(ticks);
+    u32 sub = (ticks >> (msb - STATS_SUB_BITS)) & ((1u << STATS_SUB_BITS) - 1);
+    return ((msb - STATS_SUB_BITS + 1) << STATS_SUB_BITS) + sub;
+}
+
+u32 statsBucketUpper(u32 idx) {
+    if (idx < (1u << STATS_SUB_BITS)) {
+        return idx;
+    }
+    u32 msb   = (idx >> STATS_SUB_BITS) + STATS_SUB_BITS - 1;
+    u32 sub   = idx & ((1u << STATS_SUB_BITS) - 1);
+    u32 width = 1u << (msb - STATS_SUB_BITS);
+    u64 lower = (u64) ((1u << STATS_SUB_BITS) + sub) << (msb - STATS_SUB_BITS);
+    return (u32) (lower + width - 1);
+}
+
+void audioStatsRecord(AudioStats *stats, AudioStage stage, u64 ticks) {
+    StageHistogram *hist = &stats->stages[stage];
+    u32             t    = ticks > 0xFFFFFFFFu ? 0xFFFFFFFFu : (u32) ticks;
+    hist->buckets[statsBucketIndex(t)]++;
+    hist->count++;
+    if (t > hist->max) {
+        hist->max = t;
+    }
+}
+
+void audioStatsAddBusy(AudioStats *stats, u64 busy, u64 now) {
+    if (stats->window_start == 0) {
+        stats->window_start = now;
+    }
+    stats->window_busy += busy;
+
+    u64 elapsed = now - stats->window_start;
+    if (elapsed >= STATS_LOAD_WINDOW) {
+        stats->load_permille = (u32) (stats->window_busy * 1000 / elapsed);
+        stats->window_start  = now;
+        stats->window_busy   = 0;
+    }
+}
+
+bool audioStatsSnapshot(const AudioStats *stats, AudioStats *out) {
+    for (int attempt = 0; attempt < 8; attempt++) {
+        u32 seq = stats->seq;
+        __atomic_thread_fence(__ATOMIC_ACQUIRE);
+        if (seq & 1) {
+            continue;
+        }
+        memcpy(out, (const void *) stats, sizeof(*out));
+        __atomic_thread_fence(__ATOMIC_ACQUIRE);
+        if (stats->seq == seq) {
+            return true;
+        }
+    }
+    return false;
+}
+
+u32 statsPercentile(const StageHistogram *hist, u32 percent) {
+    if (hist->count == 0) {
+        return 0;
+    }
+    // Rank of the sample we want, 1-based and rounded up
+    u64 rank = ((u64) hist->count * percent + 99) / 100;
+    if (rank == 0) {
+        rank = 1;
+    }
+
+    u64 seen = 0;
+    for (u32 i = 0; i < STATS_BUCKETS; i++) {
+        seen += hist->buckets[i];
+        if (seen >= rank) {
+            u32 upper = statsBucketUpper(i);
+            return upper < hist->max ? upper : hist->max;
+        }
+    }
+    return hist->max;
+}
@@ -1,6 +1,8 @@
 #include "audio_utils.h"
 
+#ifndef TESTING
 #include <3ds/services/dsp.h>
+#endif
 
 float clamp(float d, float min, float max) {
     const float t = d < min ? min : d;
@@ -20,7 +22,8 @@ float int16ToFloat(s16 x) {
 void fillBufferWithZeros(void *audioBuffer, size_t size) {
     u32 *dest = (u32 *) audioBuffer;
 
-    for (int i = 0; i < size; i++) {
+    // size is in bytes
+    for (size_t i = 0; i < size / sizeof(u32); i++) {
         s16 sample = 0;
         dest[i]    = (sample << 16) | (sample & 0xffff);
     }
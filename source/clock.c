@@ -1,21 +1,37 @@
 #include "clock.h"
-#include <limits.h>
 
-#ifndef TESTING
-#include <3ds/os.h>
-#endif
-#include <math.h>
-
-// We use scaled integers to avoid floating point errors. 8 bits of fractional precision.
-#define CLOCK_RESOLUTION_SHIFT 8
+#include <string.h>
 
 const char *clockStatusName[] = { "Stopped", "Playing", "Paused" };
 
-LightLock    g_clock_display_lock;
-ClockDisplay g_clock_display = { 0 };
+ClockDisplayState g_clock_display = { 0 };
+
+// Single writer seqlock, the same scheme as AudioStats
+void clockDisplayPublish(ClockDisplayState *state, const ClockDisplay *display) {
+    state->seq++;
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+    state->display = *display;
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+    state->seq++;
+}
 
-void clock_display_init(void) {
-    LightLock_Init(&g_clock_display_lock);
+ClockDisplay clockDisplayRead(const ClockDisplayState *state) {
+    static ClockDisplay last = { 0 };
+    for (int attempt = 0; attempt < 8; attempt++) {
+        u32 seq = state->seq;
+        __atomic_thread_fence(__ATOMIC_ACQUIRE);
+        if (seq & 1) {
+            continue;
+        }
+        ClockDisplay display;
+        memcpy(&display, (const void *) &state->display, sizeof(display));
+        __atomic_thread_fence(__ATOMIC_ACQUIRE);
+        if (state->seq == seq) {
+            last = display;
+            break;
+        }
+    }
+    return last;
 }
 
 void resetBarBeats(Clock *clock) {
@@ -27,10 +43,19 @@ void resetBarBeats(Clock *clock) {
     }
 }
 
-void resetClock(Clock *clock) {
-    clock->last_tick_time   = svcGetSystemTick();
-    clock->time_accumulator = 0;
-};
+// Counts one clock step and moves the bar/beat position along with it
+void advanceMusicalTime(Clock *clock) {
+    MusicalTime *mt = clock->barBeats;
+    if (!mt) {
+        return;
+    }
+    mt->steps++;
+    int totBeats  = (mt->steps - 1) / STEPS_PER_BEAT;
+    mt->bar       = totBeats / mt->beats_per_bar;
+    mt->beat      = totBeats % mt->beats_per_bar;
+    mt->deltaStep = (mt->steps - 1) % STEPS_PER_BEAT;
+}
+
 void stopClock(Clock *clock) {
     clock->status = STOPPED;
     resetBarBeats(clock);
@@ -39,32 +64,45 @@ void pauseClock(Clock *clock) {
     clock->status = PAUSED;
 };
 
+// The phase is held while paused, so playback picks up mid-step where it stopped
 void resumeClock(Clock *clock) {
     if (clock->status == PAUSED) {
-        clock->status         = PLAYING;
-        clock->last_tick_time = svcGetSystemTick();
+        clock->status = PLAYING;
     }
 }
 
 void startClock(Clock *clock) {
     clock->status = PLAYING;
     resetBarBeats(clock);
-    resetClock(clock);
-    if (clock->ticks_per_step > 0) { // Avoid issues if bpm is 0
-        clock->time_accumulator = clock->ticks_per_step;
-    }
+    clock->phase = clock->frames_per_step; // first step on the first frame
 };
 
+// Moves to a new step length keeping the same fraction of the current step behind us, so a
+// tempo or rate change never skips or repeats a step
+static void retimeClock(Clock *clock) {
+    u64 frames_per_step = 0;
+    if (clock->bpm > 0 && clock->samplerate > 0) {
+        double frames = (double) clock->samplerate * 60.0 / clock->bpm / STEPS_PER_BEAT;
+        frames_per_step = (u64) (frames * ((u64) 1 << CLOCK_FRAME_SHIFT));
+    }
+    if (clock->frames_per_step > 0) {
+        double fraction = (double) clock->phase / clock->frames_per_step;
+        clock->phase    = (u64) (fraction * frames_per_step);
+    }
+    clock->frames_per_step = frames_per_step;
+}
+
 void setBpm(Clock *clock, float bpm) {
     if (clock && clock->bpm != bpm && bpm >= 20 && bpm <= 200) {
         clock->bpm = bpm;
-        // Use double for intermediate calculation for precision
-        double ticks_per_beat   = (double) SYSCLOCK_ARM11 * 60.0 / bpm;
-        double ticks_per_step_f = ticks_per_beat / STEPS_PER_BEAT;
+        retimeClock(clock);
+    }
+}
 
-        // Scale up to maintain fractional precision with integers
-        clock->ticks_per_step = (u64) (ticks_per_step_f * (1 << CLOCK_RESOLUTION_SHIFT));
-        resetClock(clock);
+void setClockSamplerate(Clock *clock, float samplerate) {
+    if (clock && clock->samplerate != samplerate && samplerate > 0) {
+        clock->samplerate = samplerate;
+        retimeClock(clock);
     }
 }
 
@@ -74,27 +112,28 @@ void setBeatsPerBar(Clock *clock, int beats) {
     }
 }
 
-int updateClock(Clock *clock) {
-    if (!clock || clock->status != PLAYING) {
+// Moves the clock forward by one rendered block of frames and reports where each tick falls
+// inside that block as a fraction of it (0..65535). Ticks past max_ticks are held back and fire
+// at the start of the next block.
+int advanceClock(Clock *clock, u32 frames, u16 *offsets, int max_ticks) {
+    if (!clock || clock->status != PLAYING || clock->frames_per_step == 0 || frames == 0) {
         return 0;
     }
 
-    u64 now               = svcGetSystemTick();
-    u64 delta_ticks       = now - clock->last_tick_time;
-    clock->last_tick_time = now;
-
-    // Scale up delta_ticks before adding to the accumulator
-    clock->time_accumulator += (delta_ticks << CLOCK_RESOLUTION_SHIFT);
-
-    if (clock->time_accumulator >= clock->ticks_per_step) {
-        if (clock->ticks_per_step == 0) {
-            return 0; // Prevent division by zero
+    u64 duration = (u64) frames << CLOCK_FRAME_SHIFT;
+    u64 acc      = clock->phase; // time since the last tick
+    u64 pos      = 0;            // time since the start of the block
+    int n        = 0;
+    while (n < max_ticks) {
+        u64 until = (acc >= clock->frames_per_step) ? 0 : clock->frames_per_step - acc;
+        if (pos + until >= duration) {
+            break;
         }
-        u64 num_ticks_raw = clock->time_accumulator / clock->ticks_per_step;
-        int num_ticks     = (num_ticks_raw > INT_MAX) ? INT_MAX : (int) num_ticks_raw;
-        clock->time_accumulator %= clock->ticks_per_step; // Keep the remainder
-        return num_ticks;
+        pos += until;
+        acc += until - clock->frames_per_step;
+        offsets[n++] = (u16) ((pos >> 16) / frames);
     }
 
-    return 0;
-}
\ No newline at end of file
+    clock->phase = acc + (duration - pos);
+    return n;
+}
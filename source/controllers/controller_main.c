@@ -6,6 +6,14 @@
 #include "session.h"
 #include "controllers/session_controller.h"
 
+// Toggles in the UI's copy of the pattern and publishes it, the audio thread only ever reads it
+static void toggleStep(Track *track, int step_index) {
+    if (track->sequencer) {
+        patternToggleStep(track->sequencer->edit, step_index);
+        sequencerPublish(track->sequencer);
+    }
+}
+
 void handleInputMainView(SessionContext *ctx, u32 kDown, u32 kHeld, u64 now) {
     if (handle_continuous_press(kDown, kHeld, now, KEY_UP, ctx->up_timer, ctx->HOLD_DELAY_INITIAL,
                                 ctx->HOLD_DELAY_REPEAT)) {
@@ -29,7 +37,8 @@ void handleInputMainView(SessionContext *ctx, u32 kDown, u32 kHeld, u64 now) {
 
     if (kDown & KEY_Y) {
         if (*ctx->selected_row == 0 && *ctx->selected_col == 0) {
-            Event event = { .type = (ctx->clock->status == PLAYING) ? PAUSE_CLOCK : RESUME_CLOCK };
+            ClockStatus status = clockDisplayRead(&g_clock_display).status;
+            Event       event  = { .type = (status == PLAYING) ? PAUSE_CLOCK : RESUME_CLOCK };
             eventQueuePush(ctx->event_queue, event);
         } else if (*ctx->selected_row > 0 && *ctx->selected_col > 0) {
             ctx->session->touch_screen_view = VIEW_STEP_SETTINGS;
@@ -54,24 +63,19 @@ void handleInputMainView(SessionContext *ctx, u32 kDown, u32 kHeld, u64 now) {
             int step_index = *ctx->selected_col - 1;
             if (*ctx->selected_row == 0) { // Header row
                 for (int i = 0; i < N_TRACKS; i++) {
-                    Event event                         = { .type = TOGGLE_STEP, .track_id = i };
-                    event.data.toggle_step_data.step_id = step_index;
-                    eventQueuePush(ctx->event_queue, event);
+                    toggleStep(&ctx->tracks[i], step_index);
                 }
             } else { // Track row
-                int   track_index = *ctx->selected_row - 1;
-                Event event       = { .type = TOGGLE_STEP, .track_id = track_index };
-                event.data.toggle_step_data.step_id = step_index;
-                eventQueuePush(ctx->event_queue, event);
+                toggleStep(&ctx->tracks[*ctx->selected_row - 1], step_index);
             }
         }
     }
 
     if (kDown & KEY_X) {
         if (*ctx->selected_row == 0 && *ctx->selected_col == 0) {
-            Event event = { .type = (ctx->clock->status == PLAYING || ctx->clock->status == PAUSED)
-                                        ? STOP_CLOCK
-                                        : START_CLOCK };
+            ClockStatus status = clockDisplayRead(&g_clock_display).status;
+            Event       event  = { .type = (status == PLAYING || status == PAUSED) ? STOP_CLOCK
+                                                                                   : START_CLOCK };
             eventQueuePush(ctx->event_queue, event);
 
             if (event.type == STOP_CLOCK) {
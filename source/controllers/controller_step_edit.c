@@ -25,121 +25,69 @@ extern int     hertzToMidi(float hertz);
 extern float   midiToHertz(int midiNote);
 extern int     SampleBankGetLoadedSampleCount(SampleBank *bank);
 extern Sample *SampleBankGetSample(SampleBank *bank, int index);
-extern int     generateParameterList(Track *track, TrackParameters *params, SampleBank *sample_bank,
-                                     ParameterInfo *list_buffer, int max_params);
 
-static void applyParameterUpdate(TrackParameters *target_params, InstrumentType instrument_type,
-                                 SessionContext *ctx) {
-    // Only update the specific parameter that was edited
+// Which field of the step record the last edit changed, so it alone is copied to every step
+static StepField editedStepField(const SessionContext *ctx, InstrumentType instrument_type) {
+    const char *label = ctx->last_edited_param_label;
+
     switch (ctx->last_edited_param_type) {
     case PARAM_TYPE_FLOAT_0_1:
-        if (strcmp(ctx->last_edited_param_label, "Volume") == 0) {
-            target_params->volume = ctx->editing_step_params->volume;
-        } else if (strcmp(ctx->last_edited_param_label, "Pulse Width") == 0) {
-            if (instrument_type == SUB_SYNTH) {
-                ((SubSynthParameters *) target_params->instrument_data)->pulse_width =
-                    ((SubSynthParameters *) ctx->editing_subsynth_params)->pulse_width;
-            }
-        } else if (strcmp(ctx->last_edited_param_label, "Mod Index") == 0) {
-            if (instrument_type == FM_SYNTH) {
-                ((FMSynthParameters *) target_params->instrument_data)->mod_index =
-                    ((FMSynthParameters *) ctx->editing_fm_synth_params)->mod_index;
-            }
-        } else if (strcmp(ctx->last_edited_param_label, "Start Pos") == 0) {
-            if (instrument_type == OPUS_SAMPLER) {
-                ((OpusSamplerParameters *) target_params->instrument_data)->start_position =
-                    ((OpusSamplerParameters *) ctx->editing_sampler_params)->start_position;
-            }
-        } else if (strcmp(ctx->last_edited_param_label, "Mod Depth") == 0) {
-            if (instrument_type == FM_SYNTH) {
-                ((FMSynthParameters *) target_params->instrument_data)->mod_depth =
-                    ((FMSynthParameters *) ctx->editing_fm_synth_params)->mod_depth;
-            }
+        if (strcmp(label, "Volume") == 0) {
+            return STEP_FIELD_VOLUME;
+        } else if (strcmp(label, "Pulse Width") == 0) {
+            return STEP_FIELD_PULSE_WIDTH;
+        } else if (strcmp(label, "Mod Index") == 0) {
+            return STEP_FIELD_MOD_INDEX;
+        } else if (strcmp(label, "Start Pos") == 0) {
+            return STEP_FIELD_START_POSITION;
+        } else if (strcmp(label, "Mod Depth") == 0) {
+            return STEP_FIELD_MOD_DEPTH;
         }
-        break;
+        return STEP_FIELD_NONE;
     case PARAM_TYPE_FLOAT_N1_1:
-        if (strcmp(ctx->last_edited_param_label, "Pan") == 0) {
-            target_params->pan = ctx->editing_step_params->pan;
-        }
-        break;
+        return strcmp(label, "Pan") == 0 ? STEP_FIELD_PAN : STEP_FIELD_NONE;
     case PARAM_TYPE_HZ:
-        if (strcmp(ctx->last_edited_param_label, "Filter Cf") == 0) {
-            target_params->ndsp_filter_cutoff = ctx->editing_step_params->ndsp_filter_cutoff;
-        }
-        break;
+        return strcmp(label, "Filter Cf") == 0 ? STEP_FIELD_FILTER_CUTOFF : STEP_FIELD_NONE;
     case PARAM_TYPE_MIDI_NOTE:
-        if (instrument_type == SUB_SYNTH) {
-            ((SubSynthParameters *) target_params->instrument_data)->osc_freq =
-                ((SubSynthParameters *) ctx->editing_subsynth_params)->osc_freq;
-        } else if (instrument_type == FM_SYNTH) {
-            ((FMSynthParameters *) target_params->instrument_data)->carrier_freq =
-                ((FMSynthParameters *) ctx->editing_fm_synth_params)->carrier_freq;
-        }
-        break;
+        return STEP_FIELD_NOTE;
     case PARAM_TYPE_MOD_RATIO:
-        if (instrument_type == FM_SYNTH) {
-            ((FMSynthParameters *) target_params->instrument_data)->mod_freq_ratio =
-                ((FMSynthParameters *) ctx->editing_fm_synth_params)->mod_freq_ratio;
-        }
-        break;
+        return STEP_FIELD_MOD_RATIO;
     case PARAM_TYPE_FILTER_TYPE:
-        target_params->ndsp_filter_type = ctx->editing_step_params->ndsp_filter_type;
-        break;
+        return STEP_FIELD_FILTER_TYPE;
     case PARAM_TYPE_WAVEFORM:
-        if (instrument_type == SUB_SYNTH) {
-            ((SubSynthParameters *) target_params->instrument_data)->osc_waveform =
-                ((SubSynthParameters *) ctx->editing_subsynth_params)->osc_waveform;
-        }
-        break;
+        return STEP_FIELD_WAVEFORM;
+    case PARAM_TYPE_FM_ALGORITHM:
+        return STEP_FIELD_FM_ALGORITHM;
+    case PARAM_TYPE_NOISE_MODE:
+        return STEP_FIELD_NOISE_MODE;
     case PARAM_TYPE_PLAYBACK_MODE:
-        if (instrument_type == OPUS_SAMPLER) {
-            ((OpusSamplerParameters *) target_params->instrument_data)->playback_mode =
-                ((OpusSamplerParameters *) ctx->editing_sampler_params)->playback_mode;
-        }
-        break;
+        return STEP_FIELD_PLAYBACK_MODE;
     case PARAM_TYPE_SAMPLE_INDEX:
-        if (instrument_type == OPUS_SAMPLER) {
-            ((OpusSamplerParameters *) target_params->instrument_data)->sample_index =
-                ((OpusSamplerParameters *) ctx->editing_sampler_params)->sample_index;
-        }
-        break;
+        return STEP_FIELD_SAMPLE_INDEX;
     case PARAM_TYPE_INT:
-        if (instrument_type == SUB_SYNTH) {
-            ((SubSynthParameters *) target_params->instrument_data)->env_dur =
-                ((SubSynthParameters *) ctx->editing_subsynth_params)->env_dur;
-        } else if (instrument_type == OPUS_SAMPLER) {
-            ((OpusSamplerParameters *) target_params->instrument_data)->env_dur =
-                ((OpusSamplerParameters *) ctx->editing_sampler_params)->env_dur;
-        } else if (instrument_type == FM_SYNTH) {
-            ((FMSynthParameters *) target_params->instrument_data)->env_dur =
-                ((FMSynthParameters *) ctx->editing_fm_synth_params)->env_dur;
-        } else if (instrument_type == NOISE_SYNTH) {
-            ((NoiseSynthParameters *) target_params->instrument_data)->env_dur =
-                ((NoiseSynthParameters *) ctx->editing_noise_synth_params)->env_dur;
+        if (instrument_type == NOISE_SYNTH && strcmp(label, "Rate Div") == 0) {
+            return STEP_FIELD_RATE_DIV;
         }
-        break;
+        return STEP_FIELD_ENV_DURATION;
     case PARAM_TYPE_ENVELOPE_BUTTON:
-        // This is more complex, as it depends on selected_adsr_option and instrument
-        // type For now, I'll copy the entire envelope if any part of it was edited. A
-        // more granular approach would be to check selected_adsr_option.
-        if (instrument_type == SUB_SYNTH) {
-            memcpy(target_params->instrument_data, ctx->editing_subsynth_params,
-                   sizeof(SubSynthParameters));
-        } else if (instrument_type == FM_SYNTH) {
-            memcpy(target_params->instrument_data, ctx->editing_fm_synth_params,
-                   sizeof(FMSynthParameters));
-        } else if (instrument_type == OPUS_SAMPLER) {
-            memcpy(target_params->instrument_data, ctx->editing_sampler_params,
-                   sizeof(OpusSamplerParameters));
-        } else if (instrument_type == NOISE_SYNTH) {
-            memcpy(target_params->instrument_data, ctx->editing_noise_synth_params,
-                   sizeof(NoiseSynthParameters));
-        }
-        break;
+        // The whole instrument record is copied when any part of its envelope was edited
+        return STEP_FIELD_INSTRUMENT;
     default:
         // Should not happen if all parameter types are handled
-        break;
+        return STEP_FIELD_NONE;
+    }
+}
+
+// Copies what the last edit changed from the step being edited into dst. The filter row edits
+// its five settings together, so all of them are copied.
+static void copyEditedFields(const SessionContext *ctx, StepParameters *dst, InstrumentType type) {
+    if (ctx->last_edited_param_type == PARAM_TYPE_SVF_BUTTON) {
+        for (StepField field = STEP_FIELD_SVF_MODE; field <= STEP_FIELD_SVF_ENV_DECAY; field++) {
+            copyStepField(dst, ctx->editing_step, type, field);
+        }
+        return;
     }
+    copyStepField(dst, ctx->editing_step, type, editedStepField(ctx, type));
 }
 
 void handleInputStepEditView(SessionContext *ctx, u32 kDown, u32 kHeld, u64 now) {
@@ -153,144 +101,61 @@ void handleInputStepEditView(SessionContext *ctx, u32 kDown, u32 kHeld, u64 now)
         *ctx->screen_focus             = FOCUS_BOTTOM;
     } else if (kDown & KEY_A) {
         if (*ctx->selected_col == 0) {
-            // Apply to all steps
-            for (int i = 0; i < track->sequencer->n_beats * track->sequencer->steps_per_beat; i++) {
-                SeqStep *seq_step = &track->sequencer->steps[i];
-
-                applyParameterUpdate(seq_step->data, track->instrument_type, ctx);
-
-                // Update event queue
-                Event event                      = { .type = UPDATE_STEP, .track_id = track_idx };
-                event.data.step_data.base_params = *seq_step->data;
-                event.data.step_data.instrument_type = track->instrument_type;
-
-                if (track->instrument_type == SUB_SYNTH) {
-                    memcpy(&event.data.step_data.instrument_specific_params.subsynth_params,
-                           seq_step->data->instrument_data, sizeof(SubSynthParameters));
-                } else if (track->instrument_type == OPUS_SAMPLER) {
-                    memcpy(&event.data.step_data.instrument_specific_params.sampler_params,
-                           seq_step->data->instrument_data, sizeof(OpusSamplerParameters));
-                } else if (track->instrument_type == FM_SYNTH) {
-                    memcpy(&event.data.step_data.instrument_specific_params.fm_synth_params,
-                           seq_step->data->instrument_data, sizeof(FMSynthParameters));
-                } else if (track->instrument_type == NOISE_SYNTH) {
-                    memcpy(&event.data.step_data.instrument_specific_params.noise_synth_params,
-                           seq_step->data->instrument_data, sizeof(NoiseSynthParameters));
-                }
-                eventQueuePush(ctx->event_queue, event);
+            // Apply to all steps and the track's defaults, then publish them in one snapshot
+            Pattern *edit = track->sequencer->edit;
+            size_t   n    = patternLength(edit);
+            for (size_t i = 0; i < n; i++) {
+                copyEditedFields(ctx, &edit->params[i], track->instrument_type);
             }
+            copyEditedFields(ctx, track->default_parameters, track->instrument_type);
+            sequencerPublish(track->sequencer);
 
-            // Update default parameters for the track
-            applyParameterUpdate(track->default_parameters, track->instrument_type, ctx);
+            // The instrument sounds the edit straight away, as it would on the last step
+            if (n > 0) {
+                eventQueuePushStep(ctx->event_queue, UPDATE_STEP, track_idx,
+                                   track->instrument_type, &edit->params[n - 1]);
+            }
         } else {
-            int step_idx = *ctx->selected_col - 1;
-            if (step_idx >= 0 &&
-                step_idx < track->sequencer->n_beats * track->sequencer->steps_per_beat) {
-                SeqStep *seq_step = &track->sequencer->steps[step_idx];
-
-                if (seq_step->data == NULL) {
-                    seq_step->data = linearAlloc(sizeof(TrackParameters));
-                    if (seq_step->data) {
-                        memcpy(seq_step->data, track->default_parameters, sizeof(TrackParameters));
-                        if (track->instrument_type == SUB_SYNTH) {
-                            seq_step->data->instrument_data =
-                                linearAlloc(sizeof(SubSynthParameters));
-                            if (seq_step->data->instrument_data) {
-                                memcpy(seq_step->data->instrument_data,
-                                       track->default_parameters->instrument_data,
-                                       sizeof(SubSynthParameters));
-                            }
-                        } else if (track->instrument_type == OPUS_SAMPLER) {
-                            seq_step->data->instrument_data =
-                                linearAlloc(sizeof(OpusSamplerParameters));
-                            if (seq_step->data->instrument_data) {
-                                memcpy(seq_step->data->instrument_data,
-                                       track->default_parameters->instrument_data,
-                                       sizeof(OpusSamplerParameters));
-                            }
-                        } else if (track->instrument_type == FM_SYNTH) {
-                            seq_step->data->instrument_data =
-                                linearAlloc(sizeof(FMSynthParameters));
-                            if (seq_step->data->instrument_data) {
-                                memcpy(seq_step->data->instrument_data,
-                                       track->default_parameters->instrument_data,
-                                       sizeof(FMSynthParameters));
-                            }
-                        } else if (track->instrument_type == NOISE_SYNTH) {
-                            seq_step->data->instrument_data =
-                                linearAlloc(sizeof(NoiseSynthParameters));
-                            if (seq_step->data->instrument_data) {
-                                memcpy(seq_step->data->instrument_data,
-                                       track->default_parameters->instrument_data,
-                                       sizeof(NoiseSynthParameters));
-                            }
-                        }
-                    }
-                }
-
-                void *original_instrument_data = seq_step->data->instrument_data;
-                memcpy(seq_step->data, ctx->editing_step_params, sizeof(TrackParameters));
-                seq_step->data->instrument_data = original_instrument_data;
-
-                if (track->instrument_type == SUB_SYNTH) {
-                    memcpy(seq_step->data->instrument_data, ctx->editing_subsynth_params,
-                           sizeof(SubSynthParameters));
-                } else if (track->instrument_type == OPUS_SAMPLER) {
-                    memcpy(seq_step->data->instrument_data, ctx->editing_sampler_params,
-                           sizeof(OpusSamplerParameters));
-                } else if (track->instrument_type == FM_SYNTH) {
-                    memcpy(seq_step->data->instrument_data, ctx->editing_fm_synth_params,
-                           sizeof(FMSynthParameters));
-                } else if (track->instrument_type == NOISE_SYNTH) {
-                    memcpy(seq_step->data->instrument_data, ctx->editing_noise_synth_params,
-                           sizeof(NoiseSynthParameters));
-                }
+            StepParameters *step = patternStepParams(track->sequencer->edit,
+                                                     *ctx->selected_col - 1);
+            if (step) {
+                *step = *ctx->editing_step;
+                sequencerPublish(track->sequencer);
 
                 // --- Pre-render Envelope on Main Thread ---
                 if (track->instrument_type == SUB_SYNTH) {
-                    SubSynth           *ss = (SubSynth *) track->instrument_data;
-                    SubSynthParameters *p  = (SubSynthParameters *) seq_step->data->instrument_data;
+                    SubSynth                 *ss = (SubSynth *) track->instrument_data;
+                    const SubSynthParameters *p  = &step->instrument.subsynth_params;
                     updateEnvelope(ss->env, p->env_atk, p->env_dec, p->env_sus_level, p->env_rel,
                                    p->env_dur);
                 } else if (track->instrument_type == OPUS_SAMPLER) {
-                    Sampler               *s = (Sampler *) track->instrument_data;
-                    OpusSamplerParameters *p =
-                        (OpusSamplerParameters *) seq_step->data->instrument_data;
+                    Sampler                     *s = (Sampler *) track->instrument_data;
+                    const OpusSamplerParameters *p = &step->instrument.sampler_params;
                     updateEnvelope(s->env, p->env_atk, p->env_dec, p->env_sus_level, p->env_rel,
                                    p->env_dur);
                 } else if (track->instrument_type == NOISE_SYNTH) {
-                    NoiseSynth           *ns = (NoiseSynth *) track->instrument_data;
-                    NoiseSynthParameters *p =
-                        (NoiseSynthParameters *) seq_step->data->instrument_data;
+                    NoiseSynth                 *ns = (NoiseSynth *) track->instrument_data;
+                    const NoiseSynthParameters *p  = &step->instrument.noise_synth_params;
                     updateEnvelope(ns->env, p->env_atk, p->env_dec, p->env_sus_level, p->env_rel,
                                    p->env_dur);
                 } else if (track->instrument_type == FM_SYNTH) {
-                    FMSynth           *fs = (FMSynth *) track->instrument_data;
-                    FMSynthParameters *p  = (FMSynthParameters *) seq_step->data->instrument_data;
-                    updateEnvelope(fs->carrierEnv, p->carrier_env_atk, p->carrier_env_dec,
-                                   p->carrier_env_sus_level, p->carrier_env_rel, p->env_dur);
-                    updateEnvelope(fs->fm_op->mod_envelope, p->mod_env_atk, p->mod_env_dec,
-                                   p->mod_env_sus_level, p->mod_env_rel, p->env_dur);
+                    FMSynth                 *fs = (FMSynth *) track->instrument_data;
+                    const FMSynthParameters *p  = &step->instrument.fm_synth_params;
+                    for (int op = 0; op < FM_OPERATORS; op++) {
+                        if (FMIsCarrier(fs, op)) {
+                            updateEnvelope(&fs->ops[op].env, p->carrier_env_atk,
+                                           p->carrier_env_dec, p->carrier_env_sus_level,
+                                           p->carrier_env_rel, p->env_dur);
+                        } else {
+                            updateEnvelope(&fs->ops[op].env, p->mod_env_atk, p->mod_env_dec,
+                                           p->mod_env_sus_level, p->mod_env_rel, p->env_dur);
+                        }
+                    }
                 }
 
                 // Push event for the single step update
-                Event event                      = { .type = UPDATE_STEP, .track_id = track_idx };
-                event.data.step_data.base_params = *seq_step->data;
-                event.data.step_data.instrument_type = track->instrument_type;
-                if (track->instrument_type == SUB_SYNTH) {
-                    memcpy(&event.data.step_data.instrument_specific_params.subsynth_params,
-                           seq_step->data->instrument_data, sizeof(SubSynthParameters));
-                } else if (track->instrument_type == OPUS_SAMPLER) {
-                    memcpy(&event.data.step_data.instrument_specific_params.sampler_params,
-                           seq_step->data->instrument_data, sizeof(OpusSamplerParameters));
-                } else if (track->instrument_type == FM_SYNTH) {
-                    memcpy(&event.data.step_data.instrument_specific_params.fm_synth_params,
-                           seq_step->data->instrument_data, sizeof(FMSynthParameters));
-                } else if (track->instrument_type == NOISE_SYNTH) {
-                    memcpy(&event.data.step_data.instrument_specific_params.noise_synth_params,
-                           seq_step->data->instrument_data, sizeof(NoiseSynthParameters));
-                }
-                eventQueuePush(ctx->event_queue, event);
+                eventQueuePushStep(ctx->event_queue, UPDATE_STEP, track_idx,
+                                   track->instrument_type, step);
             }
         }
         track->filter.update_params    = true;
@@ -298,7 +163,7 @@ void handleInputStepEditView(SessionContext *ctx, u32 kDown, u32 kHeld, u64 now)
         *ctx->screen_focus             = FOCUS_BOTTOM;
     } else {
         ParameterInfo param_list[MAX_VIEW_PARAMS];
-        int param_count = generateParameterList(track, ctx->editing_step_params, ctx->sample_bank,
+        int param_count = generateParameterList(track, ctx->editing_step, ctx->sample_bank,
                                                 param_list, MAX_VIEW_PARAMS);
 
         ParameterInfo *param_to_edit = NULL;
@@ -327,7 +192,7 @@ void handleInputStepEditView(SessionContext *ctx, u32 kDown, u32 kHeld, u64 now)
 
                         fm_params->mod_depth -= 1.0f;
 
-                    fm_params->mod_depth = clamp(fm_params->mod_depth, 0.0f, 1000.0f);
+                    fm_params->mod_depth = clamp(fm_params->mod_depth, 0.0f, 100.0f);
 
                 } else if (strcmp(param_to_edit->label, "Pulse Width") == 0) {
                     SubSynthParameters *synth_params = ctx->editing_subsynth_params;
@@ -560,6 +425,42 @@ void handleInputStepEditView(SessionContext *ctx, u32 kDown, u32 kHeld, u64 now)
                 break;
             }
 
+            case PARAM_TYPE_FM_ALGORITHM: {
+                if (track->instrument_type == FM_SYNTH) {
+                    FMSynthParameters *fm_params = ctx->editing_fm_synth_params;
+
+                    if (kDown & KEY_UP)
+
+                        fm_params->algorithm = (fm_params->algorithm + 1) % FM_ALGORITHM_COUNT;
+
+                    if (kDown & KEY_DOWN)
+
+                        fm_params->algorithm =
+
+                            (fm_params->algorithm - 1 + FM_ALGORITHM_COUNT) % FM_ALGORITHM_COUNT;
+                }
+                ctx->last_edited_param_unique_id = param_to_edit->unique_id;
+                ctx->last_edited_param_type      = param_to_edit->type;
+                ctx->last_edited_param_label     = param_to_edit->label;
+                break;
+            }
+
+            case PARAM_TYPE_NOISE_MODE: {
+                if (track->instrument_type == NOISE_SYNTH) {
+                    NoiseSynthParameters *noise_params = ctx->editing_noise_synth_params;
+
+                    if (kDown & KEY_UP || kDown & KEY_DOWN)
+
+                        noise_params->mode = (noise_params->mode == NOISE_MODE_15BIT)
+                                                 ? NOISE_MODE_7BIT
+                                                 : NOISE_MODE_15BIT;
+                }
+                ctx->last_edited_param_unique_id = param_to_edit->unique_id;
+                ctx->last_edited_param_type      = param_to_edit->type;
+                ctx->last_edited_param_label     = param_to_edit->label;
+                break;
+            }
+
             case PARAM_TYPE_PLAYBACK_MODE: {
                 if (track->instrument_type == OPUS_SAMPLER) {
                     OpusSamplerParameters *sampler_params = ctx->editing_sampler_params;
@@ -605,6 +506,24 @@ void handleInputStepEditView(SessionContext *ctx, u32 kDown, u32 kHeld, u64 now)
             case PARAM_TYPE_INT: {
                 int *value_ptr = NULL;
 
+                if (track->instrument_type == NOISE_SYNTH &&
+                    strcmp(param_to_edit->label, "Rate Div") == 0) {
+                    NoiseSynthParameters *noise_params = ctx->editing_noise_synth_params;
+
+                    if (handle_continuous_press(kDown, kHeld, now, KEY_UP, ctx->up_timer,
+                                                ctx->HOLD_DELAY_INITIAL, ctx->HOLD_DELAY_REPEAT))
+                        noise_params->rate_div++;
+                    if (handle_continuous_press(kDown, kHeld, now, KEY_DOWN, ctx->down_timer,
+                                                ctx->HOLD_DELAY_INITIAL, ctx->HOLD_DELAY_REPEAT))
+                        noise_params->rate_div--;
+                    noise_params->rate_div = clamp(noise_params->rate_div, 1, NOISE_MAX_RATE_DIV);
+
+                    ctx->last_edited_param_unique_id = param_to_edit->unique_id;
+                    ctx->last_edited_param_type      = param_to_edit->type;
+                    ctx->last_edited_param_label     = param_to_edit->label;
+                    break;
+                }
+
                 if (track->instrument_type == SUB_SYNTH)
 
                     value_ptr = &((SubSynthParameters *) ctx->editing_subsynth_params)->env_dur;
@@ -643,6 +562,64 @@ void handleInputStepEditView(SessionContext *ctx, u32 kDown, u32 kHeld, u64 now)
                 break;
             }
 
+            case PARAM_TYPE_SVF_BUTTON: {
+                TrackParameters *track_params = ctx->editing_step_params;
+
+                if (kDown & KEY_LEFT)
+                    *ctx->selected_adsr_option =
+                        (*ctx->selected_adsr_option > 0) ? *ctx->selected_adsr_option - 1 : 4;
+                if (kDown & KEY_RIGHT)
+                    *ctx->selected_adsr_option =
+                        (*ctx->selected_adsr_option < 4) ? *ctx->selected_adsr_option + 1 : 0;
+
+                if (*ctx->selected_adsr_option == 0) { // Mode
+                    if (kDown & KEY_UP)
+                        track_params->svf_mode = (track_params->svf_mode + 1) % SVF_MODE_COUNT;
+                    if (kDown & KEY_DOWN)
+                        track_params->svf_mode =
+                            (track_params->svf_mode - 1 + SVF_MODE_COUNT) % SVF_MODE_COUNT;
+                } else if (*ctx->selected_adsr_option == 1) { // Cutoff, a semitone a press
+                    if (handle_continuous_press(kDown, kHeld, now, KEY_UP, ctx->up_timer,
+                                                ctx->HOLD_DELAY_INITIAL, ctx->HOLD_DELAY_REPEAT))
+                        track_params->svf_cutoff *= 1.0594631f;
+                    if (handle_continuous_press(kDown, kHeld, now, KEY_DOWN, ctx->down_timer,
+                                                ctx->HOLD_DELAY_INITIAL, ctx->HOLD_DELAY_REPEAT))
+                        track_params->svf_cutoff /= 1.0594631f;
+                    track_params->svf_cutoff =
+                        clamp(track_params->svf_cutoff, SVF_MIN_CUTOFF, 20000.0f);
+                } else if (*ctx->selected_adsr_option == 2) { // Resonance
+                    if (handle_continuous_press(kDown, kHeld, now, KEY_UP, ctx->up_timer,
+                                                ctx->HOLD_DELAY_INITIAL, ctx->HOLD_DELAY_REPEAT))
+                        track_params->svf_resonance += 0.05f;
+                    if (handle_continuous_press(kDown, kHeld, now, KEY_DOWN, ctx->down_timer,
+                                                ctx->HOLD_DELAY_INITIAL, ctx->HOLD_DELAY_REPEAT))
+                        track_params->svf_resonance -= 0.05f;
+                    track_params->svf_resonance = clamp(track_params->svf_resonance, 0.0f, 1.0f);
+                } else if (*ctx->selected_adsr_option == 3) { // Env amount, in octaves
+                    if (handle_continuous_press(kDown, kHeld, now, KEY_UP, ctx->up_timer,
+                                                ctx->HOLD_DELAY_INITIAL, ctx->HOLD_DELAY_REPEAT))
+                        track_params->svf_env_amount += 0.25f;
+                    if (handle_continuous_press(kDown, kHeld, now, KEY_DOWN, ctx->down_timer,
+                                                ctx->HOLD_DELAY_INITIAL, ctx->HOLD_DELAY_REPEAT))
+                        track_params->svf_env_amount -= 0.25f;
+                    track_params->svf_env_amount = clamp(
+                        track_params->svf_env_amount, -SVF_MAX_ENV_OCTAVES, SVF_MAX_ENV_OCTAVES);
+                } else if (*ctx->selected_adsr_option == 4) { // Env decay
+                    if (handle_continuous_press(kDown, kHeld, now, KEY_UP, ctx->up_timer,
+                                                ctx->HOLD_DELAY_INITIAL, ctx->HOLD_DELAY_REPEAT))
+                        track_params->svf_env_decay += 10;
+                    if (handle_continuous_press(kDown, kHeld, now, KEY_DOWN, ctx->down_timer,
+                                                ctx->HOLD_DELAY_INITIAL, ctx->HOLD_DELAY_REPEAT))
+                        track_params->svf_env_decay -= 10;
+                    if (track_params->svf_env_decay < 0)
+                        track_params->svf_env_decay = 0;
+                }
+                ctx->last_edited_param_unique_id = param_to_edit->unique_id;
+                ctx->last_edited_param_type      = param_to_edit->type;
+                ctx->last_edited_param_label     = param_to_edit->label;
+                break;
+            }
+
             case PARAM_TYPE_ENVELOPE_BUTTON: {
                 if (kDown & KEY_LEFT)
 
@@ -1080,28 +1057,5 @@ void handleInputStepEditView(SessionContext *ctx, u32 kDown, u32 kHeld, u64 now)
             }
             }
         }
-
-        // Update ctx->editing_step_params->instrument_data with the current instrument-specific
-        // parameters
-
-        if (track->instrument_type == SUB_SYNTH) {
-            memcpy(ctx->editing_step_params->instrument_data, ctx->editing_subsynth_params,
-
-                   sizeof(SubSynthParameters));
-
-        } else if (track->instrument_type == OPUS_SAMPLER) {
-            memcpy(ctx->editing_step_params->instrument_data, ctx->editing_sampler_params,
-
-                   sizeof(OpusSamplerParameters));
-
-        } else if (track->instrument_type == FM_SYNTH) {
-            memcpy(ctx->editing_step_params->instrument_data, ctx->editing_fm_synth_params,
-
-                   sizeof(FMSynthParameters));
-        } else if (track->instrument_type == NOISE_SYNTH) {
-            memcpy(ctx->editing_step_params->instrument_data, ctx->editing_noise_synth_params,
-
-                   sizeof(NoiseSynthParameters));
-        }
     }
 }
\ No newline at end of file
@@ -8,45 +8,15 @@
 #include "sample_bank.h"
 #include <string.h>
 
-extern int generateParameterList(Track *track, TrackParameters *params, SampleBank *sample_bank,
-                                 ParameterInfo *list_buffer, int max_params);
-
 void initEditingParams(SessionContext *ctx, Track *track, int selected_col) {
-    if (selected_col == 0) { // All steps
-        memcpy(ctx->editing_step_params, track->default_parameters, sizeof(TrackParameters));
-        if (track->instrument_type == SUB_SYNTH) {
-            memcpy(ctx->editing_subsynth_params, track->default_parameters->instrument_data,
-                   sizeof(SubSynthParameters));
-        } else if (track->instrument_type == OPUS_SAMPLER) {
-            memcpy(ctx->editing_sampler_params, track->default_parameters->instrument_data,
-                   sizeof(OpusSamplerParameters));
-        } else if (track->instrument_type == FM_SYNTH) {
-            memcpy(ctx->editing_fm_synth_params, track->default_parameters->instrument_data,
-                   sizeof(FMSynthParameters));
-        } else if (track->instrument_type == NOISE_SYNTH) {
-            memcpy(ctx->editing_noise_synth_params, track->default_parameters->instrument_data,
-                   sizeof(NoiseSynthParameters));
-        }
-    } else { // Specific step
-        int step_idx = selected_col - 1;
-        if (step_idx >= 0) {
-            SeqStep *seq_step = &track->sequencer->steps[step_idx];
-            memcpy(ctx->editing_step_params, seq_step->data, sizeof(TrackParameters));
-            if (track->instrument_type == SUB_SYNTH) {
-                memcpy(ctx->editing_subsynth_params, seq_step->data->instrument_data,
-                       sizeof(SubSynthParameters));
-            } else if (track->instrument_type == OPUS_SAMPLER) {
-                memcpy(ctx->editing_sampler_params, seq_step->data->instrument_data,
-                       sizeof(OpusSamplerParameters));
-            } else if (track->instrument_type == FM_SYNTH) {
-                memcpy(ctx->editing_fm_synth_params, seq_step->data->instrument_data,
-                       sizeof(FMSynthParameters));
-            } else if (track->instrument_type == NOISE_SYNTH) {
-                memcpy(ctx->editing_noise_synth_params, seq_step->data->instrument_data,
-                       sizeof(NoiseSynthParameters));
-            }
+    const StepParameters *source = track->default_parameters; // All steps
+    if (selected_col > 0) {                                     // Specific step
+        const StepParameters *step = patternStepParams(track->sequencer->edit, selected_col - 1);
+        if (step) {
+            source = step;
         }
     }
+    *ctx->editing_step = *source;
 }
 
 void handleInputStepSettings(SessionContext *ctx, u32 kDown) {
@@ -55,16 +25,12 @@ void handleInputStepSettings(SessionContext *ctx, u32 kDown) {
         return;
     Track *track = &ctx->tracks[track_idx];
 
-    TrackParameters *params_to_show;
-    bool             is_all_steps = (*ctx->selected_col == 0);
-    if (is_all_steps) {
-        params_to_show = track->default_parameters;
-    } else {
-        int step_idx = *ctx->selected_col - 1;
-        if (step_idx >= 0 && track->sequencer && track->sequencer->steps) {
-            params_to_show = track->sequencer->steps[step_idx].data;
-        } else {
-            params_to_show = track->default_parameters; // Fallback
+    const StepParameters *params_to_show = track->default_parameters;
+    if (*ctx->selected_col > 0) {
+        const StepParameters *step =
+            patternStepParams(track->sequencer->edit, *ctx->selected_col - 1);
+        if (step) {
+            params_to_show = step;
         }
     }
 
@@ -116,7 +82,7 @@ void handleInputStepSettings(SessionContext *ctx, u32 kDown) {
     }
 
     if (kDown & KEY_X) {
-        int n_steps        = track->sequencer->n_beats * track->sequencer->steps_per_beat;
+        int n_steps        = (int) patternLength(track->sequencer->edit);
         *ctx->selected_col = (*ctx->selected_col + 1) % (n_steps + 1);
     }
 
@@ -128,7 +94,7 @@ void handleInputStepSettings(SessionContext *ctx, u32 kDown) {
             if (*ctx->selected_step_option >= 0 && *ctx->selected_step_option < param_count) {
                 ctx->session->main_screen_view = VIEW_STEP_SETTINGS_EDIT;
                 *ctx->screen_focus             = FOCUS_TOP;
-                *ctx->selected_adsr_option     = 0; // Reset ADSR selection
+                *ctx->selected_adsr_option     = 0; // Reset ADSR or filter field selection
             }
         }
     }
@@ -8,52 +8,66 @@
 void handleInputTouchClock(SessionContext *ctx, u32 kDown, u32 kHeld, u64 now) {
     if (kDown & KEY_UP) {
         *ctx->selected_touch_clock_option =
-            (*ctx->selected_touch_clock_option > 0) ? *ctx->selected_touch_clock_option - 1 : 2;
+            (*ctx->selected_touch_clock_option > 0) ? *ctx->selected_touch_clock_option - 1 : 3;
     }
     if (kDown & KEY_DOWN) {
         *ctx->selected_touch_clock_option =
-            (*ctx->selected_touch_clock_option < 2) ? *ctx->selected_touch_clock_option + 1 : 0;
+            (*ctx->selected_touch_clock_option < 3) ? *ctx->selected_touch_clock_option + 1 : 0;
     }
     if (kDown & KEY_B) {
         ctx->session->touch_screen_view = VIEW_TOUCH_SETTINGS;
     }
-    if (kDown & KEY_A && *ctx->selected_touch_clock_option == 2) {
+    if (kDown & KEY_A && *ctx->selected_touch_clock_option == 3) {
         ctx->session->touch_screen_view = VIEW_TOUCH_SETTINGS;
     }
     if (handle_continuous_press(kDown, kHeld, now, KEY_LEFT, ctx->left_timer,
                                 ctx->HOLD_DELAY_INITIAL, ctx->HOLD_DELAY_REPEAT)) {
         if (*ctx->selected_touch_clock_option == 0) { // BPM
-            float new_bpm = ctx->clock->bpm - 1;
+            float new_bpm = clockDisplayRead(&g_clock_display).bpm - 1;
             if (new_bpm < 20)
                 new_bpm = 20;
             Event event             = { .type = SET_BPM };
             event.data.bpm_data.bpm = new_bpm;
             eventQueuePush(ctx->event_queue, event);
         } else if (*ctx->selected_touch_clock_option == 1) { // Beats per bar
-            int new_beats = ctx->clock->barBeats->beats_per_bar - 1;
+            int new_beats = clockDisplayRead(&g_clock_display).beats_per_bar - 1;
             if (new_beats < 2)
                 new_beats = 2;
             Event event                 = { .type = SET_BEATS_PER_BAR };
             event.data.beats_data.beats = new_beats;
             eventQueuePush(ctx->event_queue, event);
+        } else if (*ctx->selected_touch_clock_option == 2) { // Latency
+            int profile = currentLatencyProfile() - 1;
+            if (profile < 0)
+                profile = 0;
+            Event event                     = { .type = SET_LATENCY_PROFILE };
+            event.data.latency_data.profile = profile;
+            eventQueuePush(ctx->event_queue, event);
         }
     }
     if (handle_continuous_press(kDown, kHeld, now, KEY_RIGHT, ctx->right_timer,
                                 ctx->HOLD_DELAY_INITIAL, ctx->HOLD_DELAY_REPEAT)) {
         if (*ctx->selected_touch_clock_option == 0) { // BPM
-            float new_bpm = ctx->clock->bpm + 1;
+            float new_bpm = clockDisplayRead(&g_clock_display).bpm + 1;
             if (new_bpm > 200)
                 new_bpm = 200;
             Event event             = { .type = SET_BPM };
             event.data.bpm_data.bpm = new_bpm;
             eventQueuePush(ctx->event_queue, event);
         } else if (*ctx->selected_touch_clock_option == 1) { // Beats per bar
-            int new_beats = ctx->clock->barBeats->beats_per_bar + 1;
+            int new_beats = clockDisplayRead(&g_clock_display).beats_per_bar + 1;
             if (new_beats > 16)
                 new_beats = 16;
             Event event                 = { .type = SET_BEATS_PER_BAR };
             event.data.beats_data.beats = new_beats;
             eventQueuePush(ctx->event_queue, event);
+        } else if (*ctx->selected_touch_clock_option == 2) { // Latency
+            int profile = currentLatencyProfile() + 1;
+            if (profile >= LATENCY_PROFILE_COUNT)
+                profile = LATENCY_PROFILE_COUNT - 1;
+            Event event                     = { .type = SET_LATENCY_PROFILE };
+            event.data.latency_data.profile = profile;
+            eventQueuePush(ctx->event_queue, event);
         }
     }
 }
\ No newline at end of file
@@ -21,14 +21,14 @@ void handleInputTouchSettings(SessionContext *ctx, u32 kDown, u32 kHeld, u64 now
         *ctx->selected_sample_row       = 0;
         *ctx->selected_sample_col       = 0;
     }
+    ClockStatus status = clockDisplayRead(&g_clock_display).status;
     if (kDown & KEY_Y && *ctx->selected_touch_option == 0) {
-        Event event = { .type = (ctx->clock->status == PLAYING) ? PAUSE_CLOCK : RESUME_CLOCK };
+        Event event = { .type = (status == PLAYING) ? PAUSE_CLOCK : RESUME_CLOCK };
         eventQueuePush(ctx->event_queue, event);
     }
     if (kDown & KEY_X && *ctx->selected_touch_option == 0) {
-        Event event = { .type = (ctx->clock->status == PLAYING || ctx->clock->status == PAUSED)
-                                    ? STOP_CLOCK
-                                    : START_CLOCK };
+        Event event = { .type = (status == PLAYING || status == PAUSED) ? STOP_CLOCK
+                                                                         : START_CLOCK };
         eventQueuePush(ctx->event_queue, event);
 
         if (event.type == STOP_CLOCK) {
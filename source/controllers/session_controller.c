@@ -32,6 +32,10 @@ bool handle_continuous_press(u32 kDown, u32 kHeld, u64 now, u32 key, u64 *timer,
     return false;
 }
 
+int currentLatencyProfile(void) {
+    return clockDisplayRead(&g_clock_display).latency_profile;
+}
+
 void sessionControllerHandleInput(SessionContext *ctx, u32 kDown, u32 kHeld, u64 now,
                                   bool *should_break_loop) {
     if (kDown & KEY_START) {
@@ -44,6 +48,10 @@ void sessionControllerHandleInput(SessionContext *ctx, u32 kDown, u32 kHeld, u64
         eventQueuePush(ctx->event_queue, event);
     }
 
+    if (kDown & KEY_SELECT) {
+        ctx->session->show_audio_stats = !ctx->session->show_audio_stats;
+    }
+
     if (ctx->session->main_screen_view != VIEW_QUIT) {
         if (kDown & KEY_R) {
             *ctx->screen_focus = (*ctx->screen_focus == FOCUS_TOP) ? FOCUS_BOTTOM : FOCUS_TOP;
@@ -1,5 +1,6 @@
 #include "envelope.h"
 #include <stdio.h>
+#include <string.h>
 
 #ifdef TESTING
 #include "../tests/mock_3ds.h"
@@ -45,10 +46,9 @@ void updateEnvelope(Envelope *env, int attack_ms, int decay_ms, float sustain_le
     env->dur_samples   = dur_ms * sr_ms;
 }
 
-float nextEnvelopeSample(Envelope *env) {
-    if (!env)
-        return 0.0f;
-
+// One sample of the state machine. Only used where a segment may end, the block renderer emits
+// everything else as plain ramps.
+static inline float stepEnvelope(Envelope *env) {
     switch (env->state) {
     case ENVELOPE_STATE_IDLE:
         env->output = 0.0f;
@@ -84,3 +84,91 @@ float nextEnvelopeSample(Envelope *env) {
     }
     return env->output;
 }
+
+// Number of ramp steps of size rate that are guaranteed not to cross a segment boundary that is
+// distance away. Each float add/sub rounds by at most 2^-24 for values below 2, so the accumulated
+// error is budgeted per step; this keeps the unchecked ramp bit-identical to stepEnvelope.
+static inline size_t safeRampLength(float distance, float rate, size_t max) {
+    if (distance <= 0.0f) {
+        return 0;
+    }
+    float steps = distance / (rate + ENVELOPE_RAMP_ERROR);
+    if (steps <= 1.0f) {
+        return 0;
+    }
+    size_t run = (size_t) steps - 1;
+    return run < max ? run : max;
+}
+
+void renderEnvelopeBlock(Envelope *env, float *out, size_t n) {
+    if (!env) {
+        memset(out, 0, n * sizeof(float));
+        return;
+    }
+
+    size_t i = 0;
+    while (i < n) {
+        size_t run = 0;
+        float  o   = env->output;
+
+        switch (env->state) {
+        case ENVELOPE_STATE_IDLE:
+            env->output = 0.0f;
+            for (; i < n; i++) {
+                out[i] = 0.0f;
+            }
+            return;
+        case ENVELOPE_STATE_ATTACK: {
+            const float r = env->attack_rate;
+            run           = safeRampLength(1.0f - o, r, n - i);
+            for (size_t k = 0; k < run; k++) {
+                o += r;
+                out[i + k] = o;
+            }
+            break;
+        }
+        case ENVELOPE_STATE_DECAY: {
+            const float r = env->decay_rate;
+            run           = safeRampLength(o - env->sustain_level, r, n - i);
+            for (size_t k = 0; k < run; k++) {
+                o -= r;
+                out[i + k] = o;
+            }
+            break;
+        }
+        case ENVELOPE_STATE_SUSTAIN: {
+            u32 left = (env->dur_samples > env->env_pos + 1) ? env->dur_samples - env->env_pos - 1
+                                                              : 0;
+            run      = (left < n - i) ? left : n - i;
+            for (size_t k = 0; k < run; k++) {
+                out[i + k] = o;
+            }
+            env->env_pos += run;
+            break;
+        }
+        case ENVELOPE_STATE_RELEASE: {
+            const float r = env->release_rate;
+            run           = safeRampLength(o, r, n - i);
+            for (size_t k = 0; k < run; k++) {
+                o -= r;
+                out[i + k] = o;
+            }
+            break;
+        }
+        }
+
+        env->output = o;
+        i += run;
+
+        // The sample that may end the segment goes through the state machine
+        if (i < n) {
+            out[i++] = stepEnvelope(env);
+        }
+    }
+}
+
+float nextEnvelopeSample(Envelope *env) {
+    float out = 0.0f;
+    renderEnvelopeBlock(env, &out, 1);
+    return out;
+}
@@ -1,37 +1,102 @@
 #include "event_queue.h"
 
+_Static_assert((EVENT_QUEUE_SIZE & (EVENT_QUEUE_SIZE - 1)) == 0, "ring positions wrap at 2^32");
+_Static_assert(EVENT_PAYLOAD_SLOTS <= 32, "the free payloads are one 32-bit mask");
+
+// Cell sequences follow the bounded MPMC ring scheme: a cell whose sequence equals a producer's
+// claimed position is free for that lap, one past it holds an event for the consumer, and the
+// consumer moves it a whole ring ahead once read.
+
 void eventQueueInit(EventQueue *q) {
     atomic_init(&q->head, 0);
     atomic_init(&q->tail, 0);
-    LightLock_Init(&q->lock);
+    for (u32 i = 0; i < EVENT_QUEUE_SIZE; i++) {
+        atomic_init(&q->cells[i].sequence, i);
+    }
+    atomic_init(&q->free_payloads, (u32) (((u64) 1 << EVENT_PAYLOAD_SLOTS) - 1));
 }
 
 bool eventQueuePush(EventQueue *q, Event e) {
-    // MPSC: Must be locked to protect against multiple producers
-    LightLock_Lock(&q->lock);
-
-    int head      = atomic_load_explicit(&q->head, memory_order_relaxed);
-    int next_head = (head + 1) % EVENT_QUEUE_SIZE;
-    if (next_head == atomic_load_explicit(&q->tail, memory_order_acquire)) {
-        // Queue is full
-        LightLock_Unlock(&q->lock);
+    u32 pos = atomic_load_explicit(&q->head, memory_order_relaxed);
+    for (;;) {
+        EventCell *cell = &q->cells[pos % EVENT_QUEUE_SIZE];
+        u32        seq  = atomic_load_explicit(&cell->sequence, memory_order_acquire);
+        s32        lap  = (s32) (seq - pos);
+        if (lap == 0) {
+            // Free for this lap: claim it, on failure pos holds the head another producer left
+            if (atomic_compare_exchange_weak_explicit(&q->head, &pos, pos + 1,
+                                                      memory_order_relaxed,
+                                                      memory_order_relaxed)) {
+                cell->event = e;
+                atomic_store_explicit(&cell->sequence, pos + 1, memory_order_release);
+                return true;
+            }
+        } else if (lap < 0) {
+            // Queue is full: the consumer has not read this cell's last event
+            return false;
+        } else {
+            pos = atomic_load_explicit(&q->head, memory_order_relaxed);
+        }
+    }
+}
+
+static int claimPayload(EventQueue *q) {
+    u32 free_mask = atomic_load_explicit(&q->free_payloads, memory_order_relaxed);
+    while (free_mask != 0) {
+        u32 slot = (u32) __builtin_ctz(free_mask);
+        if (atomic_compare_exchange_weak_explicit(&q->free_payloads, &free_mask,
+                                                  free_mask & ~(1u << slot),
+                                                  memory_order_acquire, memory_order_relaxed)) {
+            return (int) slot;
+        }
+    }
+    return -1;
+}
+
+static void releasePayload(EventQueue *q, u32 slot) {
+    atomic_fetch_or_explicit(&q->free_payloads, 1u << slot, memory_order_release);
+}
+
+bool eventQueuePushStep(EventQueue *q, EventType type, int track_id,
+                        InstrumentType instrument_type, const StepParameters *params) {
+    int slot = claimPayload(q);
+    if (slot < 0) {
         return false;
     }
-    q->events[head] = e;
-    atomic_store_explicit(&q->head, next_head, memory_order_release);
+    q->payloads[slot] = (StepPayload) { .instrument_type = instrument_type, .params = *params };
 
-    LightLock_Unlock(&q->lock);
+    Event e                  = { .type = type, .track_id = track_id };
+    e.data.step_data.payload = (u32) slot;
+    if (!eventQueuePush(q, e)) {
+        releasePayload(q, (u32) slot);
+        return false;
+    }
     return true;
 }
 
 bool eventQueuePop(EventQueue *q, Event *e) {
-    // SPSC only: must be called by single consumer thread
-    int tail = atomic_load_explicit(&q->tail, memory_order_relaxed);
-    if (atomic_load_explicit(&q->head, memory_order_acquire) == tail) {
-        // Queue is empty
+    // Single consumer: tail is only written here
+    u32        pos  = atomic_load_explicit(&q->tail, memory_order_relaxed);
+    EventCell *cell = &q->cells[pos % EVENT_QUEUE_SIZE];
+    if (atomic_load_explicit(&cell->sequence, memory_order_acquire) != pos + 1) {
+        // Queue is empty, or its next event is still being written
         return false;
     }
-    *e = q->events[tail];
-    atomic_store_explicit(&q->tail, (tail + 1) % EVENT_QUEUE_SIZE, memory_order_release);
+    *e = cell->event;
+    atomic_store_explicit(&cell->sequence, pos + EVENT_QUEUE_SIZE, memory_order_release);
+    atomic_store_explicit(&q->tail, pos + 1, memory_order_relaxed);
     return true;
 }
+
+const StepPayload *eventQueuePayload(const EventQueue *q, const Event *e) {
+    if (e->data.step_data.payload >= EVENT_PAYLOAD_SLOTS) {
+        return NULL;
+    }
+    return &q->payloads[e->data.step_data.payload];
+}
+
+void eventQueueReleasePayload(EventQueue *q, const Event *e) {
+    if (e->data.step_data.payload < EVENT_PAYLOAD_SLOTS) {
+        releasePayload(q, e->data.step_data.payload);
+    }
+}
@@ -1,49 +1,310 @@
 #include "fm_osc.h"
-#include "polybleposc.h"
+#include "audio_simd.h"
+#include "engine_constants.h"
 #include <math.h>
+#include <string.h>
 
-void FMOpSetCarrierFrequency(FMOperator *op, float freq) {
-    if (!op || !op->carrier)
-        return;
-    setOscFrequency(op->carrier, freq);
-    op->base_frequency = freq;
+// Which operators feed each one, as a bitmask over the operator index, and which are heard
+typedef struct {
+    u8 modulators[FM_OPERATORS];
+    u8 carriers;
+} FMRoute;
+
+static const FMRoute fm_routes[FM_ALGORITHM_COUNT] = {
+    [FM_ALGO_STACK]          = { { 0x2, 0x4, 0x8, 0x0 }, 0x1 },
+    [FM_ALGO_TWIN_MODS]      = { { 0x2, 0xc, 0x0, 0x0 }, 0x1 },
+    [FM_ALGO_BRANCH]         = { { 0x6, 0x0, 0x8, 0x0 }, 0x1 },
+    [FM_ALGO_THREE_MODS]     = { { 0xe, 0x0, 0x0, 0x0 }, 0x1 },
+    [FM_ALGO_TWO_STACKS]     = { { 0x2, 0x0, 0x8, 0x0 }, 0x5 },
+    [FM_ALGO_ONE_TO_THREE]   = { { 0x8, 0x8, 0x8, 0x0 }, 0x7 },
+    [FM_ALGO_STACK_PLUS_ONE] = { { 0x2, 0x4, 0x0, 0x0 }, 0x9 },
+    [FM_ALGO_ADDITIVE]       = { { 0x0, 0x0, 0x0, 0x0 }, 0xf },
+};
+
+const char *fm_algorithm_names[] = {
+    [FM_ALGO_STACK]          = "4>3>2>1",
+    [FM_ALGO_TWIN_MODS]      = "(3+4)>2>1",
+    [FM_ALGO_BRANCH]         = "(2+4>3)>1",
+    [FM_ALGO_THREE_MODS]     = "(2+3+4)>1",
+    [FM_ALGO_TWO_STACKS]     = "2>1 + 4>3",
+    [FM_ALGO_ONE_TO_THREE]   = "4>(1,2,3)",
+    [FM_ALGO_STACK_PLUS_ONE] = "3>2>1 + 4",
+    [FM_ALGO_ADDITIVE]       = "1+2+3+4",
+};
+
+// Phase offset of one Q15 unit of modulation at a modulation index of one radian
+#define FM_PHASE_PER_RADIAN_Q15 (PHASE_RANGE / (2.0f * (float) M_PI) / 32768.0f)
+// Feedback adds the sum of the top operator's last two outputs, at full feedback that is up to pi
+#define FM_FEEDBACK_SCALE 32768.0f
+
+static void updatePhaseIncrements(FMSynth *fm) {
+    float hz_to_inc = PHASE_RANGE / fm->samplerate;
+    for (int op = 0; op < FM_OPERATORS; op++) {
+        float freq = fm->base_frequency * fm->ops[op].ratio;
+        if (freq > fm->samplerate * 0.5f) {
+            freq = fm->samplerate * 0.5f;
+        }
+        fm->ops[op].phase_inc = (u32) (freq * hz_to_inc);
+    }
 }
 
-void FMOpSetModRatio(FMOperator *op, float ratio) {
-    if (!op || !op->modulator || !op->carrier)
+void initFMSynth(FMSynth *fm, float samplerate) {
+    if (!fm)
         return;
-    setOscFrequency(op->modulator, op->base_frequency * ratio);
+    memset(fm, 0, sizeof(*fm));
+    fm->samplerate = samplerate;
+    fm->algorithm  = FM_ALGO_STACK;
+    for (int op = 0; op < FM_OPERATORS; op++) {
+        fm->ops[op].env   = defaultEnvelopeStruct(samplerate);
+        fm->ops[op].ratio = 1.0f;
+        fm->ops[op].level = (op == 0) ? 1.0f : 0.0f;
+    }
 }
 
-float nextFMOscillatorSample(FMOperator *op) {
-    if (!op || !op->carrier || !op->modulator || !op->mod_envelope)
-        return 0.0f;
+void FMSetFrequency(FMSynth *fm, float freq) {
+    if (!fm)
+        return;
+    fm->base_frequency = freq;
+    updatePhaseIncrements(fm);
+}
 
-    float mod_env_val = nextEnvelopeSample(op->mod_envelope);
-    float mod_signal  = nextOscillatorSample(op->modulator) * op->mod_depth * mod_env_val;
+void FMSetOperator(FMSynth *fm, int op, float ratio, float level) {
+    if (!fm || op < 0 || op >= FM_OPERATORS)
+        return;
+    fm->ops[op].ratio = ratio;
+    fm->ops[op].level = fmaxf(0.0f, fminf(1.0f, level));
+    updatePhaseIncrements(fm);
+}
 
-    float original_freq  = op->base_frequency;
-    float modulated_freq = original_freq + mod_signal * op->mod_index * original_freq;
+void FMSetAlgorithm(FMSynth *fm, int algorithm) {
+    if (!fm || algorithm < 0 || algorithm >= FM_ALGORITHM_COUNT)
+        return;
+    fm->algorithm = (FMAlgorithm) algorithm;
+}
 
-    // Clamp to prevent negative or extremely high frequencies
-    if (modulated_freq < 1.0f)
-        modulated_freq = 1.0f;
-    if (modulated_freq > 20000.0f)
-        modulated_freq = 20000.0f;
+void FMSetModIndex(FMSynth *fm, float index) {
+    if (!fm)
+        return;
+    fm->mod_index = fmaxf(0.0f, index);
+}
 
-    setOscFrequency(op->carrier, modulated_freq);
+void FMSetFeedback(FMSynth *fm, float feedback) {
+    if (!fm)
+        return;
+    fm->feedback = fmaxf(0.0f, fminf(1.0f, feedback));
+}
 
-    return nextOscillatorSample(op->carrier);
+bool FMIsCarrier(const FMSynth *fm, int op) {
+    return fm && op >= 0 && op < FM_OPERATORS && (fm_routes[fm->algorithm].carriers & (1u << op));
 }
 
-void FMOpSetModIndex(FMOperator *op, float index) {
-    if (!op)
+void triggerFMSynth(FMSynth *fm) {
+    if (!fm)
         return;
-    op->mod_index = index;
+    for (int op = 0; op < FM_OPERATORS; op++) {
+        fm->ops[op].phase = 0;
+        triggerEnvelope(&fm->ops[op].env);
+    }
+    fm->feedback_hist[0] = 0;
+    fm->feedback_hist[1] = 0;
+}
+
+bool FMIsIdle(const FMSynth *fm) {
+    if (!fm)
+        return true;
+    for (int op = 0; op < FM_OPERATORS; op++) {
+        if (FMIsCarrier(fm, op) && !envelopeIsIdle(&fm->ops[op].env)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Envelope value to Q15 amplitude: the operator level, and carriers share the output evenly
+static float amplitudeScale(const FMSynth *fm, int op) {
+    const FMRoute *route = &fm_routes[fm->algorithm];
+    float          scale = fm->ops[op].level * 32767.0f;
+    if (route->carriers & (1u << op)) {
+        scale /= (float) __builtin_popcount(route->carriers);
+    }
+    return scale;
 }
 
-void FMOpSetModDepth(FMOperator *op, float depth) {
-    if (!op)
+// One sample of every operator, from the top down so each modulator is ready before its targets.
+// Operators missing from active have an idle envelope and only advance their phase.
+static s32 fmTick(FMSynth *fm, const FMRoute *route, const s32 *amp, u32 active,
+                         u32 mod_scale, u32 fb_scale) {
+    s32 y[FM_OPERATORS] = { 0 };
+    s32 out             = 0;
+    for (int op = FM_OPERATORS - 1; op >= 0; op--) {
+        FMOperator *o = &fm->ops[op];
+        if (active & (1u << op)) {
+            u32 offset;
+            if (op == FM_OPERATORS - 1) {
+                offset = (u32) (fm->feedback_hist[0] + fm->feedback_hist[1]) * fb_scale;
+            } else {
+                s32 mod  = 0;
+                u32 mods = route->modulators[op];
+                for (int m = op + 1; m < FM_OPERATORS; m++) {
+                    if (mods & (1u << m)) {
+                        mod += y[m];
+                    }
+                }
+                // Wraps modulo the phase range, which is exactly the phase offset we want
+                offset = (u32) mod * mod_scale;
+            }
+            y[op] = (sineQ15FromPhase(o->phase + offset) * amp[op]) >> 15;
+            if (route->carriers & (1u << op)) {
+                out += y[op];
+            }
+        }
+        o->phase += o->phase_inc;
+    }
+    fm->feedback_hist[1] = fm->feedback_hist[0];
+    fm->feedback_hist[0] = y[FM_OPERATORS - 1];
+    return ssat16(out);
+}
+
+static u32 activeOperators(const FMSynth *fm) {
+    u32 active = 0;
+    for (int op = 0; op < FM_OPERATORS; op++) {
+        if (!envelopeIsIdle(&fm->ops[op].env)) {
+            active |= 1u << op;
+        }
+    }
+    return active;
+}
+
+// Renders one operator over the block into y, its envelope env scaled to a Q15 amplitude on the
+// way, phase modulated by mod (NULL when unmodulated)
+static void renderOperator(FMOperator *o, const float *env, float scale, const s32 *mod,
+                           u32 mod_scale, s32 *y, size_t n) {
+    u32       phase = o->phase;
+    const u32 inc   = o->phase_inc;
+    if (mod) {
+        for (size_t i = 0; i < n; i++) {
+            s32 amp = (s32) (env[i] * scale);
+            y[i]    = (sineQ15FromPhase(phase + (u32) mod[i] * mod_scale) * amp) >> 15;
+            phase += inc;
+        }
+    } else {
+        for (size_t i = 0; i < n; i++) {
+            s32 amp = (s32) (env[i] * scale);
+            y[i]    = (sineQ15FromPhase(phase) * amp) >> 15;
+            phase += inc;
+        }
+    }
+    o->phase = phase;
+}
+
+// The top operator modulates itself, so it has to run one sample at a time
+static void renderFeedbackOperator(FMSynth *fm, const float *env, float scale, u32 fb_scale, s32 *y,
+                                   size_t n) {
+    FMOperator *o     = &fm->ops[FM_OPERATORS - 1];
+    s32         h0    = fm->feedback_hist[0], h1 = fm->feedback_hist[1];
+    u32         phase = o->phase;
+    const u32   inc   = o->phase_inc;
+    for (size_t i = 0; i < n; i++) {
+        s32 amp = (s32) (env[i] * scale);
+        s32 v   = (sineQ15FromPhase(phase + (u32) (h0 + h1) * fb_scale) * amp) >> 15;
+        h1    = h0;
+        h0    = v;
+        y[i]  = v;
+        phase += inc;
+    }
+    o->phase             = phase;
+    fm->feedback_hist[0] = h0;
+    fm->feedback_hist[1] = h1;
+}
+
+// Same arithmetic as fmTick, one operator at a time over the whole block: the modulators are
+// rendered first into their own buffers, then summed into the phase of the operators below
+void renderFMBlock(FMSynth *fm, s16 *out, size_t n) {
+    if (!fm || FMIsIdle(fm)) {
+        memset(out, 0, n * sizeof(s16));
         return;
-    op->mod_depth = depth;
+    }
+
+    const FMRoute *route     = &fm_routes[fm->algorithm];
+    const u32      active    = activeOperators(fm);
+    const u32      mod_scale = (u32) (fm->mod_index * FM_PHASE_PER_RADIAN_Q15);
+    const u32      fb_scale  = (u32) (fm->feedback * FM_FEEDBACK_SCALE);
+
+    s32   y[FM_OPERATORS][RENDER_CHUNK];
+    s32   mod_sum[RENDER_CHUNK];
+    s32   sum[RENDER_CHUNK] = { 0 };
+    float env[RENDER_CHUNK];
+    for (int op = FM_OPERATORS - 1; op >= 0; op--) {
+        FMOperator *o = &fm->ops[op];
+        if (!(active & (1u << op))) {
+            // Idle operators output zeros, but keep their phase moving
+            memset(y[op], 0, n * sizeof(s32));
+            o->phase += o->phase_inc * (u32) n;
+            if (op == FM_OPERATORS - 1) {
+                fm->feedback_hist[0] = fm->feedback_hist[1] = 0;
+            }
+            continue;
+        }
+
+        float scale = amplitudeScale(fm, op);
+        renderEnvelopeBlock(&o->env, env, n);
+
+        // A single modulator is read in place, several are summed first
+        const s32 *mod  = NULL;
+        u32        mods = route->modulators[op] & active;
+        if (mods && !(mods & (mods - 1))) {
+            mod = y[__builtin_ctz(mods)];
+        } else if (mods) {
+            memset(mod_sum, 0, n * sizeof(s32));
+            for (int m = op + 1; m < FM_OPERATORS; m++) {
+                if (mods & (1u << m)) {
+                    for (size_t i = 0; i < n; i++) {
+                        mod_sum[i] += y[m][i];
+                    }
+                }
+            }
+            mod = mod_sum;
+        }
+
+        if (op == FM_OPERATORS - 1 && fb_scale) {
+            renderFeedbackOperator(fm, env, scale, fb_scale, y[op], n);
+        } else {
+            renderOperator(o, env, scale, mod, mod_scale, y[op], n);
+            if (op == FM_OPERATORS - 1) {
+                // No dependency between samples without feedback, the history is kept for when
+                // it is turned up
+                fm->feedback_hist[1] = n > 1 ? y[op][n - 2] : fm->feedback_hist[0];
+                fm->feedback_hist[0] = y[op][n - 1];
+            }
+        }
+
+        if (route->carriers & (1u << op)) {
+            for (size_t i = 0; i < n; i++) {
+                sum[i] += y[op][i];
+            }
+        }
+    }
+
+    for (size_t i = 0; i < n; i++) {
+        out[i] = (s16) ssat16(sum[i]);
+    }
+}
+
+float nextFMOscillatorSample(FMSynth *fm) {
+    if (!fm || FMIsIdle(fm)) {
+        return 0.0f;
+    }
+
+    const FMRoute *route  = &fm_routes[fm->algorithm];
+    const u32      active = activeOperators(fm);
+    s32            amp[FM_OPERATORS];
+    for (int op = 0; op < FM_OPERATORS; op++) {
+        if (active & (1u << op)) {
+            amp[op] = (s32) (nextEnvelopeSample(&fm->ops[op].env) * amplitudeScale(fm, op));
+        }
+    }
+    const u32 mod_scale = (u32) (fm->mod_index * FM_PHASE_PER_RADIAN_Q15);
+    const u32 fb_scale  = (u32) (fm->feedback * FM_FEEDBACK_SCALE);
+    s32       s         = fmTick(fm, route, amp, active, mod_scale, fb_scale);
+    return (float) s / 32768.0f;
 }
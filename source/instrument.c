@@ -0,0 +1,111 @@
+#include "instrument.h"
+#include "audio_utils.h"
+#include "engine_constants.h"
+#include "noise_synth.h"
+#include "samplers.h"
+#include "synth.h"
+#include "track_parameters.h"
+
+#include <math.h>
+#include <string.h>
+
+bool instrumentIsSilent(InstrumentType type, const void *instrument) {
+    switch (type) {
+    case SUB_SYNTH:
+        return isSubSynthSilent((const SubSynth *) instrument);
+    case FM_SYNTH:
+        return isFMSynthSilent((const FMSynth *) instrument);
+    case OPUS_SAMPLER:
+        return isSamplerSilent((const Sampler *) instrument);
+    case NOISE_SYNTH:
+        return isNoiseSynthSilent((const NoiseSynth *) instrument);
+    }
+    return true;
+}
+
+void renderInstrumentAudio(InstrumentType type, void *instrument, u32 *dest, size_t n) {
+    if (instrumentIsSilent(type, instrument)) {
+        memset(dest, 0, n * BYTESPERSAMPLE);
+        return;
+    }
+
+    switch (type) {
+    case SUB_SYNTH:
+        renderSubSynthAudio(dest, n, (SubSynth *) instrument);
+        break;
+    case OPUS_SAMPLER:
+        renderSamplerAudio(dest, n, (Sampler *) instrument);
+        break;
+    case FM_SYNTH:
+        renderFMSynthAudio(dest, n, (FMSynth *) instrument);
+        break;
+    case NOISE_SYNTH:
+        renderNoiseSynthAudio(dest, n, (NoiseSynth *) instrument);
+        break;
+    }
+}
+
+void applyInstrumentStep(InstrumentType type, void *instrument, const void *params,
+                         bool retrigger) {
+    if (!instrument || !params) {
+        return;
+    }
+
+    if (type == SUB_SYNTH) {
+        const SubSynthParameters *p  = (const SubSynthParameters *) params;
+        SubSynth                 *ss = (SubSynth *) instrument;
+        updateEnvelope(ss->env, p->env_atk, p->env_dec, p->env_sus_level, p->env_rel, p->env_dur);
+        setWaveform(ss->osc, p->osc_waveform);
+        setPulseWidth(ss->osc, p->pulse_width);
+        setOscFrequency(ss->osc, p->osc_freq);
+        if (retrigger) {
+            triggerEnvelope(ss->env);
+        }
+    } else if (type == OPUS_SAMPLER) {
+        const OpusSamplerParameters *p = (const OpusSamplerParameters *) params;
+        Sampler                     *s = (Sampler *) instrument;
+        updateEnvelope(s->env, p->env_atk, p->env_dec, p->env_sus_level, p->env_rel, p->env_dur);
+        s->start_position = p->start_position;
+        s->playback_mode  = p->playback_mode;
+        s->current_frame  = s->start_position / NCHANNELS;
+        // A start past the end, as after a shorter sample was swapped in, plays nothing
+        s->finished = !s->sample || s->current_frame >= s->sample->pcm_data_size_in_frames;
+        if (retrigger) {
+            triggerEnvelope(s->env);
+        }
+    } else if (type == FM_SYNTH) {
+        const FMSynthParameters *p  = (const FMSynthParameters *) params;
+        FMSynth                 *fs = (FMSynth *) instrument;
+        float                    depth = fmaxf(0.0f, fminf(1.0f, p->mod_depth / 100.0f));
+        FMSetAlgorithm(fs, p->algorithm);
+        FMSetModIndex(fs, p->mod_index * FM_MAX_MOD_INDEX);
+        FMSetFeedback(fs, p->feedback);
+        // Carriers take the carrier envelope, modulators the mod envelope, ratio and depth
+        for (int op = 0; op < FM_OPERATORS; op++) {
+            Envelope *env = &fs->ops[op].env;
+            if (FMIsCarrier(fs, op)) {
+                FMSetOperator(fs, op, p->op_ratio[op], p->op_level[op]);
+                updateEnvelope(env, p->carrier_env_atk, p->carrier_env_dec,
+                               p->carrier_env_sus_level, p->carrier_env_rel, p->env_dur);
+            } else {
+                FMSetOperator(fs, op, p->op_ratio[op] * p->mod_freq_ratio,
+                              p->op_level[op] * depth);
+                updateEnvelope(env, p->mod_env_atk, p->mod_env_dec, p->mod_env_sus_level,
+                               p->mod_env_rel, p->env_dur);
+            }
+        }
+        FMSetFrequency(fs, p->carrier_freq);
+        if (retrigger) {
+            triggerFMSynth(fs);
+        }
+    } else if (type == NOISE_SYNTH) {
+        const NoiseSynthParameters *p  = (const NoiseSynthParameters *) params;
+        NoiseSynth                 *ns = (NoiseSynth *) instrument;
+        updateEnvelope(ns->env, p->env_atk, p->env_dec, p->env_sus_level, p->env_rel, p->env_dur);
+        setNoiseMode(ns, p->mode);
+        setNoiseRateDiv(ns, p->rate_div);
+        if (retrigger) {
+            triggerEnvelope(ns->env);
+        }
+    }
+}
@@ -0,0 +1,47 @@
+#ifdef TESTING
+#include "../tests/mock_3ds.h"
+#else
+#include <3ds/ndsp/channel.h>
+#include <3ds/ndsp/ndsp.h>
+#include <3ds/services/dsp.h>
+#include <3ds/types.h>
+#endif
+
+#include "latency.h"
+#include "audio_utils.h"
+
+#include <string.h>
+
+// Queued audio (block_ms * n_wavebufs) never exceeds LATENCY_MAX_QUEUED_MS
+const LatencyProfile latency_profiles[LATENCY_PROFILE_COUNT] = {
+    [LATENCY_10MS]  = { .name = "10 ms", .block_ms = 10, .n_wavebufs = 4 },
+    [LATENCY_20MS]  = { .name = "20 ms", .block_ms = 20, .n_wavebufs = 3 },
+    [LATENCY_40MS]  = { .name = "40 ms", .block_ms = 40, .n_wavebufs = 2 },
+    [LATENCY_120MS] = { .name = "120 ms", .block_ms = 120, .n_wavebufs = 2 },
+};
+
+u32 latencyBlockFrames(LatencyProfileId id, float rate) {
+    return (u32) (rate * latency_profiles[id].block_ms / 1000);
+}
+
+void queueWaveBufs(int chan_id, ndspWaveBuf *waveBufs, u32 *buffer, u32 block_frames,
+                   int n_wavebufs) {
+    memset(waveBufs, 0, MAX_WAVEBUFS * sizeof(ndspWaveBuf));
+    fillBufferWithZeros(buffer, block_frames * BYTESPERSAMPLE * n_wavebufs);
+    DSP_FlushDataCache(buffer, block_frames * BYTESPERSAMPLE * n_wavebufs);
+
+    for (int i = 0; i < n_wavebufs; i++) {
+        waveBufs[i].data_vaddr = &buffer[i * block_frames];
+        waveBufs[i].nsamples   = block_frames;
+        ndspChnWaveBufAdd(chan_id, &waveBufs[i]);
+    }
+}
+
+bool waveBufsStarved(const ndspWaveBuf *waveBufs, int n_wavebufs) {
+    for (int i = 0; i < n_wavebufs; i++) {
+        if (waveBufs[i].status != NDSP_WBUF_DONE) {
+            return false;
+        }
+    }
+    return true;
+}
@@ -0,0 +1,153 @@
+#include "linear_region.h"
+
+#include <stdint.h>
+#include <string.h>
+
+#ifndef TESTING
+#include <3ds/allocator/linear.h>
+#endif
+
+const char *linear_tag_names[] = { "Samples", "Instruments", "Buffers", "UI" };
+
+static LinearUsage s_usage[LINEAR_TAG_COUNT];
+
+#ifdef TESTING
+// The host heap cannot report a block's size, so each one carries it in a header. The header
+// keeps malloc's alignment for the block behind it.
+#define MOCK_HEADER_SIZE 16
+
+static size_t s_mock_capacity;
+
+void linearMockSetCapacity(size_t capacity) {
+    s_mock_capacity = capacity;
+}
+
+static void *heapAlloc(size_t size) {
+    if (s_mock_capacity && linearUsageTotal() + size > s_mock_capacity) {
+        return NULL;
+    }
+    u8 *block = malloc(MOCK_HEADER_SIZE + size);
+    if (!block) {
+        return NULL;
+    }
+    memcpy(block, &size, sizeof(size));
+    return block + MOCK_HEADER_SIZE;
+}
+
+static size_t heapSize(void *ptr) {
+    size_t size;
+    memcpy(&size, (u8 *) ptr - MOCK_HEADER_SIZE, sizeof(size));
+    return size;
+}
+
+static void heapFree(void *ptr) {
+    free((u8 *) ptr - MOCK_HEADER_SIZE);
+}
+#else
+static void *heapAlloc(size_t size) {
+    return linearAlloc(size);
+}
+
+static size_t heapSize(void *ptr) {
+    return linearGetSize(ptr);
+}
+
+static void heapFree(void *ptr) {
+    linearFree(ptr);
+}
+#endif
+
+void *linearAllocTagged(LinearTag tag, size_t size) {
+    if (tag >= LINEAR_TAG_COUNT) {
+        return NULL;
+    }
+    void *ptr = heapAlloc(size);
+    if (!ptr) {
+        return NULL;
+    }
+    LinearUsage *usage = &s_usage[tag];
+    usage->in_use += heapSize(ptr);
+    usage->n_blocks++;
+    if (usage->in_use > usage->peak) {
+        usage->peak = usage->in_use;
+    }
+    return ptr;
+}
+
+void linearFreeTagged(LinearTag tag, void *ptr) {
+    if (!ptr || tag >= LINEAR_TAG_COUNT) {
+        return;
+    }
+    LinearUsage *usage = &s_usage[tag];
+    size_t       size  = heapSize(ptr);
+    usage->in_use      = usage->in_use > size ? usage->in_use - size : 0;
+    if (usage->n_blocks > 0) {
+        usage->n_blocks--;
+    }
+    heapFree(ptr);
+}
+
+LinearUsage linearUsage(LinearTag tag) {
+    return tag < LINEAR_TAG_COUNT ? s_usage[tag] : (LinearUsage) { 0 };
+}
+
+size_t linearUsageTotal(void) {
+    size_t total = 0;
+    for (int tag = 0; tag < LINEAR_TAG_COUNT; tag++) {
+        total += s_usage[tag].in_use;
+    }
+    return total;
+}
+
+void linearUsageResetPeaks(void) {
+    for (int tag = 0; tag < LINEAR_TAG_COUNT; tag++) {
+        s_usage[tag].peak = s_usage[tag].in_use;
+    }
+}
+
+bool linearRegionInit(LinearRegion *region, LinearTag tag, size_t capacity) {
+    if (!region) {
+        return false;
+    }
+    memset(region, 0, sizeof(*region));
+    region->tag  = tag;
+    region->base = linearAllocTagged(tag, capacity);
+    if (!region->base) {
+        return false;
+    }
+    region->capacity = capacity;
+    return true;
+}
+
+void *linearRegionAlloc(LinearRegion *region, size_t size, size_t align) {
+    if (!region || !region->base || align == 0 || (align & (align - 1)) != 0) {
+        return NULL;
+    }
+    // Aligned against the address, the block itself may be less aligned than asked
+    uintptr_t base   = (uintptr_t) region->base;
+    size_t    offset = ((base + region->used + align - 1) & ~(uintptr_t) (align - 1)) - base;
+    if (offset > region->capacity || size > region->capacity - offset) {
+        return NULL;
+    }
+    region->used = offset + size;
+    if (region->used > region->peak) {
+        region->peak = region->used;
+    }
+    return region->base + offset;
+}
+
+void linearRegionReset(LinearRegion *region) {
+    if (region) {
+        region->used = 0;
+    }
+}
+
+void linearRegionDestroy(LinearRegion *region) {
+    if (!region || !region->base) {
+        return;
+    }
+    linearFreeTagged(region->tag, region->base);
+    region->base     = NULL;
+    region->capacity = 0;
+    region->used     = 0;
+}
@@ -20,6 +20,9 @@
 #include "threads/audio_thread.h"
 #include "noise_synth.h"
 #include "cleanup_queue.h"
+#include "mix_bus.h"
+#include "linear_region.h"
+#include "sine_table.h"
 
 #include <3ds.h>
 #include <3ds/os.h>
@@ -34,17 +37,25 @@
 #define ARRAY_SIZE(array) (sizeof(array) / sizeof(array[0]))
 #define STACK_SIZE (N_TRACKS * 32 * 1024)
 
+// NDSP buffers are carved from one region, each on its own 0x80 boundary like linearAlloc's
+#define DSP_BUFFER_ALIGN 0x80
+#define SYNTH_BUFFER_BYTES (2 * SAMPLESPERBUF * BYTESPERSAMPLE * NCHANNELS)
+#define SAMPLER_BUFFER_BYTES (2 * OPUSSAMPLESPERFBUF * BYTESPERSAMPLE * NCHANNELS)
+#define MIXBUS_BUFFER_BYTES (2 * MIXBUS_SAMPLESPERBUF * BYTESPERSAMPLE)
+#define SILENCE_BUFFER_BYTES (SILENCE_SAMPLES * BYTESPERSAMPLE)
+#define TRACK_BUFFER_BYTES (3 * SYNTH_BUFFER_BYTES + 2 * SAMPLER_BUFFER_BYTES)
+#define DSP_BUFFER_REGION_BYTES                                                                    \
+    ((USE_MIX_BUS ? MIXBUS_BUFFER_BYTES : TRACK_BUFFER_BYTES) + SILENCE_BUFFER_BYTES +             \
+     (N_TRACKS + 1) * DSP_BUFFER_ALIGN)
+
 static Track                 tracks[N_TRACKS];
-static LightLock             clock_lock;
 static volatile bool         should_exit = false;
 static EventQueue            g_event_queue;
+static MixBus                g_mix_bus;
+static LinearRegion          g_dsp_buffers;
 SampleBank                   g_sample_bank;
 static SampleBrowser         g_sample_browser;
-static TrackParameters       g_editing_step_params;
-static SubSynthParameters    g_editing_subsynth_params;
-static OpusSamplerParameters g_editing_sampler_params;
-static FMSynthParameters     g_editing_fm_synth_params;
-static NoiseSynthParameters  g_editing_noise_synth_params;
+static StepParameters        g_editing_step;
 
 int main(int argc, char **argv) {
     osSetSpeedupEnable(true);
@@ -55,9 +66,9 @@ int main(int argc, char **argv) {
     C2D_Prepare();
     initViews();
     sample_cleanup_init();
-    clock_display_init();
     SampleBankInit(&g_sample_bank);
     SampleBrowserInit(&g_sample_browser);
+    initSineTable();
 
     int ret = 0;
 
@@ -90,44 +101,25 @@ int main(int argc, char **argv) {
     ScreenFocus screen_focus          = FOCUS_TOP;
     ScreenFocus previous_screen_focus = FOCUS_TOP;
 
-    u32                   *audioBuffer1            = NULL;
-    PolyBLEPOscillator    *osc                     = NULL;
-    Envelope              *env                     = NULL;
-    SubSynth              *subsynth                = NULL;
-    SeqStep               *sequence1               = NULL;
-    TrackParameters       *trackParamsArray1       = NULL;
-    SubSynthParameters    *subsynthParamsArray     = NULL;
-    Sequencer             *seq1                    = NULL;
-    u32                   *audioBufferFM           = NULL;
-    Envelope              *fm_env                  = NULL;
-    FMOperator            *fm_op                   = NULL;
-    FMSynth               *fm_synth                = NULL;
-    SeqStep               *sequenceFM              = NULL;
-    TrackParameters       *trackParamsArrayFM      = NULL;
-    FMSynthParameters     *fmSynthParamsArray      = NULL;
-    Sequencer             *seqFM                   = NULL;
-    u32                   *audioBuffer2            = NULL;
-    Envelope              *env1                    = NULL;
-    Sampler               *sampler                 = NULL;
-    SeqStep               *sequence2               = NULL;
-    TrackParameters       *trackParamsArray2       = NULL;
-    OpusSamplerParameters *opusSamplerParamsArray  = NULL;
-    Sequencer             *seq2                    = NULL;
-    u32                   *audioBuffer3            = NULL;
-    Envelope              *env2                    = NULL;
-    Sampler               *sampler2                = NULL;
-    SeqStep               *sequence3               = NULL;
-    TrackParameters       *trackParamsArray3       = NULL;
-    OpusSamplerParameters *opusSamplerParamsArray2 = NULL;
-    Sequencer             *seq3                    = NULL;
-
-    u32                  *audioBuffer4          = NULL;
-    Envelope             *env3                  = NULL;
-    NoiseSynth           *noise_synth           = NULL;
-    SeqStep              *sequence4             = NULL;
-    TrackParameters      *trackParamsArray4     = NULL;
-    NoiseSynthParameters *noiseSynthParamsArray = NULL;
-    Sequencer            *seq4                  = NULL;
+    u32        *audioBuffer1  = NULL;
+    SubSynth   *subsynth      = NULL;
+    u32        *audioBufferFM = NULL;
+    FMSynth    *fm_synth      = NULL;
+    u32        *audioBuffer2  = NULL;
+    Sampler    *sampler       = NULL;
+    u32        *audioBuffer3  = NULL;
+    Sampler    *sampler2      = NULL;
+    u32        *audioBuffer4  = NULL;
+    NoiseSynth *noise_synth   = NULL;
+
+    MixBus *mix_bus         = NULL;
+    u32    *mixBusBuffer    = NULL;
+    float  *mixBusAccBuffer = NULL;
+    u32    *silenceBuffer   = NULL;
+
+    // In mix bus mode tracks own no NDSP channel and every instrument runs at the bus rate
+    const float synth_rate   = USE_MIX_BUS ? MIXBUS_SAMPLERATE : SAMPLERATE;
+    const u32   synth_buffer = USE_MIX_BUS ? MIXBUS_SAMPLESPERBUF : SAMPLESPERBUF;
 
     s32    main_prio;
     Result rc = svcGetThreadPriority(&main_prio, CUR_THREAD_HANDLE);
@@ -140,12 +132,12 @@ int main(int argc, char **argv) {
 
     // CLOCK //////////////////////////
     MusicalTime mt        = { .bar = 0, .beat = 0, .deltaStep = 0, .steps = 0, .beats_per_bar = 4 };
-    Clock       cl        = { .bpm              = 120.0f,
-                              .last_tick_time   = 0,
-                              .time_accumulator = 0,
-                              .ticks_per_step   = 0,
-                              .status           = STOPPED,
-                              .barBeats         = &mt };
+    Clock       cl        = { .bpm             = 120.0f,
+                              .samplerate      = SAMPLERATE,
+                              .frames_per_step = 0,
+                              .phase           = 0,
+                              .status          = STOPPED,
+                              .barBeats        = &mt };
     Clock      *app_clock = &cl;
 
     SessionContext ctx = { .session                       = &session,
@@ -171,389 +163,178 @@ int main(int argc, char **argv) {
                            .previous_screen_focus = &previous_screen_focus,
 
                            .tracks                     = tracks,
-                           .clock                      = app_clock,
                            .event_queue                = &g_event_queue,
                            .sample_bank                = &g_sample_bank,
                            .sample_browser             = &g_sample_browser,
-                           .editing_step_params        = &g_editing_step_params,
-                           .editing_subsynth_params    = &g_editing_subsynth_params,
-                           .editing_sampler_params     = &g_editing_sampler_params,
-                           .editing_fm_synth_params    = &g_editing_fm_synth_params,
-                           .editing_noise_synth_params = &g_editing_noise_synth_params,
-                           .clock_lock                 = &clock_lock,
+                           .editing_step               = &g_editing_step,
+                           .editing_step_params        = &g_editing_step.track,
+                           .editing_subsynth_params    = &g_editing_step.instrument.subsynth_params,
+                           .editing_sampler_params     = &g_editing_step.instrument.sampler_params,
+                           .editing_fm_synth_params    = &g_editing_step.instrument.fm_synth_params,
+                           .editing_noise_synth_params =
+                               &g_editing_step.instrument.noise_synth_params,
 
                            .HOLD_DELAY_INITIAL = HOLD_DELAY_INITIAL,
                            .HOLD_DELAY_REPEAT  = HOLD_DELAY_REPEAT };
     setBpm(app_clock, 127.0f);
 
-    // TRACK 0 (SUB_SYNTH) ///////////////////////////////////////////
-    audioBuffer1 = (u32 *) linearAlloc(2 * SAMPLESPERBUF * BYTESPERSAMPLE * NCHANNELS);
-    if (!audioBuffer1) {
+    if (!linearRegionInit(&g_dsp_buffers, LINEAR_TAG_BUFFERS, DSP_BUFFER_REGION_BYTES)) {
         ret = 1;
         goto cleanup;
     }
-    initializeTrack(&tracks[0], 0, SUB_SYNTH, SAMPLERATE, SAMPLESPERBUF, audioBuffer1);
 
-    osc = (PolyBLEPOscillator *) linearAlloc(sizeof(PolyBLEPOscillator));
-    if (!osc) {
-        ret = 1;
-        goto cleanup;
-    }
-    *osc = (PolyBLEPOscillator) { .frequency   = 220.0f,
-                                  .samplerate  = SAMPLERATE,
-                                  .waveform    = SQUARE,
-                                  .phase       = 0.,
-                                  .pulse_width = 0.5f,
-                                  .phase_inc   = 220.0f * M_TWOPI / SAMPLERATE };
-
-    env = (Envelope *) linearAlloc(sizeof(Envelope));
-    if (!env) {
-        ret = 1;
-        goto cleanup;
-    }
-    *env = defaultEnvelopeStruct(SAMPLERATE);
-    updateEnvelope(env, 20, 200, 0.6, 50, 300);
+    // Each track's instrument, sequence and step parameters come from its arena, with the
+    // parameters already at their defaults. Only the instrument state is set up here.
 
-    subsynth = (SubSynth *) linearAlloc(sizeof(SubSynth));
-    if (!subsynth) {
-        ret = 1;
-        goto cleanup;
+    // TRACK 0 (SUB_SYNTH) ///////////////////////////////////////////
+    if (!USE_MIX_BUS) {
+        audioBuffer1 = linearRegionAlloc(&g_dsp_buffers, SYNTH_BUFFER_BYTES, DSP_BUFFER_ALIGN);
+        if (!audioBuffer1) {
+            ret = 1;
+            goto cleanup;
+        }
     }
-    *subsynth                 = (SubSynth) { .osc = osc, .env = env };
-    tracks[0].instrument_data = subsynth;
+    initializeTrack(&tracks[0], 0, SUB_SYNTH, synth_rate, synth_buffer, audioBuffer1);
 
-    sequence1 = (SeqStep *) linearAlloc(16 * sizeof(SeqStep));
-    if (!sequence1) {
-        ret = 1;
-        goto cleanup;
-    }
-    trackParamsArray1 = (TrackParameters *) linearAlloc(16 * sizeof(TrackParameters));
-    if (!trackParamsArray1) {
-        ret = 1;
-        goto cleanup;
-    }
-    subsynthParamsArray = (SubSynthParameters *) linearAlloc(16 * sizeof(SubSynthParameters));
-    if (!subsynthParamsArray) {
-        ret = 1;
-        goto cleanup;
-    }
-    for (int i = 0; i < 16; i++) {
-        subsynthParamsArray[i] = defaultSubSynthParameters();
-        trackParamsArray1[i]   = defaultTrackParameters(0, &subsynthParamsArray[i]);
-        sequence1[i]           = (SeqStep) { .active = false };
-        sequence1[i].data      = &trackParamsArray1[i];
-    }
-    seq1 = (Sequencer *) linearAlloc(sizeof(Sequencer));
-    if (!seq1) {
+    subsynth = (SubSynth *) tracks[0].instrument_data;
+    if (!subsynth) {
         ret = 1;
         goto cleanup;
     }
-    *seq1               = (Sequencer) { .cur_step                = 0,
-                                        .steps                   = sequence1,
-                                        .n_beats                 = 4,
-                                        .steps_per_beat          = 4,
-                                        .instrument_params_array = subsynthParamsArray,
-                                        .track_params_array      = trackParamsArray1 };
-    tracks[0].sequencer = seq1;
+    *subsynth->osc = (PolyBLEPOscillator) { .frequency   = 220.0f,
+                                            .samplerate  = synth_rate,
+                                            .waveform    = SQUARE,
+                                            .phase       = 0,
+                                            .pulse_width = 0.5f };
+    setOscFrequency(subsynth->osc, subsynth->osc->frequency);
+    *subsynth->env = defaultEnvelopeStruct(synth_rate);
+    updateEnvelope(subsynth->env, 20, 200, 0.6, 50, 300);
 
     // TRACK 1 (FM_SYNTH) ///////////////////////////////////////////
-    audioBufferFM = (u32 *) linearAlloc(2 * SAMPLESPERBUF * BYTESPERSAMPLE * NCHANNELS);
-    if (!audioBufferFM) {
-        ret = 1;
-        goto cleanup;
-    }
-    initializeTrack(&tracks[1], 1, FM_SYNTH, SAMPLERATE, SAMPLESPERBUF, audioBufferFM);
-
-    fm_op = (FMOperator *) linearAlloc(sizeof(FMOperator));
-    if (!fm_op) {
-        ret = 1;
-        goto cleanup;
-    }
-    fm_op->carrier = (PolyBLEPOscillator *) linearAlloc(sizeof(PolyBLEPOscillator));
-    if (!fm_op->carrier) {
-        ret = 1;
-        goto cleanup;
-    }
-    fm_op->modulator = (PolyBLEPOscillator *) linearAlloc(sizeof(PolyBLEPOscillator));
-    if (!fm_op->modulator) {
-        ret = 1;
-        goto cleanup;
-    }
-    fm_op->mod_envelope = (Envelope *) linearAlloc(sizeof(Envelope));
-    if (!fm_op->mod_envelope) {
-        ret = 1;
-        goto cleanup;
-    }
-    fm_op->mod_index      = 1.0f;
-    fm_op->mod_depth      = 100.0f;
-    fm_op->base_frequency = 220.0f;
-
-    *fm_op->carrier = (PolyBLEPOscillator) { .frequency   = 220.0f,
-                                             .samplerate  = SAMPLERATE,
-                                             .waveform    = SINE,
-                                             .phase       = 0.0f,
-                                             .pulse_width = 0.5f };
-    setOscFrequency(fm_op->carrier, fm_op->carrier->frequency);
-
-    *fm_op->modulator = (PolyBLEPOscillator) { .frequency   = 0.0f,
-                                               .samplerate  = SAMPLERATE,
-                                               .waveform    = SINE,
-                                               .phase       = 0.0f,
-                                               .pulse_width = 0.5f };
-    setOscFrequency(fm_op->modulator, fm_op->modulator->frequency);
-
-    *fm_op->mod_envelope = defaultEnvelopeStruct(SAMPLERATE);
-    updateEnvelope(fm_op->mod_envelope, 20, 200, 0.6, 50, 300);
-
-    fm_env = (Envelope *) linearAlloc(sizeof(Envelope));
-    if (!fm_env) {
-        ret = 1;
-        goto cleanup;
+    if (!USE_MIX_BUS) {
+        audioBufferFM = linearRegionAlloc(&g_dsp_buffers, SYNTH_BUFFER_BYTES, DSP_BUFFER_ALIGN);
+        if (!audioBufferFM) {
+            ret = 1;
+            goto cleanup;
+        }
     }
-    *fm_env = defaultEnvelopeStruct(SAMPLERATE);
-    updateEnvelope(fm_env, 20, 200, 0.6, 50, 300);
+    initializeTrack(&tracks[1], 1, FM_SYNTH, synth_rate, synth_buffer, audioBufferFM);
 
-    fm_synth = (FMSynth *) linearAlloc(sizeof(FMSynth));
+    fm_synth = (FMSynth *) tracks[1].instrument_data;
     if (!fm_synth) {
         ret = 1;
         goto cleanup;
     }
-    *fm_synth                 = (FMSynth) { .carrierEnv = fm_env, .fm_op = fm_op };
-    tracks[1].instrument_data = fm_synth;
-
-    sequenceFM = (SeqStep *) linearAlloc(16 * sizeof(SeqStep));
-    if (!sequenceFM) {
-        ret = 1;
-        goto cleanup;
+    initFMSynth(fm_synth, synth_rate);
+    FMSetFrequency(fm_synth, 220.0f);
+    for (int op = 0; op < FM_OPERATORS; op++) {
+        updateEnvelope(&fm_synth->ops[op].env, 20, 200, 0.6, 50, 300);
     }
-    trackParamsArrayFM = (TrackParameters *) linearAlloc(16 * sizeof(TrackParameters));
-    if (!trackParamsArrayFM) {
-        ret = 1;
-        goto cleanup;
-    }
-    fmSynthParamsArray = (FMSynthParameters *) linearAlloc(16 * sizeof(FMSynthParameters));
-    if (!fmSynthParamsArray) {
-        ret = 1;
-        goto cleanup;
-    }
-    for (int i = 0; i < 16; i++) {
-        fmSynthParamsArray[i] = defaultFMSynthParameters();
-        trackParamsArrayFM[i] = defaultTrackParameters(1, &fmSynthParamsArray[i]);
-        sequenceFM[i]         = (SeqStep) { .active = false };
-        sequenceFM[i].data    = &trackParamsArrayFM[i];
-    }
-    seqFM = (Sequencer *) linearAlloc(sizeof(Sequencer));
-    if (!seqFM) {
-        ret = 1;
-        goto cleanup;
-    }
-    *seqFM              = (Sequencer) { .cur_step                = 0,
-                                        .steps                   = sequenceFM,
-                                        .n_beats                 = 4,
-                                        .steps_per_beat          = 4,
-                                        .instrument_params_array = fmSynthParamsArray,
-                                        .track_params_array      = trackParamsArrayFM };
-    tracks[1].sequencer = seqFM;
 
     // TRACK 2 (OPUS_SAMPLER) ///////////////////////////////////////////
-    audioBuffer2 = (u32 *) linearAlloc(2 * OPUSSAMPLESPERFBUF * BYTESPERSAMPLE * NCHANNELS);
-    if (!audioBuffer2) {
-        ret = 1;
-        goto cleanup;
+    if (!USE_MIX_BUS) {
+        audioBuffer2 = linearRegionAlloc(&g_dsp_buffers, SAMPLER_BUFFER_BYTES, DSP_BUFFER_ALIGN);
+        if (!audioBuffer2) {
+            ret = 1;
+            goto cleanup;
+        }
     }
     initializeTrack(&tracks[2], 2, OPUS_SAMPLER, OPUSSAMPLERATE, OPUSSAMPLESPERFBUF, audioBuffer2);
 
-    env1 = (Envelope *) linearAlloc(sizeof(Envelope));
-    if (!env1) {
-        ret = 1;
-        goto cleanup;
-    }
-    *env1 = defaultEnvelopeStruct(OPUSSAMPLERATE);
-    updateEnvelope(env1, 100, 300, 0.9, 200, 2000);
-
-    sampler = (Sampler *) linearAlloc(sizeof(Sampler));
+    sampler = (Sampler *) tracks[2].instrument_data;
     if (!sampler) {
         ret = 1;
         goto cleanup;
     }
+    *sampler->env = defaultEnvelopeStruct(OPUSSAMPLERATE);
+    updateEnvelope(sampler->env, 100, 300, 0.9, 200, 2000);
     *sampler = (Sampler) { .sample          = SampleBankGetSample(&g_sample_bank, 0),
                            .start_position  = 0,
                            .playback_mode   = ONE_SHOT,
                            .samples_per_buf = OPUSSAMPLESPERFBUF,
                            .samplerate      = OPUSSAMPLERATE,
-                           .env             = env1,
+                           .env             = sampler->env,
                            .current_frame   = 0,
                            .finished        = true };
     sample_inc_ref(sampler->sample);
-    tracks[2].instrument_data = sampler;
-
-    sequence2 = (SeqStep *) linearAlloc(16 * sizeof(SeqStep));
-    if (!sequence2) {
-        ret = 1;
-        goto cleanup;
-    }
-    trackParamsArray2 = (TrackParameters *) linearAlloc(16 * sizeof(TrackParameters));
-    if (!trackParamsArray2) {
-        ret = 1;
-        goto cleanup;
-    }
-    opusSamplerParamsArray =
-        (OpusSamplerParameters *) linearAlloc(16 * sizeof(OpusSamplerParameters));
-    if (!opusSamplerParamsArray) {
-        ret = 1;
-        goto cleanup;
-    }
-    for (int i = 0; i < 16; i++) {
-        opusSamplerParamsArray[i]              = defaultOpusSamplerParameters();
-        opusSamplerParamsArray[i].sample_index = 0;
-        trackParamsArray2[i] = defaultTrackParameters(2, &opusSamplerParamsArray[i]);
-        sequence2[i]         = (SeqStep) { .active = false };
-        sequence2[i].data    = &trackParamsArray2[i];
-    }
-    seq2 = (Sequencer *) linearAlloc(sizeof(Sequencer));
-    if (!seq2) {
-        ret = 1;
-        goto cleanup;
-    }
-    *seq2               = (Sequencer) { .cur_step                = 0,
-                                        .steps                   = sequence2,
-                                        .n_beats                 = 4,
-                                        .steps_per_beat          = 4,
-                                        .instrument_params_array = opusSamplerParamsArray,
-                                        .track_params_array      = trackParamsArray2 };
-    tracks[2].sequencer = seq2;
 
     // TRACK 3 (OPUS_SAMPLER) ///////////////////////////////////////////
-    audioBuffer3 = (u32 *) linearAlloc(2 * OPUSSAMPLESPERFBUF * BYTESPERSAMPLE * NCHANNELS);
-    if (!audioBuffer3) {
-        ret = 1;
-        goto cleanup;
+    if (!USE_MIX_BUS) {
+        audioBuffer3 = linearRegionAlloc(&g_dsp_buffers, SAMPLER_BUFFER_BYTES, DSP_BUFFER_ALIGN);
+        if (!audioBuffer3) {
+            ret = 1;
+            goto cleanup;
+        }
     }
     initializeTrack(&tracks[3], 3, OPUS_SAMPLER, OPUSSAMPLERATE, OPUSSAMPLESPERFBUF, audioBuffer3);
 
-    env2 = (Envelope *) linearAlloc(sizeof(Envelope));
-    if (!env2) {
-        ret = 1;
-        goto cleanup;
-    }
-    *env2 = defaultEnvelopeStruct(OPUSSAMPLERATE);
-    updateEnvelope(env2, 100, 300, 0.9, 200, 2000);
-
-    sampler2 = (Sampler *) linearAlloc(sizeof(Sampler));
+    sampler2 = (Sampler *) tracks[3].instrument_data;
     if (!sampler2) {
         ret = 1;
         goto cleanup;
     }
+    *sampler2->env = defaultEnvelopeStruct(OPUSSAMPLERATE);
+    updateEnvelope(sampler2->env, 100, 300, 0.9, 200, 2000);
     *sampler2 = (Sampler) { .sample          = SampleBankGetSample(&g_sample_bank, 0),
                             .start_position  = 0,
                             .playback_mode   = ONE_SHOT,
                             .samples_per_buf = OPUSSAMPLESPERFBUF,
                             .samplerate      = OPUSSAMPLERATE,
-                            .env             = env2,
+                            .env             = sampler2->env,
                             .current_frame   = 0,
                             .finished        = true };
     sample_inc_ref(sampler2->sample);
-    tracks[3].instrument_data = sampler2;
-
-    sequence3 = (SeqStep *) linearAlloc(16 * sizeof(SeqStep));
-    if (!sequence3) {
-        ret = 1;
-        goto cleanup;
-    }
-    trackParamsArray3 = (TrackParameters *) linearAlloc(16 * sizeof(TrackParameters));
-    if (!trackParamsArray3) {
-        ret = 1;
-        goto cleanup;
-    }
-    opusSamplerParamsArray2 =
-        (OpusSamplerParameters *) linearAlloc(16 * sizeof(OpusSamplerParameters));
-    if (!opusSamplerParamsArray2) {
-        ret = 1;
-        goto cleanup;
-    }
-    for (int i = 0; i < 16; i++) {
-        opusSamplerParamsArray2[i]              = defaultOpusSamplerParameters();
-        opusSamplerParamsArray2[i].sample_index = 0;
-        trackParamsArray3[i] = defaultTrackParameters(3, &opusSamplerParamsArray2[i]);
-        sequence3[i]         = (SeqStep) { .active = false };
-        sequence3[i].data    = &trackParamsArray3[i];
-    }
-    seq3 = (Sequencer *) linearAlloc(sizeof(Sequencer));
-    if (!seq3) {
-        ret = 1;
-        goto cleanup;
-    }
-    *seq3               = (Sequencer) { .cur_step                = 0,
-                                        .steps                   = sequence3,
-                                        .n_beats                 = 4,
-                                        .steps_per_beat          = 4,
-                                        .instrument_params_array = opusSamplerParamsArray2,
-                                        .track_params_array      = trackParamsArray3 };
-    tracks[3].sequencer = seq3;
 
     // TRACK 4 (NOISE_SYNTH) ///////////////////////////////////////////
-    audioBuffer4 = (u32 *) linearAlloc(2 * SAMPLESPERBUF * BYTESPERSAMPLE * NCHANNELS);
-    if (!audioBuffer4) {
-        ret = 1;
-        goto cleanup;
-    }
-    initializeTrack(&tracks[4], 4, NOISE_SYNTH, SAMPLERATE, SAMPLESPERBUF, audioBuffer4);
-
-    env3 = (Envelope *) linearAlloc(sizeof(Envelope));
-    if (!env3) {
-        ret = 1;
-        goto cleanup;
+    if (!USE_MIX_BUS) {
+        audioBuffer4 = linearRegionAlloc(&g_dsp_buffers, SYNTH_BUFFER_BYTES, DSP_BUFFER_ALIGN);
+        if (!audioBuffer4) {
+            ret = 1;
+            goto cleanup;
+        }
     }
-    *env3 = defaultEnvelopeStruct(SAMPLERATE);
-    updateEnvelope(env3, 1, 50, 1.0, 50, 100);
+    initializeTrack(&tracks[4], 4, NOISE_SYNTH, synth_rate, synth_buffer, audioBuffer4);
 
-    noise_synth = (NoiseSynth *) linearAlloc(sizeof(NoiseSynth));
+    noise_synth = (NoiseSynth *) tracks[4].instrument_data;
     if (!noise_synth) {
         ret = 1;
         goto cleanup;
     }
-    *noise_synth = (NoiseSynth) { .env = env3, .lfsr_register = 0x4000 }; // Initial seed
-    tracks[4].instrument_data = noise_synth;
+    *noise_synth->env = defaultEnvelopeStruct(synth_rate);
+    updateEnvelope(noise_synth->env, 1, 50, 1.0, 50, 100);
+    *noise_synth = (NoiseSynth) { .env = noise_synth->env, .lfsr_register = 0x4000 }; // seed
 
-    sequence4 = (SeqStep *) linearAlloc(16 * sizeof(SeqStep));
-    if (!sequence4) {
-        ret = 1;
-        goto cleanup;
-    }
-    trackParamsArray4 = (TrackParameters *) linearAlloc(16 * sizeof(TrackParameters));
-    if (!trackParamsArray4) {
-        ret = 1;
-        goto cleanup;
-    }
-    noiseSynthParamsArray = (NoiseSynthParameters *) linearAlloc(16 * sizeof(NoiseSynthParameters));
-    if (!noiseSynthParamsArray) {
-        ret = 1;
-        goto cleanup;
-    }
-    for (int i = 0; i < 16; i++) {
-        noiseSynthParamsArray[i] = defaultNoiseSynthParameters();
-        trackParamsArray4[i]     = defaultTrackParameters(4, &noiseSynthParamsArray[i]);
-        sequence4[i]             = (SeqStep) { .active = false };
-        sequence4[i].data        = &trackParamsArray4[i];
+    // MIX BUS ///////////////////////////////////////////
+    if (USE_MIX_BUS) {
+        mixBusBuffer = linearRegionAlloc(&g_dsp_buffers, MIXBUS_BUFFER_BYTES, DSP_BUFFER_ALIGN);
+        if (!mixBusBuffer) {
+            ret = 1;
+            goto cleanup;
+        }
+        mixBusAccBuffer = (float *) malloc(MIXBUS_SAMPLESPERBUF * NCHANNELS * sizeof(float));
+        if (!mixBusAccBuffer) {
+            ret = 1;
+            goto cleanup;
+        }
+        initializeMixBus(&g_mix_bus, MIXBUS_CHANNEL, MIXBUS_SAMPLERATE, MIXBUS_SAMPLESPERBUF,
+                         mixBusBuffer, mixBusAccBuffer);
+        mix_bus = &g_mix_bus;
     }
-    seq4 = (Sequencer *) linearAlloc(sizeof(Sequencer));
-    if (!seq4) {
+
+    // SILENCE //////////////////////////////////////////
+    // Zeroed and flushed once, then queued read-only by every track with nothing to play
+    silenceBuffer = linearRegionAlloc(&g_dsp_buffers, SILENCE_BUFFER_BYTES, DSP_BUFFER_ALIGN);
+    if (!silenceBuffer) {
         ret = 1;
         goto cleanup;
     }
-    *seq4               = (Sequencer) { .cur_step                = 0,
-                                        .steps                   = sequence4,
-                                        .n_beats                 = 4,
-                                        .steps_per_beat          = 4,
-                                        .instrument_params_array = noiseSynthParamsArray,
-                                        .track_params_array      = trackParamsArray4 };
-    tracks[4].sequencer = seq4;
-
-    LightLock_Init(&clock_lock);
+    fillBufferWithZeros(silenceBuffer, SILENCE_BUFFER_BYTES);
+    DSP_FlushDataCache(silenceBuffer, SILENCE_BUFFER_BYTES);
+
     eventQueueInit(&g_event_queue);
 
-    if (R_FAILED(audioThreadInit(tracks, &g_event_queue, &g_sample_bank, app_clock, &clock_lock,
-                                 &should_exit, main_prio))) {
+    if (R_FAILED(audioThreadInit(tracks, &g_event_queue, &g_sample_bank, mix_bus, silenceBuffer,
+                                 app_clock, &should_exit, main_prio))) {
         ret = 1;
         goto cleanup;
     }
@@ -569,6 +350,9 @@ int main(int argc, char **argv) {
     while (aptMainLoop()) {
         hidScanInput();
         sample_cleanup_process();
+        for (int i = 0; i < N_TRACKS; i++) {
+            sequencerReclaim(tracks[i].sequencer);
+        }
 
         u64 now   = svcGetSystemTick();
         u32 kDown = hidKeysDown();
@@ -596,13 +380,17 @@ int main(int argc, char **argv) {
             drawQuitMenu(quitMenuOptions, numQuitMenuOptions, selected_quit_option);
             break;
         case VIEW_STEP_SETTINGS_EDIT:
-            drawStepSettingsEditView(&tracks[selected_row - 1], &g_editing_step_params,
+            drawStepSettingsEditView(&tracks[selected_row - 1], &g_editing_step,
                                      selected_step_option, selected_adsr_option, &g_sample_bank);
             break;
         default:
             break;
         }
 
+        if (session.show_audio_stats) {
+            drawAudioStatsOverlay();
+        }
+
         C2D_TargetClear(bottomScreen, CLR_BLACK);
         C2D_SceneBegin(bottomScreen);
 
@@ -641,12 +429,18 @@ cleanup:
     for (int i = 0; i < N_TRACKS; i++) {
         ndspChnWaveBufClear(tracks[i].chan_id);
     }
+    if (mix_bus) {
+        ndspChnWaveBufClear(mix_bus->chan_id);
+    }
     ndspExit();
 
+    MixBus_deinit(mix_bus);
+
     sample_cleanup_process();
 
-    cleanupTracks(tracks, N_TRACKS);  // Calls sample_dec_ref_main_thread
-    SampleBankDeinit(&g_sample_bank); // ALSO calls sample_dec_ref_main_thread
+    cleanupTracks(tracks, N_TRACKS);     // Calls sample_dec_ref_main_thread
+    linearRegionDestroy(&g_dsp_buffers); // Every NDSP buffer, now that NDSP is gone
+    SampleBankDeinit(&g_sample_bank);    // ALSO calls sample_dec_ref_main_thread
 
     sample_cleanup_process();
 
@@ -0,0 +1,100 @@
+#ifdef TESTING
+#include "../tests/mock_3ds.h"
+#else
+#include <3ds/allocator/linear.h>
+#include <3ds/ndsp/channel.h>
+#include <3ds/ndsp/ndsp.h>
+#include <3ds/services/dsp.h>
+#include <3ds/types.h>
+#endif
+
+#include "mix_bus.h"
+#include "audio_simd.h"
+#include "audio_utils.h"
+#include "engine_constants.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+void initializeMixBus(MixBus *bus, int chan_id, float rate, u32 num_samples, u32 *audio_buffer,
+                      float *accum_buffer) {
+    bus->chan_id         = chan_id;
+    bus->audioBuffer     = audio_buffer;
+    bus->accumBuffer     = accum_buffer;
+    bus->samples_per_buf = num_samples;
+    bus->rate            = rate;
+    bus->n_wavebufs      = 2;
+    bus->fillBlock       = 0;
+
+    ndspChnReset(bus->chan_id);
+    ndspChnSetInterp(bus->chan_id, NDSP_INTERP_LINEAR);
+    ndspChnSetRate(bus->chan_id, rate);
+    ndspChnSetFormat(bus->chan_id, NDSP_FORMAT_STEREO_PCM16);
+
+    // Pan and volume are applied per track while mixing, the bus itself is unity gain
+    memset(bus->mix, 0, sizeof(bus->mix));
+    bus->mix[0] = 1.0;
+    bus->mix[1] = 1.0;
+    ndspChnSetMix(bus->chan_id, bus->mix);
+
+    queueWaveBufs(bus->chan_id, bus->waveBuf, bus->audioBuffer, num_samples, bus->n_wavebufs);
+}
+
+void mixBusSetLatency(MixBus *bus, LatencyProfileId profile) {
+    bus->samples_per_buf = latencyBlockFrames(profile, bus->rate);
+    bus->n_wavebufs      = latency_profiles[profile].n_wavebufs;
+    bus->fillBlock       = 0;
+
+    ndspChnWaveBufClear(bus->chan_id);
+    queueWaveBufs(bus->chan_id, bus->waveBuf, bus->audioBuffer, bus->samples_per_buf,
+                  bus->n_wavebufs);
+}
+
+bool mixBusReady(MixBus *bus) {
+    return bus && bus->waveBuf[bus->fillBlock].status == NDSP_WBUF_DONE;
+}
+
+float *mixBusBegin(MixBus *bus) {
+    memset(bus->accumBuffer, 0, bus->samples_per_buf * NCHANNELS * sizeof(float));
+    return bus->accumBuffer;
+}
+
+void mixBusSubmit(MixBus *bus) {
+    ndspWaveBuf *waveBuf = &bus->waveBuf[bus->fillBlock];
+    size_t       n       = bus->samples_per_buf * NCHANNELS;
+
+    // May still point at the silence buffer from an earlier block
+    waveBuf->data_vaddr = &bus->audioBuffer[bus->fillBlock * bus->samples_per_buf];
+
+    // The only float -> int16 conversion of the block, saturating on the summed signal
+    for (size_t i = 0; i < n; i++) {
+        waveBuf->data_pcm16[i] = floatToInt16Sat(bus->accumBuffer[i]);
+    }
+
+    waveBuf->nsamples = bus->samples_per_buf;
+    DSP_FlushDataCache(waveBuf->data_pcm16, n * sizeof(int16_t));
+    ndspChnWaveBufAdd(bus->chan_id, waveBuf);
+
+    bus->fillBlock = (bus->fillBlock + 1) % bus->n_wavebufs;
+}
+
+void mixBusSubmitSilence(MixBus *bus, const u32 *silence) {
+    ndspWaveBuf *waveBuf = &bus->waveBuf[bus->fillBlock];
+
+    waveBuf->data_vaddr = silence;
+    waveBuf->nsamples   = bus->samples_per_buf;
+    ndspChnWaveBufAdd(bus->chan_id, waveBuf);
+
+    bus->fillBlock = (bus->fillBlock + 1) % bus->n_wavebufs;
+}
+
+void MixBus_deinit(MixBus *bus) {
+    if (!bus) {
+        return;
+    }
+    bus->audioBuffer = NULL; // the caller's, like a track's NDSP buffer
+    if (bus->accumBuffer) {
+        free(bus->accumBuffer);
+        bus->accumBuffer = NULL;
+    }
+}
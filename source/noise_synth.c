@@ -1,34 +1,167 @@
 #include "noise_synth.h"
+#include "audio_simd.h"
 #include "audio_utils.h"
 #include "engine_constants.h"
+#ifndef TESTING
 #include <3ds/services/dsp.h>
+#endif
 #include <string.h>
 
-void fillNoiseSynthAudiobuffer(ndspWaveBuf *waveBuf, size_t size, NoiseSynth *noiseSynth) {
-    if (!noiseSynth || !noiseSynth->env) {
-        memset(waveBuf->data_pcm16, 0, size * NCHANNELS * sizeof(int16_t));
-        waveBuf->nsamples = size;
-        DSP_FlushDataCache(waveBuf->data_pcm16, size * NCHANNELS * sizeof(int16_t));
+const char *noise_mode_names[] = { "15-bit", "7-bit" };
+
+// Register width of each mode. Both use the taps of bits 0 and 1, feeding the top bit.
+static const u8 noise_lfsr_width[NOISE_MODE_COUNT] = { 15, 7 };
+
+void setNoiseMode(NoiseSynth *noiseSynth, NoiseMode mode) {
+    if (!noiseSynth || mode < 0 || mode >= NOISE_MODE_COUNT || mode == noiseSynth->mode) {
+        return;
+    }
+    // Outputs already generated belong to the old period
+    noiseSynth->mode      = mode;
+    noiseSynth->bits_left = 0;
+}
+
+void setNoiseRateDiv(NoiseSynth *noiseSynth, int rate_div) {
+    if (!noiseSynth) {
         return;
     }
+    if (rate_div < 1) {
+        rate_div = 1;
+    } else if (rate_div > NOISE_MAX_RATE_DIV) {
+        rate_div = NOISE_MAX_RATE_DIV;
+    }
+    noiseSynth->rate_div = (u16) rate_div;
+    if (noiseSynth->hold > rate_div) {
+        noiseSynth->hold = (u16) rate_div;
+    }
+}
+
+// The register of the current mode, reseeded when it is all zeros and would stay silent (the
+// 7-bit mode only sees the bottom of a seed such as 0x4000)
+static u32 lfsrRegister(NoiseSynth *noiseSynth, u32 width) {
+    u32 mask = (1u << width) - 1;
+    u32 r    = noiseSynth->lfsr_register & mask;
+    return r ? r : mask;
+}
+
+u8 stepNoiseLfsr(NoiseSynth *noiseSynth) {
+    u32 width = noise_lfsr_width[noiseSynth->mode];
+    u32 r     = lfsrRegister(noiseSynth, width);
+    u32 bit   = (r ^ (r >> 1)) & 1;
+    r         = (r >> 1) | (bit << (width - 1));
+
+    noiseSynth->lfsr_register = (u16) r;
+    return r & 1;
+}
 
-    for (size_t i = 0; i < size; i++) {
-        // 15-bit LFSR for GBA-style noise
-        unsigned int bit =
-            ((noiseSynth->lfsr_register >> 0) ^ (noiseSynth->lfsr_register >> 1)) & 1;
-        noiseSynth->lfsr_register = (noiseSynth->lfsr_register >> 1) | (bit << 14);
+// Advances the register width - 1 shifts at once. Bit k of r ^ (r >> 1) is the feedback of shift
+// k for every k below width - 1, and the output of each shift is the bit that lands in bit 0,
+// which is just r >> 1.
+static void refillNoiseBits(NoiseSynth *noiseSynth) {
+    u32 width = noise_lfsr_width[noiseSynth->mode];
+    u32 steps = width - 1;
+    u32 mask  = (1u << steps) - 1;
+    u32 r     = lfsrRegister(noiseSynth, width);
 
-        // Use the lowest bit as the audio output
-        float sample = (noiseSynth->lfsr_register & 1) ? 1.0f : -1.0f;
+    noiseSynth->bits          = (r >> 1) & mask;
+    noiseSynth->bits_left     = (u8) steps;
+    noiseSynth->lfsr_register = (u16) ((r >> steps) | (((r ^ (r >> 1)) & mask) << 1));
+}
 
-        sample *= nextEnvelopeSample(noiseSynth->env);
+// +-amp by a bit, without a branch: same rounding as floatToInt16Sat on +-env, so the output
+// matches the float path this replaced
+static inline s16 signedAmplitude(float env, u32 bit) {
+    s32 amp  = (s32) (env * 32768.0f);
+    s32 flip = (s32) bit - 1; // 0 keeps the sign, -1 negates
+    return (s16) ssat16((amp ^ flip) - flip);
+}
 
-        int16_t sample_i16 = floatToInt16(sample);
+// Renders n <= RENDER_CHUNK mono samples into out. Undivided, each word of LFSR outputs covers
+// that many samples; divided, the LFSR only runs once per held value.
+static void renderNoiseSynthChunk(NoiseSynth *noiseSynth, s16 *out, size_t n) {
+    float env[RENDER_CHUNK];
+    renderEnvelopeBlock(noiseSynth->env, env, n);
 
-        waveBuf->data_pcm16[i * NCHANNELS]     = sample_i16;
-        waveBuf->data_pcm16[i * NCHANNELS + 1] = sample_i16; // Mono
+    u32    rate_div = noiseSynth->rate_div > 1 ? noiseSynth->rate_div : 1;
+    size_t i        = 0;
+    if (rate_div == 1 && noiseSynth->hold == 0) {
+        while (i < n) {
+            if (noiseSynth->bits_left == 0) {
+                refillNoiseBits(noiseSynth);
+            }
+            size_t run  = noiseSynth->bits_left < n - i ? noiseSynth->bits_left : n - i;
+            u32    bits = noiseSynth->bits;
+            for (size_t k = 0; k < run; k++) {
+                out[i + k] = signedAmplitude(env[i + k], (bits >> k) & 1);
+            }
+            noiseSynth->bits      = bits >> run;
+            noiseSynth->bits_left = (u8) (noiseSynth->bits_left - run);
+            i += run;
+        }
+        return;
     }
 
+    while (i < n) {
+        if (noiseSynth->hold == 0) {
+            if (noiseSynth->bits_left == 0) {
+                refillNoiseBits(noiseSynth);
+            }
+            noiseSynth->held_bit = noiseSynth->bits & 1;
+            noiseSynth->bits >>= 1;
+            noiseSynth->bits_left--;
+            noiseSynth->hold = (u16) rate_div;
+        }
+
+        size_t run = noiseSynth->hold < n - i ? noiseSynth->hold : n - i;
+        for (size_t k = 0; k < run; k++) {
+            out[i + k] = signedAmplitude(env[i + k], noiseSynth->held_bit);
+        }
+        noiseSynth->hold -= (u16) run;
+        i += run;
+    }
+}
+
+bool isNoiseSynthSilent(const NoiseSynth *noiseSynth) {
+    return !noiseSynth || envelopeIsIdle(noiseSynth->env);
+}
+
+void renderNoiseSynthAudio(u32 *dest, size_t size, NoiseSynth *noiseSynth) {
+    if (!noiseSynth || !noiseSynth->env) {
+        memset(dest, 0, size * NCHANNELS * sizeof(int16_t));
+        return;
+    }
+
+    s16 chunk[RENDER_CHUNK];
+    for (size_t pos = 0; pos < size; pos += RENDER_CHUNK) {
+        size_t n = (size - pos < RENDER_CHUNK) ? size - pos : RENDER_CHUNK;
+        renderNoiseSynthChunk(noiseSynth, chunk, n);
+        for (size_t i = 0; i < n; i++) {
+            dest[pos + i] = packStereo16(chunk[i], chunk[i]); // Mono
+        }
+    }
+}
+
+void fillNoiseSynthAudiobuffer(ndspWaveBuf *waveBuf, size_t size, NoiseSynth *noiseSynth) {
+    renderNoiseSynthAudio((u32 *) waveBuf->data_pcm16, size, noiseSynth);
     waveBuf->nsamples = size;
     DSP_FlushDataCache(waveBuf->data_pcm16, size * NCHANNELS * sizeof(int16_t));
 }
+
+void mixNoiseSynthAudiobuffer(float *mix_buf, size_t size, NoiseSynth *noiseSynth, float gain_l,
+                              float gain_r) {
+    if (!mix_buf || !noiseSynth || !noiseSynth->env) {
+        return;
+    }
+
+    s16 chunk[RENDER_CHUNK];
+    for (size_t pos = 0; pos < size; pos += RENDER_CHUNK) {
+        size_t n = (size - pos < RENDER_CHUNK) ? size - pos : RENDER_CHUNK;
+        renderNoiseSynthChunk(noiseSynth, chunk, n);
+        float *dst = &mix_buf[pos * NCHANNELS];
+        for (size_t i = 0; i < n; i++) {
+            float s = int16ToFloat(chunk[i]);
+            dst[i * NCHANNELS] += s * gain_l;
+            dst[i * NCHANNELS + 1] += s * gain_r;
+        }
+    }
+}
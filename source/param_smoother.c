@@ -0,0 +1,112 @@
+#include "param_smoother.h"
+#include "audio_simd.h"
+#include "audio_utils.h"
+#include "sine_table.h"
+
+#include <math.h>
+
+#define RAMP_Q24_ONE 16777216.0f
+
+void panLawGains(float pan, float volume, float *gain_l, float *gain_r) {
+    // [-1, 1] to the first quarter of the sine period, where cos is a quarter period ahead
+    u32 phase = unitToPhase((clamp(pan, -1.0f, 1.0f) + 1.0f) * 0.125f);
+    *gain_l   = sineFromPhase(phase + (1u << 30)) * volume;
+    *gain_r   = sineFromPhase(phase) * volume;
+}
+
+void initGainSmoother(GainSmoother *smoother, float rate, float gain_l, float gain_r) {
+    smoother->gain[0]     = smoother->target[0] = gain_l;
+    smoother->gain[1]     = smoother->target[1] = gain_r;
+    smoother->step[0]     = smoother->step[1] = 0.0f;
+    smoother->ramp_frames = (u32) (rate * GAIN_RAMP_MS / 1000.0f);
+    smoother->frames_left = 0;
+}
+
+bool gainSmootherSetTarget(GainSmoother *smoother, float gain_l, float gain_r) {
+    if (gain_l == smoother->target[0] && gain_r == smoother->target[1]) {
+        return false;
+    }
+    smoother->target[0] = gain_l;
+    smoother->target[1] = gain_r;
+
+    float delta_l = gain_l - smoother->gain[0];
+    float delta_r = gain_r - smoother->gain[1];
+    if (smoother->ramp_frames == 0 ||
+        fmaxf(fabsf(delta_l), fabsf(delta_r)) <= GAIN_RAMP_THRESHOLD) {
+        smoother->gain[0]     = gain_l;
+        smoother->gain[1]     = gain_r;
+        smoother->frames_left = 0;
+        return true;
+    }
+    // A ramp already under way restarts from where it got to
+    smoother->step[0]     = delta_l / (float) smoother->ramp_frames;
+    smoother->step[1]     = delta_r / (float) smoother->ramp_frames;
+    smoother->frames_left = smoother->ramp_frames;
+    return true;
+}
+
+// Takes the part of the ramp that falls within the next n frames
+static size_t advanceRamp(GainSmoother *smoother, size_t n) {
+    size_t ramp = n < smoother->frames_left ? n : smoother->frames_left;
+    smoother->frames_left -= ramp;
+    return ramp;
+}
+
+static void finishRamp(GainSmoother *smoother, size_t ramp) {
+    if (smoother->frames_left == 0) {
+        smoother->gain[0] = smoother->target[0];
+        smoother->gain[1] = smoother->target[1];
+    } else {
+        smoother->gain[0] += smoother->step[0] * (float) ramp;
+        smoother->gain[1] += smoother->step[1] * (float) ramp;
+    }
+}
+
+void applyGainSmoother(GainSmoother *smoother, u32 *frames, size_t n) {
+    size_t ramp = advanceRamp(smoother, n);
+    if (ramp > 0) {
+        // Stepped in Q24 so the truncated step does not drift over the ramp, applied as Q16
+        s32 acc_l  = (s32) (smoother->gain[0] * RAMP_Q24_ONE);
+        s32 acc_r  = (s32) (smoother->gain[1] * RAMP_Q24_ONE);
+        s32 step_l = (s32) (smoother->step[0] * RAMP_Q24_ONE);
+        s32 step_r = (s32) (smoother->step[1] * RAMP_Q24_ONE);
+        for (size_t i = 0; i < ramp; i++) {
+            frames[i] = packStereo16(ssat16(mulGainQ16Low(acc_l >> 8, frames[i])),
+                                     ssat16(mulGainQ16High(acc_r >> 8, frames[i])));
+            acc_l += step_l;
+            acc_r += step_r;
+        }
+        finishRamp(smoother, ramp);
+    }
+
+    s32 gain_l = floatToGainQ16(smoother->gain[0]);
+    s32 gain_r = floatToGainQ16(smoother->gain[1]);
+    if (ramp == n || (gain_l == GAIN_Q16_ONE && gain_r == GAIN_Q16_ONE)) {
+        return;
+    }
+    for (size_t i = ramp; i < n; i++) {
+        frames[i] = packStereo16(ssat16(mulGainQ16Low(gain_l, frames[i])),
+                                 ssat16(mulGainQ16High(gain_r, frames[i])));
+    }
+}
+
+void mixGainSmoother(GainSmoother *smoother, float *mix_buf, const u32 *frames, size_t n) {
+    size_t ramp   = advanceRamp(smoother, n);
+    float  gain_l = smoother->gain[0];
+    float  gain_r = smoother->gain[1];
+    for (size_t i = 0; i < ramp; i++) {
+        mix_buf[i * NCHANNELS] += int16ToFloat((s16) (frames[i] & 0xFFFF)) * gain_l;
+        mix_buf[i * NCHANNELS + 1] += int16ToFloat((s16) (frames[i] >> 16)) * gain_r;
+        gain_l += smoother->step[0];
+        gain_r += smoother->step[1];
+    }
+    if (ramp > 0) {
+        finishRamp(smoother, ramp);
+        gain_l = smoother->gain[0];
+        gain_r = smoother->gain[1];
+    }
+    for (size_t i = ramp; i < n; i++) {
+        mix_buf[i * NCHANNELS] += int16ToFloat((s16) (frames[i] & 0xFFFF)) * gain_l;
+        mix_buf[i * NCHANNELS + 1] += int16ToFloat((s16) (frames[i] >> 16)) * gain_r;
+    }
+}
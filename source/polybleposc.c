@@ -12,46 +12,10 @@ void setPulseWidth(PolyBLEPOscillator *osc, float pulse_width) {
 
 void setOscFrequency(PolyBLEPOscillator *osc, float frequency) {
     osc->frequency = frequency;
-    osc->phase_inc = frequency * M_TWOPI / osc->samplerate;
+    osc->phase_inc = (u32) (frequency / osc->samplerate * PHASE_RANGE);
 };
 
-float nextOscillatorSample(PolyBLEPOscillator *osc) {
-    float sample;
-    float t = osc->phase / M_TWOPI;
-
-    switch (osc->waveform) {
-    case SINE:
-        sample = sin(osc->phase);
-        break;
-    case SQUARE:
-        float square = t < osc->pulse_width ? 1.0f : -1.0f;
-        sample =
-            square + polyBLEP(osc, t) - polyBLEP(osc, fmod(t + (1.0f - osc->pulse_width), 1.0f));
-        break;
-    case SAW:
-        sample = ((2.0f * t) - 1.0f) - polyBLEP(osc, t);
-        break;
-    case TRIANGLE:
-        if (t < 0.5f) {
-            sample = 4.0f * t - 1.0f;
-        } else {
-            sample = -4.0f * (t - 0.5f) + 1.0f;
-        }
-        break;
-    default:
-        sample = sin(osc->phase);
-        break;
-    }
-    osc->phase += osc->phase_inc;
-    while (osc->phase >= M_TWOPI) {
-        osc->phase -= M_TWOPI;
-    }
-    return sample;
-};
-
-float polyBLEP(PolyBLEPOscillator *osc, float t) {
-    const float dt = osc->phase_inc / M_TWOPI;
-
+static inline float polyBLEPStep(float t, float dt) {
     // Calculate the polyblep value based on the phase within one period
     if (t < 0 || t > 1) {
         return 0.0f;
@@ -66,4 +30,75 @@ float polyBLEP(PolyBLEPOscillator *osc, float t) {
     }
 
     return 0.0f;
-};
\ No newline at end of file
+}
+
+// One expression per waveform. Each sees the u32 phase, t = phase in [0, 1), dt = phase increment
+// in cycles, pw = pulse width and pw_phase = the falling edge of the pulse as a phase offset.
+// Everything except phase and t is loop invariant and set up once per block.
+#define WAVEFORM_KERNELS(X)                                                                        \
+    X(SINE, sineFromPhase(phase))                                                                  \
+    X(SQUARE,                                                                                      \
+      (t < pw ? 1.0f : -1.0f) + polyBLEPStep(t, dt) -                                              \
+          polyBLEPStep(phaseToUnit(phase + pw_phase), dt))                                         \
+    X(SAW, ((2.0f * t) - 1.0f) - polyBLEPStep(t, dt))                                              \
+    X(TRIANGLE, (t < 0.5f) ? (4.0f * t - 1.0f) : (-4.0f * (t - 0.5f) + 1.0f))
+
+#define DEFINE_WAVEFORM_KERNEL(wf, expr)                                                           \
+    static inline float wf##_sample(u32 phase, float dt, float pw, u32 pw_phase) {                 \
+        const float t = phaseToUnit(phase);                                                        \
+        (void) t, (void) dt, (void) pw, (void) pw_phase;                                           \
+        return expr;                                                                               \
+    }                                                                                              \
+                                                                                                   \
+    static void wf##_block(PolyBLEPOscillator *osc, float *out, size_t n) {                        \
+        const u32   inc      = osc->phase_inc;                                                     \
+        const float dt       = inc * (1.0f / PHASE_RANGE);                                         \
+        const float pw       = osc->pulse_width;                                                   \
+        const u32   pw_phase = 0u - unitToPhase(pw);                                               \
+        u32         phase    = osc->phase;                                                         \
+        for (size_t i = 0; i < n; i++) {                                                           \
+            out[i] = wf##_sample(phase, dt, pw, pw_phase);                                         \
+            phase += inc;                                                                          \
+        }                                                                                          \
+        osc->phase = phase;                                                                        \
+    }
+
+WAVEFORM_KERNELS(DEFINE_WAVEFORM_KERNEL)
+
+void renderOscillatorBlock(PolyBLEPOscillator *osc, float *out, size_t n) {
+    switch (osc->waveform) {
+#define WAVEFORM_BLOCK_CASE(wf, expr)                                                              \
+    case wf:                                                                                       \
+        wf##_block(osc, out, n);                                                                   \
+        break;
+        WAVEFORM_KERNELS(WAVEFORM_BLOCK_CASE)
+#undef WAVEFORM_BLOCK_CASE
+    default:
+        SINE_block(osc, out, n);
+        break;
+    }
+}
+
+float nextOscillatorSample(PolyBLEPOscillator *osc) {
+    float sample;
+
+    // Arguments a waveform does not use are dropped once its kernel is inlined
+    switch (osc->waveform) {
+#define WAVEFORM_SAMPLE_CASE(wf, expr)                                                             \
+    case wf:                                                                                       \
+        sample = wf##_sample(osc->phase, osc->phase_inc * (1.0f / PHASE_RANGE), osc->pulse_width, \
+                             0u - unitToPhase(osc->pulse_width));                                  \
+        break;
+        WAVEFORM_KERNELS(WAVEFORM_SAMPLE_CASE)
+#undef WAVEFORM_SAMPLE_CASE
+    default:
+        sample = SINE_sample(osc->phase, 0.0f, 0.0f, 0);
+        break;
+    }
+    osc->phase += osc->phase_inc;
+    return sample;
+};
+
+float polyBLEP(PolyBLEPOscillator *osc, float t) {
+    return polyBLEPStep(t, osc->phase_inc * (1.0f / PHASE_RANGE));
+};
@@ -1,7 +1,7 @@
 #include "sample.h"
 #include "cleanup_queue.h"
+#include "linear_region.h"
 #include "sample_bank.h"
-#include <3ds/allocator/linear.h>
 #include <limits.h>
 #include <stdlib.h>
 #include <string.h>
@@ -27,24 +27,22 @@ static void _sample_destroy(Sample *sample) {
         return;
     }
     if (sample->pcm_data) {
-        linearFree(sample->pcm_data);
+        linearFreeTagged(LINEAR_TAG_SAMPLES, sample->pcm_data);
     }
-    if (sample->path) {
-        linearFree(sample->path);
-    }
-    linearFree(sample);
+    free(sample->path);
+    free(sample);
 }
 
 Sample *sample_create(const char *path) {
-    Sample *sample = (Sample *) linearAlloc(sizeof(Sample));
+    // Only the PCM data has to be DSP visible, the rest stays off the linear heap
+    Sample *sample = (Sample *) calloc(1, sizeof(Sample));
     if (!sample) {
         return NULL;
     }
 
-    // Replace strdup with malloc + strcpy
-    sample->path = linearAlloc(strlen(path) + 1);
+    sample->path = malloc(strlen(path) + 1);
     if (!sample->path) {
-        linearFree(sample);
+        free(sample);
         return NULL;
     }
     strcpy(sample->path, path);
@@ -52,20 +50,20 @@ Sample *sample_create(const char *path) {
     int          err      = 0;
     OggOpusFile *opusFile = op_open_file(path, &err);
     if (err != 0) {
-        linearFree(sample->path);
-        linearFree(sample);
+        free(sample->path);
+        free(sample);
         return NULL;
     }
 
     sample->pcm_length              = op_pcm_total(opusFile, -1);
     sample->pcm_data_size_in_frames = sample->pcm_length;
-    sample->pcm_data =
-        (int16_t *) linearAlloc(sample->pcm_data_size_in_frames * 2 * sizeof(int16_t));
+    sample->pcm_data                = (int16_t *) linearAllocTagged(
+        LINEAR_TAG_SAMPLES, sample->pcm_data_size_in_frames * 2 * sizeof(int16_t));
 
     if (!sample->pcm_data) {
         op_free(opusFile);
-        linearFree(sample->path);
-        linearFree(sample);
+        free(sample->path);
+        free(sample);
         return NULL;
     }
 
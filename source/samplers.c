@@ -11,6 +11,7 @@
 #include "samplers.h"
 #include "sample.h"
 
+#include "audio_simd.h"
 #include "audio_utils.h"
 #include "engine_constants.h"
 
@@ -21,49 +22,111 @@ bool samplerIsLooping(Sampler *sampler) {
            sampler->sample->pcm_data_size_in_frames > 0;
 }
 
-void fillSamplerAudioBuffer(ndspWaveBuf *waveBuf_, size_t size, Sampler *sampler) {
-    if (!sampler->sample || !sampler->sample->pcm_data) {
-        memset(waveBuf_->data_pcm16, 0, sampler->samples_per_buf * NCHANNELS * sizeof(int16_t));
-        waveBuf_->nsamples = sampler->samples_per_buf;
-        DSP_FlushDataCache(waveBuf_->data_pcm16,
-                           sampler->samples_per_buf * NCHANNELS * sizeof(int16_t));
-        return;
+// Renders n <= RENDER_CHUNK interleaved stereo frames into out. The envelope keeps running after
+// the sample has finished, as it did when it was stepped per frame.
+static void renderSamplerChunk(Sampler *sampler, float *out, size_t n) {
+    float env[RENDER_CHUNK];
+    renderEnvelopeBlock(sampler->env, env, n);
+
+    for (size_t i = 0; i < n; i++) {
+        if (!sampler->finished &&
+            sampler->current_frame >= sampler->sample->pcm_data_size_in_frames) {
+            sampler->finished = true; // swapped for a shorter sample while playing
+        }
+        if (sampler->finished) {
+            out[i * NCHANNELS]     = 0.0f;
+            out[i * NCHANNELS + 1] = 0.0f;
+            continue;
+        }
+
+        const int16_t *frame   = &sampler->sample->pcm_data[sampler->current_frame * NCHANNELS];
+        out[i * NCHANNELS]     = int16ToFloat(frame[0]) * env[i];
+        out[i * NCHANNELS + 1] = int16ToFloat(frame[1]) * env[i];
+
+        sampler->current_frame++;
+        if (sampler->current_frame >= sampler->sample->pcm_data_size_in_frames) {
+            if (samplerIsLooping(sampler)) {
+                sampler->current_frame = 0;
+            } else {
+                sampler->finished = true;
+            }
+        }
+    }
+}
+
+// Integer version of renderSamplerChunk for the channel fill: the PCM frames are scaled by the
+// envelope as packed int16 pairs and never go through float.
+static void renderSamplerChunkInt16(Sampler *sampler, u32 *out, size_t n) {
+    float env[RENDER_CHUNK];
+    s32   gain[RENDER_CHUNK];
+    renderEnvelopeBlock(sampler->env, env, n);
+    for (size_t i = 0; i < n; i++) {
+        gain[i] = floatToGainQ16(env[i]);
     }
 
-    int totalSamples = 0;
-    while (totalSamples < sampler->samples_per_buf) {
-        float   env_value = nextEnvelopeSample(sampler->env);
-        int16_t left_s    = 0;
-        int16_t right_s   = 0;
-
-        if (!sampler->finished) {
-            float left_f =
-                int16ToFloat(sampler->sample->pcm_data[sampler->current_frame * NCHANNELS]);
-            float right_f =
-                int16ToFloat(sampler->sample->pcm_data[sampler->current_frame * NCHANNELS + 1]);
-
-            left_f *= env_value;
-            right_f *= env_value;
-
-            left_s  = floatToInt16(left_f);
-            right_s = floatToInt16(right_f);
-
-            sampler->current_frame++;
-            if (sampler->current_frame >= sampler->sample->pcm_data_size_in_frames) {
-                if (samplerIsLooping(sampler)) {
-                    sampler->current_frame = 0;
-                } else {
-                    sampler->finished = true;
-                }
+    const u32 *frames = (const u32 *) sampler->sample->pcm_data;
+    size_t     total  = sampler->sample->pcm_data_size_in_frames;
+    size_t     i      = 0;
+    while (i < n) {
+        if (sampler->finished) {
+            memset(&out[i], 0, (n - i) * sizeof(u32));
+            return;
+        }
+
+        size_t left = total > sampler->current_frame ? total - sampler->current_frame : 0;
+        size_t run  = (left < n - i) ? left : n - i;
+        applyStereoGainQ16(&frames[sampler->current_frame], &out[i], &gain[i], run);
+        i += run;
+
+        sampler->current_frame += run;
+        if (sampler->current_frame >= total) {
+            if (samplerIsLooping(sampler)) {
+                sampler->current_frame = 0;
+            } else {
+                sampler->finished = true;
             }
         }
+    }
+}
+
+bool isSamplerSilent(const Sampler *sampler) {
+    return !sampler || !sampler->sample || !sampler->sample->pcm_data || sampler->finished ||
+           envelopeIsIdle(sampler->env);
+}
+
+void renderSamplerAudio(u32 *dest, size_t size, Sampler *sampler) {
+    if (!sampler->sample || !sampler->sample->pcm_data) {
+        memset(dest, 0, size * NCHANNELS * sizeof(int16_t));
+        return;
+    }
 
-        waveBuf_->data_pcm16[totalSamples * NCHANNELS]     = left_s;
-        waveBuf_->data_pcm16[totalSamples * NCHANNELS + 1] = right_s;
-        totalSamples++;
+    for (size_t pos = 0; pos < size; pos += RENDER_CHUNK) {
+        size_t n = (size - pos < RENDER_CHUNK) ? size - pos : RENDER_CHUNK;
+        renderSamplerChunkInt16(sampler, &dest[pos], n);
     }
+}
 
+void fillSamplerAudioBuffer(ndspWaveBuf *waveBuf_, size_t size, Sampler *sampler) {
+    renderSamplerAudio((u32 *) waveBuf_->data_pcm16, sampler->samples_per_buf, sampler);
     waveBuf_->nsamples = sampler->samples_per_buf;
     DSP_FlushDataCache(waveBuf_->data_pcm16,
                        sampler->samples_per_buf * NCHANNELS * sizeof(int16_t));
 };
+
+void mixSamplerAudioBuffer(float *mix_buf, size_t size, Sampler *sampler, float gain_l,
+                           float gain_r) {
+    if (!mix_buf || !sampler->sample || !sampler->sample->pcm_data) {
+        return;
+    }
+
+    float chunk[RENDER_CHUNK * NCHANNELS];
+    for (size_t pos = 0; pos < size; pos += RENDER_CHUNK) {
+        size_t n = (size - pos < RENDER_CHUNK) ? size - pos : RENDER_CHUNK;
+        renderSamplerChunk(sampler, chunk, n);
+        float *dst = &mix_buf[pos * NCHANNELS];
+        for (size_t i = 0; i < n; i++) {
+            dst[i * NCHANNELS] += chunk[i * NCHANNELS] * gain_l;
+            dst[i * NCHANNELS + 1] += chunk[i * NCHANNELS + 1] * gain_r;
+        }
+    }
+}
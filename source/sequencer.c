@@ -3,80 +3,244 @@
 #include <stdlib.h> // For malloc/free mock
 #else
 #include <3ds/types.h>
-#include <3ds/allocator/linear.h> // Updated path
 #endif
 
 #include "sequencer.h"
 
-void updateSeqLength(Sequencer *seq, size_t newLength) { // Changed from int
-    if (!seq || newLength == 0 || newLength > MAXSEQUENCELENGTH ||
-        newLength == (seq->n_beats * seq->steps_per_beat)) {
+#include <stdlib.h>
+#include <string.h>
+
+// A pattern and its records in one block, so a snapshot is a single allocation. The DSP never
+// reads patterns, so they come from the ordinary heap rather than the linear one.
+typedef struct {
+    Pattern        pattern;
+    StepParameters params[];
+} PatternBlock;
+
+#define PATTERN_BLOCK_BYTES (sizeof(PatternBlock) + MAXSEQUENCELENGTH * sizeof(StepParameters))
+
+static SequencerUsage s_usage = { 0 };
+
+static Pattern *allocPattern(void) {
+    PatternBlock *block = malloc(PATTERN_BLOCK_BYTES);
+    if (!block) {
+        return NULL;
+    }
+    s_usage.in_use += PATTERN_BLOCK_BYTES;
+    s_usage.n_blocks++;
+    if (s_usage.in_use > s_usage.peak) {
+        s_usage.peak = s_usage.in_use;
+    }
+    memset(&block->pattern, 0, sizeof(Pattern));
+    block->pattern.params = block->params;
+    return &block->pattern;
+}
+
+static void freePattern(Pattern *pattern) {
+    if (pattern) {
+        s_usage.in_use -= PATTERN_BLOCK_BYTES;
+        s_usage.n_blocks--;
+        free((PatternBlock *) pattern);
+    }
+}
+
+SequencerUsage sequencerUsage(void) {
+    return s_usage;
+}
+
+void sequencerUsageResetPeak(void) {
+    s_usage.peak = s_usage.in_use;
+}
+
+// Only the steps in play: a snapshot is never lengthened, the edit copy keeps the rest
+static void copyPattern(Pattern *dst, const Pattern *src) {
+    dst->n_beats        = src->n_beats;
+    dst->steps_per_beat = src->steps_per_beat;
+    memcpy(dst->active, src->active, sizeof(dst->active));
+    memcpy(dst->params, src->params, patternLength(src) * sizeof(StepParameters));
+}
+
+void patternSetStepActive(Pattern *pattern, size_t step, bool active) {
+    if (!pattern || step >= patternLength(pattern)) {
         return;
     }
+    u32 bit = 1u << (step % 32);
+    if (active) {
+        pattern->active[step / 32] |= bit;
+    } else {
+        pattern->active[step / 32] &= ~bit;
+    }
+}
 
-    size_t   old_n_steps = seq->n_beats * seq->steps_per_beat;
-    SeqStep *old_steps   = (SeqStep *) linearAlloc(old_n_steps * sizeof(SeqStep));
-    if (!old_steps) {
+void patternToggleStep(Pattern *pattern, size_t step) {
+    if (!pattern || step >= patternLength(pattern)) {
         return;
     }
+    pattern->active[step / 32] ^= 1u << (step % 32);
+}
+
+StepParameters *patternStepParams(Pattern *pattern, size_t step) {
+    if (!pattern || step >= patternLength(pattern)) {
+        return NULL;
+    }
+    return &pattern->params[step];
+}
 
-    // Backup current steps
-    for (size_t i = 0; i < old_n_steps; i++) { // Changed from int
-        old_steps[i] = seq->steps[i];
+bool initSequencer(Sequencer *seq, size_t n_steps, const StepParameters *defaults) {
+    if (!seq || n_steps == 0 || n_steps > MAXSEQUENCELENGTH || n_steps % 4 != 0) {
+        return false;
     }
+    memset(seq, 0, sizeof(*seq));
+    atomic_init(&seq->pending, NULL);
+    atomic_init(&seq->retired_write, 0);
+    atomic_init(&seq->retired_read, 0);
 
-    // Allocate new buffer
-    SeqStep *new_steps = (SeqStep *) linearAlloc(newLength * sizeof(SeqStep));
-    if (!new_steps) {
-        linearFree(old_steps);
+    seq->edit = allocPattern();
+    if (!seq->edit) {
+        return false;
+    }
+    seq->edit->n_beats        = n_steps / 4;
+    seq->edit->steps_per_beat = 4;
+    for (size_t i = 0; i < MAXSEQUENCELENGTH; i++) {
+        seq->edit->params[i] = *defaults;
+    }
+
+    // No audio thread yet, so the first snapshot can be played straight away
+    if (!sequencerPublish(seq)) {
+        cleanupSequencer(seq);
+        return false;
+    }
+    seq->playing = atomic_exchange_explicit(&seq->pending, NULL, memory_order_relaxed);
+    return true;
+}
+
+void updateSeqLength(Sequencer *seq, size_t newLength) {
+    Pattern *edit = seq ? seq->edit : NULL;
+    if (!edit || edit->steps_per_beat <= 0 || newLength > MAXSEQUENCELENGTH ||
+        newLength < (size_t) edit->steps_per_beat) {
         return;
     }
+    edit->n_beats = newLength / edit->steps_per_beat;
+}
 
-    // Copy and extend if needed
-    for (size_t i = 0; i < newLength; i++) { // Changed from int
-        new_steps[i] = (i < old_n_steps) ? old_steps[i] : old_steps[old_n_steps - 1];
+// Keeps one snapshot around for the next publish to copy into, frees any other
+static void keepSpare(Sequencer *seq, Pattern *snapshot) {
+    if (!seq->spare) {
+        seq->spare = snapshot;
+    } else {
+        freePattern(snapshot);
     }
+}
+
+bool sequencerPublish(Sequencer *seq) {
+    if (!seq || !seq->edit) {
+        return false;
+    }
+    Pattern *snapshot = seq->spare ? seq->spare : allocPattern();
+    seq->spare        = NULL;
+    if (!snapshot) {
+        return false;
+    }
+    copyPattern(snapshot, seq->edit);
 
-    linearFree(old_steps);
-    linearFree(seq->steps);
-    seq->steps   = new_steps;
-    seq->n_beats = newLength / seq->steps_per_beat;
-    seq->cur_step %= newLength;
+    // The release makes the copy visible before the pointer. A snapshot handed back here was
+    // published but never picked up, so the audio thread cannot be reading it.
+    Pattern *unseen = atomic_exchange_explicit(&seq->pending, snapshot, memory_order_acq_rel);
+    if (unseen) {
+        keepSpare(seq, unseen);
+    }
+    return true;
 }
 
-void setSteps(Sequencer *seq, SeqStep *steps) {
-    if (!seq || !steps)
+void sequencerReclaim(Sequencer *seq) {
+    if (!seq) {
         return;
-    for (size_t i = 0; i < (seq->n_beats * seq->steps_per_beat); i++) { // Changed from int
-        seq->steps[i] = steps[i];
+    }
+    int read = atomic_load_explicit(&seq->retired_read, memory_order_relaxed);
+    while (read != atomic_load_explicit(&seq->retired_write, memory_order_acquire)) {
+        keepSpare(seq, seq->retired[read]);
+        read = (read + 1) % SEQ_RETIRED_SLOTS;
+        atomic_store_explicit(&seq->retired_read, read, memory_order_release);
     }
 }
 
-SeqStep updateSequencer(Sequencer *seq) {
-    if (!seq || !seq->steps) {
-        return (SeqStep) { .active = false, .data = NULL };
+// Audio thread: moves to the newest snapshot, retiring the one it was playing. With the cleanup
+// queue full it carries on with the old one and tries again next step.
+static void acquirePattern(Sequencer *seq) {
+    if (!atomic_load_explicit(&seq->pending, memory_order_relaxed)) {
+        return;
+    }
+    int write = atomic_load_explicit(&seq->retired_write, memory_order_relaxed);
+    int next  = (write + 1) % SEQ_RETIRED_SLOTS;
+    if (seq->playing && next == atomic_load_explicit(&seq->retired_read, memory_order_acquire)) {
+        return;
     }
 
-    SeqStep current_step = seq->steps[seq->cur_step];
-    seq->cur_step        = (seq->cur_step + 1) % (seq->n_beats * seq->steps_per_beat);
-    return current_step;
+    Pattern *snapshot = atomic_exchange_explicit(&seq->pending, NULL, memory_order_acquire);
+    if (!snapshot) {
+        return;
+    }
+    if (seq->playing) {
+        seq->retired[write] = (Pattern *) seq->playing;
+        atomic_store_explicit(&seq->retired_write, next, memory_order_release);
+    }
+    seq->playing  = snapshot;
+    size_t n      = patternLength(snapshot);
+    seq->cur_step = n > 0 ? seq->cur_step % n : 0;
+}
+
+const StepParameters *updateSequencer(Sequencer *seq) {
+    if (!seq) {
+        return NULL;
+    }
+    acquirePattern(seq);
+    const Pattern *pattern = seq->playing;
+    size_t         n       = pattern ? patternLength(pattern) : 0;
+    if (n == 0) {
+        return NULL;
+    }
+
+    size_t step   = seq->cur_step;
+    seq->cur_step = (step + 1) % n;
+    return patternStepActive(pattern, step) ? &pattern->params[step] : NULL;
+}
+
+// Clock steps between two sequencer steps, 0 when the playing pattern has none to fire
+static int stepInterval(const Sequencer *seq) {
+    if (!seq || !seq->playing || seq->playing->steps_per_beat <= 0) {
+        return 0;
+    }
+    return STEPS_PER_BEAT / seq->playing->steps_per_beat;
+}
+
+// True when the clock step just counted lands on one of this sequencer's steps
+bool sequencerStepDue(const Sequencer *seq, int clock_steps) {
+    int interval = stepInterval(seq);
+    if (interval == 0) {
+        return false;
+    }
+    return (clock_steps - 1) % interval == 0;
+}
+
+int sequencerNextStepTick(const Sequencer *seq, int clock_steps) {
+    int interval = stepInterval(seq);
+    if (interval == 0) {
+        return 0;
+    }
+    return clock_steps + interval - (clock_steps - 1) % interval;
 }
 
 void cleanupSequencer(Sequencer *seq) {
     if (!seq)
         return;
 
-    if (seq->steps) {
-        for (size_t i = 0; i < (seq->n_beats * seq->steps_per_beat); i++) {
-            if (seq->steps[i].data) {
-                // Note: don't free data here as it's owned by trackParamsArray
-                seq->steps[i].data = NULL;
-            }
-        }
-        linearFree(seq->steps);
-        seq->steps = NULL;
-    }
-
+    sequencerReclaim(seq);
+    freePattern(atomic_exchange_explicit(&seq->pending, NULL, memory_order_relaxed));
+    freePattern((Pattern *) seq->playing);
+    freePattern(seq->spare);
+    freePattern(seq->edit);
+    seq->playing  = NULL;
+    seq->spare    = NULL;
+    seq->edit     = NULL;
     seq->cur_step = 0;
-    seq->n_beats  = 0;
-}
\ No newline at end of file
+}
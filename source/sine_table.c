@@ -0,0 +1,12 @@
+#include "sine_table.h"
+
+#include <math.h>
+
+s16 sine_table[SINE_TABLE_SIZE + 1];
+
+void initSineTable(void) {
+    for (int i = 0; i <= SINE_TABLE_SIZE; i++) {
+        double phase  = 2.0 * M_PI * i / SINE_TABLE_SIZE;
+        sine_table[i] = (s16) lrint(sin(phase) * 32767.0);
+    }
+}
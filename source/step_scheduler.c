@@ -0,0 +1,60 @@
+#include "step_scheduler.h"
+
+static bool scheduledBefore(const ScheduledTrack *a, const ScheduledTrack *b) {
+    return a->tick < b->tick || (a->tick == b->tick && a->track < b->track);
+}
+
+static void swapScheduled(ScheduledTrack *a, ScheduledTrack *b) {
+    ScheduledTrack tmp = *a;
+    *a                 = *b;
+    *b                 = tmp;
+}
+
+void stepSchedulerClear(StepScheduler *sched) {
+    sched->count = 0;
+}
+
+bool stepSchedulerPush(StepScheduler *sched, int track, int tick) {
+    if (sched->count >= N_TRACKS) {
+        return false;
+    }
+    int i          = sched->count++;
+    sched->heap[i] = (ScheduledTrack) { .tick = tick, .track = track };
+    // Sift up
+    while (i > 0) {
+        int parent = (i - 1) / 2;
+        if (!scheduledBefore(&sched->heap[i], &sched->heap[parent])) {
+            break;
+        }
+        swapScheduled(&sched->heap[i], &sched->heap[parent]);
+        i = parent;
+    }
+    return true;
+}
+
+int stepSchedulerPopDue(StepScheduler *sched, int tick) {
+    if (sched->count == 0 || sched->heap[0].tick > tick) {
+        return -1;
+    }
+    int track      = sched->heap[0].track;
+    sched->heap[0] = sched->heap[--sched->count];
+    // Sift down
+    int i = 0;
+    for (;;) {
+        int first = i;
+        int left  = 2 * i + 1;
+        int right = left + 1;
+        if (left < sched->count && scheduledBefore(&sched->heap[left], &sched->heap[first])) {
+            first = left;
+        }
+        if (right < sched->count && scheduledBefore(&sched->heap[right], &sched->heap[first])) {
+            first = right;
+        }
+        if (first == i) {
+            break;
+        }
+        swapScheduled(&sched->heap[i], &sched->heap[first]);
+        i = first;
+    }
+    return track;
+}
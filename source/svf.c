@@ -0,0 +1,125 @@
+#include "svf.h"
+#include "audio_simd.h"
+
+#include <math.h>
+#include <string.h>
+
+const char *svf_mode_names[] = { "Off", "Low-Pass", "Band-Pass", "High-Pass" };
+
+// Highest cutoff as a fraction of the sample rate, where SVFFastTan is still within a few percent
+#define SVF_MAX_CUTOFF_RATIO 0.45f
+
+float SVFFastTan(float x) {
+    float x2 = x * x;
+    return x * (15.0f - x2) / (15.0f - 6.0f * x2);
+}
+
+void initSVF(SVFilter *svf, float samplerate) {
+    if (!svf)
+        return;
+    memset(svf, 0, sizeof(*svf));
+    svf->samplerate = samplerate;
+    svf->cutoff     = 1000.0f;
+    svf->k          = 2.0f;
+    svf->env        = defaultEnvelopeStruct(samplerate);
+}
+
+void SVFSetParams(SVFilter *svf, SVFMode mode, float cutoff, float resonance, float env_amount,
+                  int env_decay_ms) {
+    if (!svf)
+        return;
+    if (mode < SVF_OFF || mode >= SVF_MODE_COUNT) {
+        mode = SVF_OFF;
+    }
+    if (svf->mode == SVF_OFF && mode != SVF_OFF) {
+        // Coming out of bypass: the integrators hold whatever was playing when it was switched off
+        clearSVFState(svf);
+    }
+    svf->mode       = mode;
+    svf->cutoff     = cutoff;
+    svf->resonance  = fmaxf(0.0f, fminf(1.0f, resonance));
+    svf->env_amount = fmaxf(-SVF_MAX_ENV_OCTAVES, fminf(SVF_MAX_ENV_OCTAVES, env_amount));
+    // The envelope is a plain decay from full level, it only shapes the sweep
+    updateEnvelope(&svf->env, 1, env_decay_ms, 0.0f, 1, 0);
+}
+
+void clearSVFState(SVFilter *svf) {
+    if (!svf)
+        return;
+    memset(svf->ic1eq, 0, sizeof(svf->ic1eq));
+    memset(svf->ic2eq, 0, sizeof(svf->ic2eq));
+}
+
+void triggerSVF(SVFilter *svf) {
+    if (!svf)
+        return;
+    triggerEnvelope(&svf->env);
+}
+
+// Coefficients for one control period at cutoff * 2^(env_amount * env)
+static void updateCoefficients(SVFilter *svf, float env) {
+    float cutoff = svf->cutoff;
+    if (env > 0.0f && svf->env_amount != 0.0f) {
+        cutoff *= exp2f(svf->env_amount * env);
+    }
+    float max_cutoff = svf->samplerate * SVF_MAX_CUTOFF_RATIO;
+    cutoff           = fmaxf(SVF_MIN_CUTOFF, fminf(max_cutoff, cutoff));
+
+    float g = SVFFastTan((float) M_PI * cutoff / svf->samplerate);
+    svf->k  = 2.0f - 1.98f * svf->resonance;
+    svf->a1 = 1.0f / (1.0f + g * (g + svf->k));
+    svf->a2 = g * svf->a1;
+    svf->a3 = g * svf->a2;
+}
+
+// One control period of both channels. The three responses come from the same two integrators,
+// each mode is a fixed mix of input, band and low: y = m0 * v0 + m1 * v1 + m2 * v2.
+static void processPeriod(SVFilter *svf, s16 *samples, size_t n) {
+    const float a1 = svf->a1, a2 = svf->a2, a3 = svf->a3;
+    float       m0 = 0.0f, m1 = 0.0f, m2 = 1.0f;
+    if (svf->mode == SVF_BANDPASS) {
+        m1 = 1.0f;
+        m2 = 0.0f;
+    } else if (svf->mode == SVF_HIGHPASS) {
+        m0 = 1.0f;
+        m1 = -svf->k;
+        m2 = -1.0f;
+    }
+
+    float ic1l = svf->ic1eq[0], ic2l = svf->ic2eq[0];
+    float ic1r = svf->ic1eq[1], ic2r = svf->ic2eq[1];
+    for (size_t i = 0; i < n; i++) {
+        float l0 = (float) samples[i * NCHANNELS];
+        float r0 = (float) samples[i * NCHANNELS + 1];
+        float l3 = l0 - ic2l, r3 = r0 - ic2r;
+        float l1 = a1 * ic1l + a2 * l3, r1 = a1 * ic1r + a2 * r3;
+        float l2 = ic2l + a2 * ic1l + a3 * l3, r2 = ic2r + a2 * ic1r + a3 * r3;
+        ic1l     = 2.0f * l1 - ic1l;
+        ic1r     = 2.0f * r1 - ic1r;
+        ic2l     = 2.0f * l2 - ic2l;
+        ic2r     = 2.0f * r2 - ic2r;
+
+        samples[i * NCHANNELS]     = (s16) ssat16((s32) (m0 * l0 + m1 * l1 + m2 * l2));
+        samples[i * NCHANNELS + 1] = (s16) ssat16((s32) (m0 * r0 + m1 * r1 + m2 * r2));
+    }
+    svf->ic1eq[0] = ic1l;
+    svf->ic2eq[0] = ic2l;
+    svf->ic1eq[1] = ic1r;
+    svf->ic2eq[1] = ic2r;
+}
+
+void processSVFFrames(SVFilter *svf, u32 *frames, size_t n) {
+    if (SVFIsBypassed(svf)) {
+        return;
+    }
+
+    // NDSP frames are little-endian pairs of s16, left first
+    s16  *samples = (s16 *) frames;
+    float env[SVF_CONTROL_SAMPLES];
+    for (size_t pos = 0; pos < n; pos += SVF_CONTROL_SAMPLES) {
+        size_t len = n - pos < SVF_CONTROL_SAMPLES ? n - pos : SVF_CONTROL_SAMPLES;
+        renderEnvelopeBlock(&svf->env, env, len);
+        updateCoefficients(svf, env[0]);
+        processPeriod(svf, &samples[pos * NCHANNELS], len);
+    }
+}
@@ -6,46 +6,108 @@
 #include <3ds/types.h>
 #endif
 
+#include "audio_simd.h"
 #include "audio_utils.h"
 #include "synth.h"
 #include "engine_constants.h"
 
-void fillFMSynthAudiobuffer(ndspWaveBuf *waveBuf, size_t size, FMSynth *fm_synth) {
-    if (!waveBuf) {
-        return;
+// Renders n <= RENDER_CHUNK mono samples into out
+static void renderSubSynthChunk(SubSynth *subsynth, float *out, size_t n) {
+    float osc[RENDER_CHUNK];
+    renderOscillatorBlock(subsynth->osc, osc, n);
+    renderEnvelopeBlock(subsynth->env, out, n);
+    for (size_t i = 0; i < n; i++) {
+        float next_sam  = fmaxf(-1.0f, fminf(1.0f, osc[i]));
+        float env_value = fmaxf(0.0f, fminf(1.0f, out[i]));
+        out[i]          = next_sam * env_value;
     }
+}
+
+bool isSubSynthSilent(const SubSynth *subsynth) {
+    return !subsynth || !subsynth->osc || envelopeIsIdle(subsynth->env);
+}
+
+bool isFMSynthSilent(const FMSynth *fm_synth) {
+    // The carrier envelopes gate the output, the modulators only colour it
+    return FMIsIdle(fm_synth);
+}
 
-    if (!fm_synth || !fm_synth->fm_op || !fm_synth->carrierEnv) {
-        fillBufferWithZeros(waveBuf->data_pcm16, size * NCHANNELS * sizeof(int16_t));
+void renderFMSynthAudio(u32 *dest, size_t size, FMSynth *fm_synth) {
+    if (!fm_synth) {
+        fillBufferWithZeros(dest, size * BYTESPERSAMPLE);
         return;
     }
 
-    for (size_t i = 0; i < size; i++) {
-        float sample  = nextFMOscillatorSample(fm_synth->fm_op);
-        float env_val = nextEnvelopeSample(fm_synth->carrierEnv);
-        sample *= env_val;
+    // The FM engine is integer throughout, so its output goes straight into the frames
+    s16 chunk[RENDER_CHUNK];
+    for (size_t pos = 0; pos < size; pos += RENDER_CHUNK) {
+        size_t n = (size - pos < RENDER_CHUNK) ? size - pos : RENDER_CHUNK;
+        renderFMBlock(fm_synth, chunk, n);
+        for (size_t i = 0; i < n; i++) {
+            dest[pos + i] = packStereo16(chunk[i], chunk[i]);
+        }
+    }
+}
 
-        s16  sample_i16 = floatToInt16(sample);
-        u32 *dest       = (u32 *) waveBuf->data_pcm16;
-        dest[i]         = (sample_i16 << 16) | (sample_i16 & 0xffff);
+void renderSubSynthAudio(u32 *dest, size_t size, SubSynth *subsynth) {
+    float chunk[RENDER_CHUNK];
+
+    for (size_t pos = 0; pos < size; pos += RENDER_CHUNK) {
+        size_t n = (size - pos < RENDER_CHUNK) ? size - pos : RENDER_CHUNK;
+        renderSubSynthChunk(subsynth, chunk, n);
+        floatToStereoInt16(chunk, &dest[pos], n);
+    }
+}
+
+void fillFMSynthAudiobuffer(ndspWaveBuf *waveBuf, size_t size, FMSynth *fm_synth) {
+    if (!waveBuf) {
+        return;
     }
+
+    renderFMSynthAudio((u32 *) waveBuf->data_pcm16, size, fm_synth);
     waveBuf->nsamples = size;
     DSP_FlushDataCache(waveBuf->data_pcm16, size * NCHANNELS * sizeof(int16_t));
 }
 
 void fillSubSynthAudiobuffer(ndspWaveBuf *waveBuf, size_t size, SubSynth *subsynth) {
-    u32 *dest = (u32 *) waveBuf->data_pcm16;
+    renderSubSynthAudio((u32 *) waveBuf->data_pcm16, size, subsynth);
+    waveBuf->nsamples = size;
+    DSP_FlushDataCache(waveBuf->data_pcm16, size * NCHANNELS * sizeof(int16_t));
+};
 
-    for (int i = 0; i < size; i++) {
-        float next_sam  = nextOscillatorSample(subsynth->osc);
-        next_sam        = fmaxf(-1.0f, fminf(1.0f, next_sam));
-        float env_value = nextEnvelopeSample(subsynth->env);
-        env_value       = fmaxf(0.0f, fminf(1.0f, env_value));
-        next_sam *= env_value;
-        s16 sample = floatToInt16(next_sam);
-        dest[i]    = (sample << 16) | (sample & 0xffff);
+void mixFMSynthAudiobuffer(float *mix_buf, size_t size, FMSynth *fm_synth, float gain_l,
+                           float gain_r) {
+    if (!mix_buf || !fm_synth) {
+        return;
     }
 
-    waveBuf->nsamples = size;
-    DSP_FlushDataCache(waveBuf->data_pcm16, size * NCHANNELS * sizeof(int16_t));
-};
\ No newline at end of file
+    s16 chunk[RENDER_CHUNK];
+    for (size_t pos = 0; pos < size; pos += RENDER_CHUNK) {
+        size_t n = (size - pos < RENDER_CHUNK) ? size - pos : RENDER_CHUNK;
+        renderFMBlock(fm_synth, chunk, n);
+        float *dst = &mix_buf[pos * NCHANNELS];
+        for (size_t i = 0; i < n; i++) {
+            float s = int16ToFloat(chunk[i]);
+            dst[i * NCHANNELS] += s * gain_l;
+            dst[i * NCHANNELS + 1] += s * gain_r;
+        }
+    }
+}
+
+void mixSubSynthAudiobuffer(float *mix_buf, size_t size, SubSynth *subsynth, float gain_l,
+                            float gain_r) {
+    if (!mix_buf || !subsynth) {
+        return;
+    }
+
+    float chunk[RENDER_CHUNK];
+    for (size_t pos = 0; pos < size; pos += RENDER_CHUNK) {
+        size_t n = (size - pos < RENDER_CHUNK) ? size - pos : RENDER_CHUNK;
+        renderSubSynthChunk(subsynth, chunk, n);
+        float *dst = &mix_buf[pos * NCHANNELS];
+        for (size_t i = 0; i < n; i++) {
+            dst[i * NCHANNELS] += chunk[i] * gain_l;
+            dst[i * NCHANNELS + 1] += chunk[i] * gain_r;
+        }
+    }
+}
\ No newline at end of file
@@ -5,6 +5,10 @@
 #include "samplers.h"
 #include "noise_synth.h"
 #include "envelope.h"
+#include "instrument.h"
+#include "audio_stats.h"
+#include "step_scheduler.h"
+#include "track_render.h"
 #include "engine_constants.h"
 #include <3ds/ndsp/ndsp.h>
 #include <stdio.h>
@@ -19,91 +23,230 @@ static LightEvent s_audio_event;
 static Track         *s_tracks_ptr       = NULL;
 static EventQueue    *s_event_queue_ptr  = NULL;
 static SampleBank    *s_sample_bank_ptr  = NULL;
-static Clock         *s_clock_ptr        = NULL;
-static LightLock     *s_clock_lock_ptr   = NULL;
+static MixBus        *s_mix_bus_ptr      = NULL;
+static const u32     *s_silence_buffer   = NULL;
+static Clock         *s_clock_ptr        = NULL; // this thread's alone, see g_clock_display
 static volatile bool *s_should_exit_ptr  = NULL;
 static s32            s_main_thread_prio = 0;
 
+static TrackSchedule s_schedules[N_TRACKS];
+static u32           s_scheduled_blocks = 0; // blocks the clock has been advanced through
+static u32           s_block_frames     = 0; // frames in one block, what the clock moves by
+static StepScheduler s_step_scheduler;       // the clock step each track fires on next
+
+static LatencyProfileId s_latency_profile = DEFAULT_LATENCY_PROFILE;
+
 static void audio_callback(void *data) {
     LightEvent_Signal(&s_audio_event);
 }
 
-// Helper function to process events on the audio thread
-static void processSequencerTick() {
-    s_clock_ptr->barBeats->steps++;
-    int totBeats                     = (s_clock_ptr->barBeats->steps - 1) / STEPS_PER_BEAT;
-    s_clock_ptr->barBeats->bar       = totBeats / s_clock_ptr->barBeats->beats_per_bar;
-    s_clock_ptr->barBeats->beat      = (totBeats % s_clock_ptr->barBeats->beats_per_bar);
-    s_clock_ptr->barBeats->deltaStep = (s_clock_ptr->barBeats->steps - 1) % STEPS_PER_BEAT;
+// Resolves a sampler step's sample before applying the step: the bank and its reference counts
+// belong to this thread
+static void applyStepEvent(Track *track, const StepPayload *step, bool trigger) {
+    if (!track || !track->instrument_data || !step) {
+        return;
+    }
+    if (step->instrument_type == OPUS_SAMPLER) {
+        const OpusSamplerParameters *opusSamplerParams = &step->params.instrument.sampler_params;
+        Sampler                     *s                 = (Sampler *) track->instrument_data;
+        Sample                      *new_sample =
+            SampleBankGetSample(s_sample_bank_ptr, opusSamplerParams->sample_index);
+        if (new_sample != s->sample) {
+            sample_inc_ref(new_sample);
+            sample_dec_ref_audio_thread(s->sample);
+            s->sample = new_sample;
+        }
+    }
+    applyTrackStep(track, step, trigger);
+}
 
+static void resetStepScheduler() {
+    stepSchedulerClear(&s_step_scheduler);
     for (int track_idx = 0; track_idx < N_TRACKS; track_idx++) {
-        Track *track = &s_tracks_ptr[track_idx];
-        if (!track || !track->sequencer || track->sequencer->steps_per_beat == 0) {
-            continue;
+        if (s_tracks_ptr[track_idx].sequencer) {
+            stepSchedulerPush(&s_step_scheduler, track_idx, 1);
         }
+    }
+}
 
-        int clock_steps_per_seq_step = STEPS_PER_BEAT / track->sequencer->steps_per_beat;
-        if (clock_steps_per_seq_step == 0)
-            continue;
+// Counts a clock step and advances the tracks whose next step falls on it. Steps nobody is due
+// on cost a single comparison.
+static void processSequencerTick(u32 block, u16 offset) {
+    advanceMusicalTime(s_clock_ptr);
+    int now = s_clock_ptr->barBeats->steps;
 
-        if ((s_clock_ptr->barBeats->steps - 1) % clock_steps_per_seq_step == 0) {
-            SeqStep step = updateSequencer(track->sequencer);
-            if (step.active && !track->is_muted && step.data) {
-                Event event                      = { .type = TRIGGER_STEP, .track_id = track_idx };
-                event.data.step_data.base_params = *step.data;
-                event.data.step_data.instrument_type = track->instrument_type;
-
-                if (track->instrument_type == SUB_SYNTH) {
-                    memcpy(&event.data.step_data.instrument_specific_params.subsynth_params,
-                           step.data->instrument_data, sizeof(SubSynthParameters));
-                } else if (track->instrument_type == OPUS_SAMPLER) {
-                    memcpy(&event.data.step_data.instrument_specific_params.sampler_params,
-                           step.data->instrument_data, sizeof(OpusSamplerParameters));
-                } else if (track->instrument_type == FM_SYNTH) {
-                    memcpy(&event.data.step_data.instrument_specific_params.fm_synth_params,
-                           step.data->instrument_data, sizeof(FMSynthParameters));
-                } else if (track->instrument_type == NOISE_SYNTH) {
-                    memcpy(&event.data.step_data.instrument_specific_params.noise_synth_params,
-                           step.data->instrument_data, sizeof(NoiseSynthParameters));
-                }
-                eventQueuePush(s_event_queue_ptr, event);
-            }
+    int track_idx;
+    while ((track_idx = stepSchedulerPopDue(&s_step_scheduler, now)) >= 0) {
+        Track                *track = &s_tracks_ptr[track_idx];
+        const StepParameters *step  = updateSequencer(track->sequencer);
+        if (step && !track->is_muted) {
+            scheduleStep(&s_schedules[track_idx], block, offset, track->instrument_type, step);
+        }
+        // After updateSequencer, so a newly published subdivision sets the next step
+        int next = sequencerNextStepTick(track->sequencer, now);
+        if (next > now) {
+            stepSchedulerPush(&s_step_scheduler, track_idx, next);
         }
     }
 }
 
-static void audio_thread_entry(void *arg) {
-    while (1) {
-        LightEvent_Wait(&s_audio_event);
-        if (*s_should_exit_ptr) {
-            break;
+// Re-slices every channel's buffers for a new latency profile. Queued audio is dropped, the
+// scheduled steps and the clock carry on from where they were.
+static void applyLatencyProfile(LatencyProfileId profile) {
+    if (profile < 0 || profile >= LATENCY_PROFILE_COUNT) {
+        return;
+    }
+    s_latency_profile = profile;
+
+    for (int i = 0; i < N_TRACKS; i++) {
+        trackSetLatency(&s_tracks_ptr[i], profile);
+    }
+
+    if (s_mix_bus_ptr) {
+        mixBusSetLatency(s_mix_bus_ptr, profile);
+        s_block_frames = s_mix_bus_ptr->samples_per_buf;
+        setClockSamplerate(s_clock_ptr, s_mix_bus_ptr->rate);
+    } else {
+        s_block_frames = latencyBlockFrames(profile, SAMPLERATE);
+        setClockSamplerate(s_clock_ptr, SAMPLERATE);
+    }
+    u64 block_ticks           = (u64) SYSCLOCK_ARM11 * latency_profiles[profile].block_ms / 1000;
+    g_audio_stats.block_ticks = (u32) block_ticks;
+}
+
+// Publishes where the transport is for the other threads
+static void publishClockDisplay() {
+    ClockDisplay display = {
+        .bar             = s_clock_ptr->barBeats->bar,
+        .beat            = s_clock_ptr->barBeats->beat,
+        .bpm             = s_clock_ptr->bpm,
+        .status          = s_clock_ptr->status,
+        .beats_per_bar   = s_clock_ptr->barBeats->beats_per_bar,
+        .latency_profile = s_latency_profile,
+    };
+    if (s_tracks_ptr && s_tracks_ptr[0].sequencer) {
+        display.cur_step = s_tracks_ptr[0].sequencer->cur_step;
+    }
+    clockDisplayPublish(&g_clock_display, &display);
+}
+
+// Advances the clock through the next block and schedules the steps that fall inside it
+static void scheduleNextBlock() {
+    u16 offsets[MAX_TICKS_PER_BLOCK];
+
+    u64 start = svcGetSystemTick();
+    int ticks = advanceClock(s_clock_ptr, s_block_frames, offsets, MAX_TICKS_PER_BLOCK);
+    for (int i = 0; i < ticks; i++) {
+        processSequencerTick(s_scheduled_blocks, offsets[i]);
+    }
+    audioStatsRecord(&g_audio_stats, STAGE_SEQUENCER, svcGetSystemTick() - start);
+
+    publishClockDisplay();
+    s_scheduled_blocks++;
+}
+
+// True when a buffer has come back and the clock has not been advanced for it yet
+static bool blockDue() {
+    if (s_mix_bus_ptr) {
+        return mixBusReady(s_mix_bus_ptr) && s_schedules[0].rendered_blocks == s_scheduled_blocks;
+    }
+    for (int i = 0; i < N_TRACKS; i++) {
+        Track *track = &s_tracks_ptr[i];
+        if (track->waveBuf[track->fillBlock].status == NDSP_WBUF_DONE &&
+            s_schedules[i].rendered_blocks == s_scheduled_blocks) {
+            return true;
         }
-        ClockDisplay temp_display;
+    }
+    return false;
+}
 
-        LightLock_Lock(s_clock_lock_ptr);
-        int ticks_to_process = updateClock(s_clock_ptr);
+// Sums every track into the mix bus: one conversion, one cache flush and one wavebuf per block.
+// Returns false when there was nothing to render. Sets *underrun if the bus had run dry.
+static bool renderMixBus(bool *underrun) {
+    if (!mixBusReady(s_mix_bus_ptr) || s_schedules[0].rendered_blocks == s_scheduled_blocks) {
+        return false;
+    }
+    if (waveBufsStarved(s_mix_bus_ptr->waveBuf, s_mix_bus_ptr->n_wavebufs)) {
+        *underrun = true;
+    }
 
-        if (ticks_to_process > 0) {
-            for (int i = 0; i < ticks_to_process; i++) {
-                processSequencerTick();
-            }
+    bool any_audible = false;
+    for (int i = 0; i < N_TRACKS && !any_audible; i++) {
+        any_audible = !trackBlockIsSilent(&s_tracks_ptr[i], &s_schedules[i]);
+    }
+    if (!any_audible) {
+        mixBusSubmitSilence(s_mix_bus_ptr, s_silence_buffer);
+        for (int i = 0; i < N_TRACKS; i++) {
+            skipTrackBlock(&s_tracks_ptr[i], &s_schedules[i]);
+        }
+        return true;
+    }
+
+    size_t size    = s_mix_bus_ptr->samples_per_buf;
+    float *mix_buf = mixBusBegin(s_mix_bus_ptr);
+
+    for (int i = 0; i < N_TRACKS; i++) {
+        u64 start = svcGetSystemTick();
+        renderTrackBlock(&s_tracks_ptr[i], &s_schedules[i], mix_buf, size, applyStepEvent,
+                         mixTrackSegment);
+        audioStatsRecord(&g_audio_stats, STAGE_TRACK_0 + i, svcGetSystemTick() - start);
+    }
+
+    u64 start = svcGetSystemTick();
+    mixBusSubmit(s_mix_bus_ptr);
+    audioStatsRecord(&g_audio_stats, STAGE_MIX_BUS, svcGetSystemTick() - start);
+    return true;
+}
+
+// Renders the next block of every track whose wavebuf has come back. Returns false when there
+// was nothing to render. Sets *underrun if a channel had run dry.
+static bool renderTracks(bool *underrun) {
+    bool rendered = false;
+
+    for (int i = 0; i < N_TRACKS; i++) {
+        if (s_tracks_ptr[i].filter.update_params) {
+            updateNdspbiquad(s_tracks_ptr[i].filter);
+            s_tracks_ptr[i].filter.update_params = false;
         }
 
-        temp_display.bar           = s_clock_ptr->barBeats->bar;
-        temp_display.beat          = s_clock_ptr->barBeats->beat;
-        temp_display.bpm           = s_clock_ptr->bpm;
-        temp_display.status        = s_clock_ptr->status;
-        temp_display.beats_per_bar = s_clock_ptr->barBeats->beats_per_bar;
-        if (s_tracks_ptr && s_tracks_ptr[0].sequencer) {
-            temp_display.cur_step = s_tracks_ptr[0].sequencer->cur_step;
+        Track       *track   = &s_tracks_ptr[i];
+        ndspWaveBuf *waveBuf = &track->waveBuf[track->fillBlock];
+
+        if (waveBuf->status != NDSP_WBUF_DONE ||
+            s_schedules[i].rendered_blocks == s_scheduled_blocks) {
+            continue;
+        }
+        if (waveBufsStarved(track->waveBuf, track->n_wavebufs)) {
+            *underrun = true;
+        }
+
+        u64  start = svcGetSystemTick();
+        u32 *dest  = &track->audioBuffer[track->fillBlock * waveBuf->nsamples];
+        if (renderTrackBlock(track, &s_schedules[i], dest, waveBuf->nsamples, applyStepEvent,
+                             renderTrackSegment)) {
+            waveBuf->data_vaddr = dest;
+            DSP_FlushDataCache(dest, waveBuf->nsamples * BYTESPERSAMPLE);
+            audioStatsRecord(&g_audio_stats, STAGE_TRACK_0 + i, svcGetSystemTick() - start);
         } else {
-            temp_display.cur_step = 0;
+            // Nothing rendered or flushed: queue the shared silence buffer instead
+            waveBuf->data_vaddr = s_silence_buffer;
         }
-        LightLock_Unlock(s_clock_lock_ptr);
 
-        LightLock_Lock(&g_clock_display_lock);
-        g_clock_display = temp_display;
-        LightLock_Unlock(&g_clock_display_lock);
+        ndspChnWaveBufAdd(track->chan_id, waveBuf);
+        track->fillBlock = (track->fillBlock + 1) % track->n_wavebufs;
+        rendered         = true;
+    }
+    return rendered;
+}
+
+static void audio_thread_entry(void *arg) {
+    while (1) {
+        LightEvent_Wait(&s_audio_event);
+        if (*s_should_exit_ptr) {
+            break;
+        }
+        u64 wake_start = svcGetSystemTick();
+        audioStatsBeginWrite(&g_audio_stats);
 
         Event event;
         while (eventQueuePop(s_event_queue_ptr, &event)) {
@@ -113,91 +256,10 @@ static void audio_thread_entry(void *arg) {
             }
             case TRIGGER_STEP:
             case UPDATE_STEP: {
-                Track *track = &s_tracks_ptr[event.track_id];
-                if (!track)
-                    break;
-                updateTrackParameters(track, &event.data.step_data.base_params);
-
-                if (event.data.step_data.instrument_type == SUB_SYNTH) {
-                    SubSynthParameters *subsynthParams =
-                        &event.data.step_data.instrument_specific_params.subsynth_params;
-                    SubSynth *ss = (SubSynth *) track->instrument_data;
-                    if (subsynthParams && ss) {
-                        updateEnvelope(ss->env, subsynthParams->env_atk, subsynthParams->env_dec,
-                                       subsynthParams->env_sus_level, subsynthParams->env_rel,
-                                       subsynthParams->env_dur);
-                        setWaveform(ss->osc, subsynthParams->osc_waveform);
-                        setPulseWidth(ss->osc, subsynthParams->pulse_width);
-                        setOscFrequency(ss->osc, subsynthParams->osc_freq);
-                        if (event.type == TRIGGER_STEP) {
-                            triggerEnvelope(ss->env);
-                        }
-                    }
-                } else if (event.data.step_data.instrument_type == OPUS_SAMPLER) {
-                    OpusSamplerParameters *opusSamplerParams =
-                        &event.data.step_data.instrument_specific_params.sampler_params;
-                    Sampler *s = (Sampler *) track->instrument_data;
-                    if (opusSamplerParams && s) {
-                        updateEnvelope(s->env, opusSamplerParams->env_atk,
-                                       opusSamplerParams->env_dec, opusSamplerParams->env_sus_level,
-                                       opusSamplerParams->env_rel, opusSamplerParams->env_dur);
-                        Sample *new_sample =
-                            SampleBankGetSample(s_sample_bank_ptr, opusSamplerParams->sample_index);
-                        if (new_sample != s->sample) {
-                            sample_inc_ref(new_sample);
-                            sample_dec_ref_audio_thread(s->sample);
-                            s->sample = new_sample;
-                        }
-                        s->start_position = opusSamplerParams->start_position;
-                        s->playback_mode  = opusSamplerParams->playback_mode;
-                        s->current_frame  = s->start_position / NCHANNELS;
-                        s->finished       = false;
-                        if (event.type == TRIGGER_STEP) {
-                            triggerEnvelope(s->env);
-                        }
-                    }
-                } else if (event.data.step_data.instrument_type == FM_SYNTH) {
-                    FMSynthParameters *fmSynthParams =
-                        &event.data.step_data.instrument_specific_params.fm_synth_params;
-                    FMSynth *fs = (FMSynth *) track->instrument_data;
-                    if (fmSynthParams && fs) {
-                        updateEnvelope(fs->carrierEnv, fmSynthParams->carrier_env_atk,
-                                       fmSynthParams->carrier_env_dec,
-                                       fmSynthParams->carrier_env_sus_level,
-                                       fmSynthParams->carrier_env_rel, fmSynthParams->env_dur);
-                        updateEnvelope(fs->fm_op->mod_envelope, fmSynthParams->mod_env_atk,
-                                       fmSynthParams->mod_env_dec, fmSynthParams->mod_env_sus_level,
-                                       fmSynthParams->mod_env_rel, fmSynthParams->env_dur);
-                        FMOpSetCarrierFrequency(fs->fm_op, fmSynthParams->carrier_freq);
-                        FMOpSetModRatio(fs->fm_op, fmSynthParams->mod_freq_ratio);
-                        FMOpSetModIndex(fs->fm_op, fmSynthParams->mod_index);
-                        FMOpSetModDepth(fs->fm_op, fmSynthParams->mod_depth);
-                        if (event.type == TRIGGER_STEP) {
-                            triggerEnvelope(fs->carrierEnv);
-                            triggerEnvelope(fs->fm_op->mod_envelope);
-                        }
-                    }
-                } else if (event.data.step_data.instrument_type == NOISE_SYNTH) {
-                    NoiseSynthParameters *noiseSynthParams =
-                        &event.data.step_data.instrument_specific_params.noise_synth_params;
-                    NoiseSynth *ns = (NoiseSynth *) track->instrument_data;
-                    if (noiseSynthParams && ns) {
-                        updateEnvelope(ns->env, noiseSynthParams->env_atk,
-                                       noiseSynthParams->env_dec, noiseSynthParams->env_sus_level,
-                                       noiseSynthParams->env_rel, noiseSynthParams->env_dur);
-                        if (event.type == TRIGGER_STEP) {
-                            triggerEnvelope(ns->env);
-                        }
-                    }
-                }
-                break;
-            }
-            case TOGGLE_STEP: {
-                Track *track = &s_tracks_ptr[event.track_id];
-                if (track && track->sequencer && event.data.toggle_step_data.step_id < 16) {
-                    track->sequencer->steps[event.data.toggle_step_data.step_id].active =
-                        !track->sequencer->steps[event.data.toggle_step_data.step_id].active;
-                }
+                applyStepEvent(&s_tracks_ptr[event.track_id],
+                               eventQueuePayload(s_event_queue_ptr, &event),
+                               event.type == TRIGGER_STEP);
+                eventQueueReleasePayload(s_event_queue_ptr, &event);
                 break;
             }
             case SET_MUTE: {
@@ -208,45 +270,35 @@ static void audio_thread_entry(void *arg) {
                 break;
             }
             case RESET_SEQUENCERS: {
-                LightLock_Lock(s_clock_lock_ptr);
                 for (int i = 0; i < N_TRACKS; i++) {
                     if (s_tracks_ptr[i].sequencer) {
                         s_tracks_ptr[i].sequencer->cur_step = 0;
                     }
                 }
-                LightLock_Unlock(s_clock_lock_ptr);
                 break;
             }
 
             case START_CLOCK:
-                LightLock_Lock(s_clock_lock_ptr);
                 startClock(s_clock_ptr);
-                LightLock_Unlock(s_clock_lock_ptr);
+                resetStepScheduler();
                 break;
             case STOP_CLOCK:
-                LightLock_Lock(s_clock_lock_ptr);
                 stopClock(s_clock_ptr);
-                LightLock_Unlock(s_clock_lock_ptr);
                 break;
             case PAUSE_CLOCK:
-                LightLock_Lock(s_clock_lock_ptr);
                 pauseClock(s_clock_ptr);
-                LightLock_Unlock(s_clock_lock_ptr);
                 break;
             case RESUME_CLOCK:
-                LightLock_Lock(s_clock_lock_ptr);
                 resumeClock(s_clock_ptr);
-                LightLock_Unlock(s_clock_lock_ptr);
                 break;
             case SET_BPM:
-                LightLock_Lock(s_clock_lock_ptr);
                 setBpm(s_clock_ptr, event.data.bpm_data.bpm);
-                LightLock_Unlock(s_clock_lock_ptr);
                 break;
             case SET_BEATS_PER_BAR:
-                LightLock_Lock(s_clock_lock_ptr);
                 setBeatsPerBar(s_clock_ptr, event.data.beats_data.beats);
-                LightLock_Unlock(s_clock_lock_ptr);
+                break;
+            case SET_LATENCY_PROFILE:
+                applyLatencyProfile(event.data.latency_data.profile);
                 break;
             case SWAP_SAMPLE: {
                 int slot_id = event.data.swap_sample_data.slot_id;
@@ -271,34 +323,35 @@ static void audio_thread_entry(void *arg) {
             }
         }
 
-        for (int i = 0; i < N_TRACKS; i++) {
-            if (s_tracks_ptr[i].filter.update_params) {
-                updateNdspbiquad(s_tracks_ptr[i].filter);
-                s_tracks_ptr[i].filter.update_params = false;
-            }
-
-            ndspWaveBuf *waveBuf = &s_tracks_ptr[i].waveBuf[s_tracks_ptr[i].fillBlock];
-
-            if (waveBuf->status == NDSP_WBUF_DONE) {
-                if (s_tracks_ptr[i].instrument_type == SUB_SYNTH) {
-                    SubSynth *subsynth = (SubSynth *) s_tracks_ptr[i].instrument_data;
-                    fillSubSynthAudiobuffer(waveBuf, waveBuf->nsamples, subsynth);
-                } else if (s_tracks_ptr[i].instrument_type == OPUS_SAMPLER) {
-                    Sampler *sampler = (Sampler *) s_tracks_ptr[i].instrument_data;
-                    fillSamplerAudioBuffer(waveBuf, waveBuf->nsamples, sampler);
-                } else if (s_tracks_ptr[i].instrument_type == FM_SYNTH) {
-                    FMSynth *fm_synth = (FMSynth *) s_tracks_ptr[i].instrument_data;
-                    fillFMSynthAudiobuffer(waveBuf, waveBuf->nsamples, fm_synth);
-                } else if (s_tracks_ptr[i].instrument_type == NOISE_SYNTH) {
-                    NoiseSynth *noise_synth = (NoiseSynth *) s_tracks_ptr[i].instrument_data;
-                    fillNoiseSynthAudiobuffer(waveBuf, waveBuf->nsamples, noise_synth);
-                }
+        audioStatsRecord(&g_audio_stats, STAGE_EVENTS, svcGetSystemTick() - wake_start);
 
-                ndspChnWaveBufAdd(s_tracks_ptr[i].chan_id, waveBuf);
+        // The clock moves by rendered audio, one block at a time, rather than by wall time. Short
+        // blocks can come back several at once, so keep going until every channel is topped up.
+        bool underrun = false;
+        bool rendered;
+        do {
+            if (blockDue()) {
+                scheduleNextBlock();
+            }
+            rendered = s_mix_bus_ptr ? renderMixBus(&underrun) : renderTracks(&underrun);
+        } while (rendered);
 
-                s_tracks_ptr[i].fillBlock = !s_tracks_ptr[i].fillBlock;
+        // A channel ran dry: the blocks are too short for this load, step up one profile
+        if (underrun) {
+            g_audio_stats.underruns++;
+            if (s_latency_profile + 1 < LATENCY_PROFILE_COUNT) {
+                applyLatencyProfile(s_latency_profile + 1);
             }
         }
+
+        for (int i = 0; i < N_TRACKS; i++) {
+            g_audio_stats.skipped_blocks[i] = s_tracks_ptr[i].skipped_blocks;
+        }
+
+        u64 wake_end = svcGetSystemTick();
+        audioStatsRecord(&g_audio_stats, STAGE_WAKE, wake_end - wake_start);
+        audioStatsAddBusy(&g_audio_stats, wake_end - wake_start, wake_end);
+        audioStatsEndWrite(&g_audio_stats);
     }
 
     for (int i = 0; i < N_TRACKS; i++) {
@@ -312,15 +365,23 @@ static void audio_thread_entry(void *arg) {
 }
 
 s32 audioThreadInit(Track *tracks_ptr, EventQueue *event_queue_ptr, SampleBank *sample_bank_ptr,
-                    Clock *clock_ptr, LightLock *clock_lock_ptr, volatile bool *should_exit_ptr,
-                    s32 main_thread_prio) {
+                    MixBus *mix_bus_ptr, const u32 *silence_buffer, Clock *clock_ptr,
+                    volatile bool *should_exit_ptr, s32 main_thread_prio) {
     s_tracks_ptr       = tracks_ptr;
     s_event_queue_ptr  = event_queue_ptr;
     s_sample_bank_ptr  = sample_bank_ptr;
+    s_mix_bus_ptr      = mix_bus_ptr;
+    s_silence_buffer   = silence_buffer;
     s_clock_ptr        = clock_ptr;
-    s_clock_lock_ptr   = clock_lock_ptr;
     s_should_exit_ptr  = should_exit_ptr;
     s_main_thread_prio = main_thread_prio;
+
+    memset(s_schedules, 0, sizeof(s_schedules));
+    s_scheduled_blocks = 0;
+    resetStepScheduler();
+    audioStatsReset(&g_audio_stats);
+    applyLatencyProfile(DEFAULT_LATENCY_PROFILE);
+    publishClockDisplay();
     LightEvent_Init(&s_audio_event, RESET_ONESHOT);
     ndspSetCallback(audio_callback, NULL);
     return 0;
@@ -0,0 +1,95 @@
+#include "track_arena.h"
+#include "linear_region.h"
+#include "noise_synth.h"
+#include "samplers.h"
+#include "synth.h"
+#include "track_parameters.h"
+
+#include <string.h>
+
+static size_t instrumentSize(InstrumentType type) {
+    switch (type) {
+    case SUB_SYNTH:
+        return sizeof(SubSynth);
+    case OPUS_SAMPLER:
+        return sizeof(Sampler);
+    case FM_SYNTH:
+        return sizeof(FMSynth);
+    case NOISE_SYNTH:
+        return sizeof(NoiseSynth);
+    }
+    return 0;
+}
+
+// Reserves size bytes at the next aligned offset
+static size_t reserve(size_t *end, size_t size) {
+    size_t offset = (*end + CACHE_LINE_BYTES - 1) & ~(size_t) (CACHE_LINE_BYTES - 1);
+    *end          = offset + size;
+    return offset;
+}
+
+static void layoutTrackArena(TrackArena *arena) {
+    size_t end = 0;
+
+    arena->instrument = reserve(&end, instrumentSize(arena->type));
+    arena->osc        = arena->type == SUB_SYNTH ? reserve(&end, sizeof(PolyBLEPOscillator)) : 0;
+    arena->env        = arena->type != FM_SYNTH ? reserve(&end, sizeof(Envelope)) : 0;
+
+    arena->sequencer      = reserve(&end, sizeof(Sequencer));
+    arena->default_params = reserve(&end, sizeof(StepParameters));
+    arena->size           = reserve(&end, 0);
+}
+
+static void wireInstrument(TrackArena *arena) {
+    void     *instrument = trackArenaAt(arena, arena->instrument);
+    Envelope *env        = trackArenaAt(arena, arena->env);
+    switch (arena->type) {
+    case SUB_SYNTH:
+        ((SubSynth *) instrument)->osc = trackArenaAt(arena, arena->osc);
+        ((SubSynth *) instrument)->env = env;
+        break;
+    case OPUS_SAMPLER:
+        ((Sampler *) instrument)->env = env;
+        break;
+    case NOISE_SYNTH:
+        ((NoiseSynth *) instrument)->env = env;
+        break;
+    case FM_SYNTH:
+        break;
+    }
+}
+
+bool createTrackArena(TrackArena *arena, int track_id, InstrumentType type, size_t n_steps) {
+    if (!arena || n_steps == 0 || n_steps % 4 != 0) {
+        return false;
+    }
+    memset(arena, 0, sizeof(*arena));
+    arena->type    = type;
+    arena->n_steps = n_steps;
+    layoutTrackArena(arena);
+
+    arena->base = linearAllocTagged(LINEAR_TAG_INSTRUMENTS, arena->size);
+    if (!arena->base) {
+        return false;
+    }
+    memset(arena->base, 0, arena->size);
+    wireInstrument(arena);
+
+    StepParameters defaults = defaultStepParameters(track_id, type);
+    *(StepParameters *) trackArenaAt(arena, arena->default_params) = defaults;
+    if (!initSequencer(trackArenaAt(arena, arena->sequencer), n_steps, &defaults)) {
+        linearFreeTagged(LINEAR_TAG_INSTRUMENTS, arena->base);
+        arena->base = NULL;
+        return false;
+    }
+    return true;
+}
+
+void destroyTrackArena(TrackArena *arena) {
+    if (!arena || !arena->base) {
+        return;
+    }
+    cleanupSequencer(trackArenaAt(arena, arena->sequencer));
+    linearFreeTagged(LINEAR_TAG_INSTRUMENTS, arena->base);
+    arena->base = NULL;
+}
@@ -42,14 +42,23 @@ FMSynthParameters defaultFMSynthParameters() {
     params.mod_env_dec           = 300;
     params.mod_env_sus_level     = 0.8f;
     params.mod_env_rel           = 100;
-    params.mod_index             = 1.0f;
-    params.mod_depth             = 44.0f;
+    params.mod_index             = 0.25f;
+    params.mod_depth             = 50.0f;
     params.carrier_freq          = 220.0f;
     params.mod_freq_ratio        = 1.0f;
     params.mod_env_atk           = params.carrier_env_atk;
     params.mod_env_dec           = params.carrier_env_dec;
     params.mod_env_sus_level     = params.carrier_env_sus_level;
     params.mod_env_rel           = params.carrier_env_rel;
+    params.algorithm             = FM_ALGO_STACK;
+    params.feedback              = 0.0f;
+
+    const float ratios[FM_OPERATORS] = { 1.0f, 1.0f, 2.0f, 3.0f };
+    const float levels[FM_OPERATORS] = { 1.0f, 1.0f, 0.6f, 0.3f };
+    for (int op = 0; op < FM_OPERATORS; op++) {
+        params.op_ratio[op] = ratios[op];
+        params.op_level[op] = levels[op];
+    }
     return params;
 }
 
@@ -61,10 +70,32 @@ NoiseSynthParameters defaultNoiseSynthParameters() {
     params.env_sus_level = 0.6f;
     params.env_rel       = 50;
     params.env_dur       = 300;
+    params.mode          = NOISE_MODE_15BIT;
+    params.rate_div      = 1;
     return params;
 }
 
-TrackParameters defaultTrackParameters(int track_id, void *instrument_data) {
+InstrumentParameters defaultInstrumentParameters(InstrumentType type) {
+    InstrumentParameters params;
+    memset(&params, 0, sizeof(InstrumentParameters));
+    switch (type) {
+    case SUB_SYNTH:
+        params.subsynth_params = defaultSubSynthParameters();
+        break;
+    case OPUS_SAMPLER:
+        params.sampler_params = defaultOpusSamplerParameters();
+        break;
+    case FM_SYNTH:
+        params.fm_synth_params = defaultFMSynthParameters();
+        break;
+    case NOISE_SYNTH:
+        params.noise_synth_params = defaultNoiseSynthParameters();
+        break;
+    }
+    return params;
+}
+
+TrackParameters defaultTrackParameters(int track_id) {
     TrackParameters params;
     memset(&params, 0, sizeof(TrackParameters));
     params.track_id           = track_id;
@@ -72,8 +103,131 @@ TrackParameters defaultTrackParameters(int track_id, void *instrument_data) {
     params.pan                = 0.0f;    // -1 to 1, 0 is center
     params.ndsp_filter_cutoff = 8000.0f; // Default to 8000Hz cutoff
     params.ndsp_filter_type   = NDSP_BIQUAD_NONE;
+    params.svf_mode           = SVF_OFF;
+    params.svf_cutoff         = 2000.0f;
+    params.svf_resonance      = 0.2f;
+    params.svf_env_amount     = 0.0f;
+    params.svf_env_decay      = 200;
     params.is_muted           = false;
     params.is_soloed          = false;
-    params.instrument_data    = instrument_data;
     return params;
-};
\ No newline at end of file
+};
+
+StepParameters defaultStepParameters(int track_id, InstrumentType type) {
+    return (StepParameters) { .track      = defaultTrackParameters(track_id),
+                              .instrument = defaultInstrumentParameters(type) };
+}
+
+void copyStepField(StepParameters *dst, const StepParameters *src, InstrumentType type,
+                   StepField field) {
+    InstrumentParameters       *di = &dst->instrument;
+    const InstrumentParameters *si = &src->instrument;
+
+    switch (field) {
+    case STEP_FIELD_VOLUME:
+        dst->track.volume = src->track.volume;
+        break;
+    case STEP_FIELD_PAN:
+        dst->track.pan = src->track.pan;
+        break;
+    case STEP_FIELD_FILTER_CUTOFF:
+        dst->track.ndsp_filter_cutoff = src->track.ndsp_filter_cutoff;
+        break;
+    case STEP_FIELD_FILTER_TYPE:
+        dst->track.ndsp_filter_type = src->track.ndsp_filter_type;
+        break;
+    case STEP_FIELD_SVF_MODE:
+        dst->track.svf_mode = src->track.svf_mode;
+        break;
+    case STEP_FIELD_SVF_CUTOFF:
+        dst->track.svf_cutoff = src->track.svf_cutoff;
+        break;
+    case STEP_FIELD_SVF_RESONANCE:
+        dst->track.svf_resonance = src->track.svf_resonance;
+        break;
+    case STEP_FIELD_SVF_ENV_AMOUNT:
+        dst->track.svf_env_amount = src->track.svf_env_amount;
+        break;
+    case STEP_FIELD_SVF_ENV_DECAY:
+        dst->track.svf_env_decay = src->track.svf_env_decay;
+        break;
+    case STEP_FIELD_PULSE_WIDTH:
+        if (type == SUB_SYNTH) {
+            di->subsynth_params.pulse_width = si->subsynth_params.pulse_width;
+        }
+        break;
+    case STEP_FIELD_MOD_INDEX:
+        if (type == FM_SYNTH) {
+            di->fm_synth_params.mod_index = si->fm_synth_params.mod_index;
+        }
+        break;
+    case STEP_FIELD_MOD_DEPTH:
+        if (type == FM_SYNTH) {
+            di->fm_synth_params.mod_depth = si->fm_synth_params.mod_depth;
+        }
+        break;
+    case STEP_FIELD_START_POSITION:
+        if (type == OPUS_SAMPLER) {
+            di->sampler_params.start_position = si->sampler_params.start_position;
+        }
+        break;
+    case STEP_FIELD_NOTE:
+        if (type == SUB_SYNTH) {
+            di->subsynth_params.osc_freq = si->subsynth_params.osc_freq;
+        } else if (type == FM_SYNTH) {
+            di->fm_synth_params.carrier_freq = si->fm_synth_params.carrier_freq;
+        }
+        break;
+    case STEP_FIELD_MOD_RATIO:
+        if (type == FM_SYNTH) {
+            di->fm_synth_params.mod_freq_ratio = si->fm_synth_params.mod_freq_ratio;
+        }
+        break;
+    case STEP_FIELD_WAVEFORM:
+        if (type == SUB_SYNTH) {
+            di->subsynth_params.osc_waveform = si->subsynth_params.osc_waveform;
+        }
+        break;
+    case STEP_FIELD_FM_ALGORITHM:
+        if (type == FM_SYNTH) {
+            di->fm_synth_params.algorithm = si->fm_synth_params.algorithm;
+        }
+        break;
+    case STEP_FIELD_NOISE_MODE:
+        if (type == NOISE_SYNTH) {
+            di->noise_synth_params.mode = si->noise_synth_params.mode;
+        }
+        break;
+    case STEP_FIELD_PLAYBACK_MODE:
+        if (type == OPUS_SAMPLER) {
+            di->sampler_params.playback_mode = si->sampler_params.playback_mode;
+        }
+        break;
+    case STEP_FIELD_SAMPLE_INDEX:
+        if (type == OPUS_SAMPLER) {
+            di->sampler_params.sample_index = si->sampler_params.sample_index;
+        }
+        break;
+    case STEP_FIELD_ENV_DURATION:
+        if (type == SUB_SYNTH) {
+            di->subsynth_params.env_dur = si->subsynth_params.env_dur;
+        } else if (type == OPUS_SAMPLER) {
+            di->sampler_params.env_dur = si->sampler_params.env_dur;
+        } else if (type == FM_SYNTH) {
+            di->fm_synth_params.env_dur = si->fm_synth_params.env_dur;
+        } else if (type == NOISE_SYNTH) {
+            di->noise_synth_params.env_dur = si->noise_synth_params.env_dur;
+        }
+        break;
+    case STEP_FIELD_RATE_DIV:
+        if (type == NOISE_SYNTH) {
+            di->noise_synth_params.rate_div = si->noise_synth_params.rate_div;
+        }
+        break;
+    case STEP_FIELD_INSTRUMENT:
+        *di = *si;
+        break;
+    case STEP_FIELD_NONE:
+        break;
+    }
+}
@@ -0,0 +1,166 @@
+#include "track_render.h"
+#include "audio_utils.h"
+#include "clock.h"
+#include "engine_constants.h"
+#include "fm_osc.h"
+#include "instrument.h"
+#include "noise_synth.h"
+#include "param_smoother.h"
+#include "samplers.h"
+#include "svf.h"
+#include "synth.h"
+
+bool trackIsSilent(const Track *track) {
+    return instrumentIsSilent(track->instrument_type, track->instrument_data) &&
+           SVFIsSettled(&track->svf);
+}
+
+void updateTrackParameters(Track *track, const TrackParameters *params) {
+    if (!track || !params) {
+        return;
+    }
+
+    track->is_muted  = params->is_muted;
+    track->is_soloed = params->is_soloed;
+
+    // Volume and pan only touch the gains when they change, the render loop ramps to them
+    if (track->volume != params->volume || track->pan != params->pan) {
+        track->volume = params->volume;
+        track->pan    = params->pan;
+        float gain_l, gain_r;
+        panLawGains(track->pan, track->volume, &gain_l, &gain_r);
+        gainSmootherSetTarget(&track->gain, gain_l, gain_r);
+    }
+
+    // Filter
+    if (track->filter.filter_type != params->ndsp_filter_type ||
+        track->filter.cutoff_freq != params->ndsp_filter_cutoff) {
+        track->filter.filter_type   = params->ndsp_filter_type;
+        track->filter.cutoff_freq   = params->ndsp_filter_cutoff;
+        track->filter.update_params = true;
+    }
+    SVFSetParams(&track->svf, params->svf_mode, params->svf_cutoff, params->svf_resonance,
+                 params->svf_env_amount, params->svf_env_decay);
+}
+
+void scheduleStep(TrackSchedule *schedule, u32 block, u16 offset, InstrumentType type,
+                  const StepParameters *params) {
+    if (schedule->tail - schedule->head >= STEP_SCHEDULE_SIZE) {
+        return; // Full: drop the step rather than overwrite one that has not sounded yet
+    }
+    ScheduledStep *step = &schedule->steps[schedule->tail % STEP_SCHEDULE_SIZE];
+    step->block         = block;
+    step->offset        = offset;
+    step->payload       = (StepPayload) { .instrument_type = type, .params = *params };
+    schedule->tail++;
+}
+
+// Next step that sounds in the schedule's current block, or NULL
+static const ScheduledStep *nextStepInBlock(const TrackSchedule *schedule) {
+    if (schedule->head == schedule->tail) {
+        return NULL;
+    }
+    const ScheduledStep *step = &schedule->steps[schedule->head % STEP_SCHEDULE_SIZE];
+    return (s32) (step->block - schedule->rendered_blocks) <= 0 ? step : NULL;
+}
+
+// Applies a step's parameters to its track, retriggering the envelopes for a trigger. A sampler
+// step's sample index is left to the caller, who owns the bank.
+void applyTrackStep(Track *track, const StepPayload *step, bool trigger) {
+    if (!track || !track->instrument_data || !step) {
+        return;
+    }
+    updateTrackParameters(track, &step->params.track);
+    applyInstrumentStep(step->instrument_type, track->instrument_data, &step->params.instrument,
+                        trigger);
+    if (trigger) {
+        triggerSVF(&track->svf);
+    }
+}
+
+bool trackBlockIsSilent(const Track *track, const TrackSchedule *schedule) {
+    return !nextStepInBlock(schedule) && trackIsSilent(track);
+}
+
+void skipTrackBlock(Track *track, TrackSchedule *schedule) {
+    // What is left in the filter is below a sample, but would come back with the next trigger
+    clearSVFState(&track->svf);
+    schedule->rendered_blocks++;
+    track->skipped_blocks++;
+}
+
+bool renderTrackBlock(Track *track, TrackSchedule *schedule, void *dest, size_t n,
+                      StepApplyFn apply, RenderSegmentFn render) {
+    if (trackBlockIsSilent(track, schedule)) {
+        skipTrackBlock(track, schedule);
+        return false;
+    }
+
+    size_t               pos = 0;
+    const ScheduledStep *step;
+    while ((step = nextStepInBlock(schedule)) != NULL) {
+        // Steps left over from an earlier block go at the start of this one
+        size_t at = 0;
+        if (step->block == schedule->rendered_blocks) {
+            at = clockOffsetToFrames(step->offset, n);
+        }
+        if (at > pos) {
+            render(track, dest, pos, at - pos);
+            pos = at;
+        }
+        apply(track, &step->payload, true);
+        schedule->head++;
+    }
+    if (pos < n) {
+        render(track, dest, pos, n - pos);
+    }
+    schedule->rendered_blocks++;
+    return true;
+}
+
+void renderTrackSegment(Track *track, void *dest, size_t pos, size_t n) {
+    u32 *frames = &((u32 *) dest)[pos];
+    renderInstrumentAudio(track->instrument_type, track->instrument_data, frames, n);
+    if (!SVFIsBypassed(&track->svf)) {
+        processSVFFrames(&track->svf, frames, n);
+    }
+    applyGainSmoother(&track->gain, frames, n);
+}
+
+// The filter needs the instrument's frames before the gains, and a gain ramp changes the gains
+// every frame, so those tracks are rendered in chunks and summed here instead of by their
+// instrument's mix function
+static void mixTrackChunks(Track *track, float *mix_buf, size_t n) {
+    u32 chunk[RENDER_CHUNK];
+    for (size_t pos = 0; pos < n; pos += RENDER_CHUNK) {
+        size_t len = (n - pos < RENDER_CHUNK) ? n - pos : RENDER_CHUNK;
+        renderInstrumentAudio(track->instrument_type, track->instrument_data, chunk, len);
+        processSVFFrames(&track->svf, chunk, len);
+        mixGainSmoother(&track->gain, &mix_buf[pos * NCHANNELS], chunk, len);
+    }
+}
+
+void mixTrackSegment(Track *track, void *dest, size_t pos, size_t n) {
+    float *mix_buf = &((float *) dest)[pos * NCHANNELS];
+    float  gain_l  = track->gain.gain[0];
+    float  gain_r  = track->gain.gain[1];
+    if (trackIsSilent(track)) {
+        return; // Nothing to add, the bus is already zeroed
+    }
+
+    if (!SVFIsBypassed(&track->svf) || gainSmootherIsRamping(&track->gain)) {
+        mixTrackChunks(track, mix_buf, n);
+    } else if (track->instrument_type == SUB_SYNTH) {
+        SubSynth *subsynth = (SubSynth *) track->instrument_data;
+        mixSubSynthAudiobuffer(mix_buf, n, subsynth, gain_l, gain_r);
+    } else if (track->instrument_type == OPUS_SAMPLER) {
+        Sampler *sampler = (Sampler *) track->instrument_data;
+        mixSamplerAudioBuffer(mix_buf, n, sampler, gain_l, gain_r);
+    } else if (track->instrument_type == FM_SYNTH) {
+        FMSynth *fm_synth = (FMSynth *) track->instrument_data;
+        mixFMSynthAudiobuffer(mix_buf, n, fm_synth, gain_l, gain_r);
+    } else if (track->instrument_type == NOISE_SYNTH) {
+        NoiseSynth *noise_synth = (NoiseSynth *) track->instrument_data;
+        mixNoiseSynthAudiobuffer(mix_buf, n, noise_synth, gain_l, gain_r);
+    }
+}
@@ -1,4 +1,5 @@
 #include "ui/ui.h"
+#include "audio_stats.h"
 #include "clock.h"
 #include "engine_constants.h"
 #include "session.h"
@@ -14,11 +15,9 @@ static void drawBorder(float x, float y, float w, float h, u32 color) {
 }
 
 static void drawClockSettingsCommon(int selected_option, float screen_width) {
-    LightLock_Lock(&g_clock_display_lock);
-    ClockDisplay clock_display = g_clock_display;
-    LightLock_Unlock(&g_clock_display_lock);
+    ClockDisplay clock_display = clockDisplayRead(&g_clock_display);
 
-    const char *options[]   = { "BPM", "Beats per Bar", "Back" };
+    const char *options[]   = { "BPM", "Beats per Bar", "Latency", "Back" };
     int         num_options = sizeof(options) / sizeof(options[0]);
 
     // Menu box
@@ -41,6 +40,9 @@ static void drawClockSettingsCommon(int selected_option, float screen_width) {
             snprintf(text, sizeof(text), "%s %.0f", options[i], clock_display.bpm);
         } else if (i == 1) {
             snprintf(text, sizeof(text), "%s %d", options[i], clock_display.beats_per_bar);
+        } else if (i == 2) {
+            snprintf(text, sizeof(text), "%s %s", options[i],
+                     latency_profiles[clock_display.latency_profile].name);
         } else {
             snprintf(text, sizeof(text), "%s", options[i]);
         }
@@ -152,6 +154,71 @@ void drawTouchScreenSettingsView(int selected_option, ScreenFocus focus) {
     }
 }
 
+static void drawStatsLine(const char *text, float x, float y, u32 color) {
+    C2D_TextBufClear(text_buf);
+    C2D_TextFontParse(&text_obj, font_angular, text_buf, text);
+    C2D_TextOptimize(&text_obj);
+    C2D_DrawText(&text_obj, C2D_WithColor, x, y, 0.0f, TEXT_SCALE_TINY, TEXT_SCALE_TINY, color);
+}
+
+// Audio thread timings in microseconds: p50 / p99 / max per stage, against the block deadline
+void drawAudioStatsOverlay(void) {
+    static AudioStats stats;
+    if (!audioStatsSnapshot(&g_audio_stats, &stats)) {
+        return; // Keep the last frame's numbers rather than show a torn copy
+    }
+
+    float x = 4, y = 4, line = 10;
+    C2D_DrawRectangle(0, 0, 0, 190, 8 + line * (AUDIO_STAGE_COUNT + 3), C2D_Color32(0, 0, 0, 192),
+                      C2D_Color32(0, 0, 0, 192), C2D_Color32(0, 0, 0, 192),
+                      C2D_Color32(0, 0, 0, 192));
+
+    char text[64];
+    snprintf(text, sizeof(text), "Load %u.%u%%  Underruns %lu  Block %lu us",
+             (unsigned) (stats.load_permille / 10), (unsigned) (stats.load_permille % 10),
+             (unsigned long) stats.underruns, (unsigned long) statsTicksToUs(stats.block_ticks));
+    drawStatsLine(text, x, y, stats.underruns ? CLR_RED : CLR_WHITE);
+    y += line;
+    int len = snprintf(text, sizeof(text), "Skipped");
+    for (int i = 0; i < N_TRACKS; i++) {
+        len += snprintf(&text[len], sizeof(text) - len, " %lu",
+                        (unsigned long) stats.skipped_blocks[i]);
+    }
+    drawStatsLine(text, x, y, CLR_LIGHT_GRAY);
+    y += line;
+    drawStatsLine("Stage        p50     p99     max", x, y, CLR_LIGHT_GRAY);
+    y += line;
+
+    for (int stage = 0; stage < AUDIO_STAGE_COUNT; stage++) {
+        const StageHistogram *hist = &stats.stages[stage];
+        if (hist->count == 0) {
+            continue;
+        }
+
+        char label[16];
+        if (stage == STAGE_EVENTS) {
+            snprintf(label, sizeof(label), "Events");
+        } else if (stage == STAGE_SEQUENCER) {
+            snprintf(label, sizeof(label), "Sequencer");
+        } else if (stage == STAGE_MIX_BUS) {
+            snprintf(label, sizeof(label), "Mix bus");
+        } else if (stage == STAGE_WAKE) {
+            snprintf(label, sizeof(label), "Total");
+        } else {
+            snprintf(label, sizeof(label), "Track %d", stage - STAGE_TRACK_0 + 1);
+        }
+
+        u32 max = hist->max;
+        snprintf(text, sizeof(text), "%-10s %6lu  %6lu  %6lu", label,
+                 (unsigned long) statsTicksToUs(statsPercentile(hist, 50)),
+                 (unsigned long) statsTicksToUs(statsPercentile(hist, 99)),
+                 (unsigned long) statsTicksToUs(max));
+        // A wake-up longer than a block has missed its deadline
+        drawStatsLine(text, x, y, max > stats.block_ticks ? CLR_RED : CLR_WHITE);
+        y += line;
+    }
+}
+
 void drawTouchClockSettingsView(int selected_option) {
     drawClockSettingsCommon(selected_option, (float) BOTTOM_SCREEN_WIDTH);
 }
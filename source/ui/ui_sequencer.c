@@ -56,9 +56,7 @@ static const char *get_status_symbol(ClockStatus status) {
 }
 
 void drawTrackbar(Track *tracks) {
-    LightLock_Lock(&g_clock_display_lock);
-    ClockDisplay clock_display = g_clock_display;
-    LightLock_Unlock(&g_clock_display_lock);
+    ClockDisplay clock_display = clockDisplayRead(&g_clock_display);
 
     float track_height = SCREEN_HEIGHT / 13;
     for (int i = 0; i < N_TRACKS + 1; i++) {
@@ -152,8 +150,12 @@ void drawTracksSequencers(Track *tracks, int cur_step) {
     float track_height = SCREEN_HEIGHT / 13;
     for (int i = 0; i < N_TRACKS; i++) {
         if (tracks[i].sequencer) {
+            // Steps past the end keep their bits for when the pattern grows again
+            const Pattern *pattern = tracks[i].sequencer->edit;
+            size_t         n_steps = patternLength(pattern);
             for (int j = 0; j < 16; j++) {
-                u32   color = tracks[i].sequencer->steps[j].active ? CLR_LIGHT_GRAY : CLR_DARK_GRAY;
+                bool  active = (size_t) j < n_steps && patternStepActive(pattern, j);
+                u32   color  = active ? CLR_LIGHT_GRAY : CLR_DARK_GRAY;
                 float x =
                     HOME_TRACKS_WIDTH + HOME_STEPS_SPACER_W * (j + 1) + HOME_STEPS_HEADER_W * j;
                 float y = (i + 1) * track_height;
@@ -210,15 +212,13 @@ static void drawSelectionOverlay(int row, int col, bool is_focused) {
 }
 
 void drawMainView(Track *tracks, int selected_row, int selected_col, ScreenFocus focus) {
-    LightLock_Lock(&g_clock_display_lock);
-    ClockDisplay clock_display = g_clock_display;
-    LightLock_Unlock(&g_clock_display_lock);
+    ClockDisplay clock_display = clockDisplayRead(&g_clock_display);
 
     int cur_step       = clock_display.cur_step;
     int steps_per_beat = 4; // Default value, will be updated if tracks[0].sequencer exists
 
     if (tracks && tracks[0].sequencer) {
-        steps_per_beat = tracks[0].sequencer->steps_per_beat;
+        steps_per_beat = tracks[0].sequencer->edit->steps_per_beat;
     }
 
     drawStepsBar(cur_step, steps_per_beat);
@@ -20,7 +20,7 @@ extern C2D_Text    text_obj;
 
 static const char *playback_mode_names[] = { "One Shot", "Loop" };
 
-int generateParameterList(Track *track, TrackParameters *params, SampleBank *sample_bank,
+int generateParameterList(Track *track, const StepParameters *params, SampleBank *sample_bank,
                           ParameterInfo *list_buffer, int max_params) {
     int id = 0;
 
@@ -31,7 +31,7 @@ int generateParameterList(Track *track, TrackParameters *params, SampleBank *sam
                                         .row_in_column = 0,
                                         .type          = PARAM_TYPE_FLOAT_0_1 };
     snprintf(list_buffer[id].value_string, sizeof(list_buffer[id].value_string), "%.2f",
-             params->volume);
+             params->track.volume);
     id++;
 
     list_buffer[id] = (ParameterInfo) { .label         = "Pan",
@@ -40,7 +40,7 @@ int generateParameterList(Track *track, TrackParameters *params, SampleBank *sam
                                         .row_in_column = 1,
                                         .type          = PARAM_TYPE_FLOAT_N1_1 };
     snprintf(list_buffer[id].value_string, sizeof(list_buffer[id].value_string), "%.2f",
-             params->pan);
+             params->track.pan);
     id++;
 
     list_buffer[id] = (ParameterInfo) { .label         = "Filter Cf",
@@ -49,7 +49,7 @@ int generateParameterList(Track *track, TrackParameters *params, SampleBank *sam
                                         .row_in_column = 2,
                                         .type          = PARAM_TYPE_HZ };
     snprintf(list_buffer[id].value_string, sizeof(list_buffer[id].value_string), "%.0f",
-             params->ndsp_filter_cutoff);
+             params->track.ndsp_filter_cutoff);
     id++;
 
     list_buffer[id] = (ParameterInfo) { .label         = "Filter Type",
@@ -57,7 +57,7 @@ int generateParameterList(Track *track, TrackParameters *params, SampleBank *sam
                                         .column        = 0,
                                         .row_in_column = 3,
                                         .type          = PARAM_TYPE_FILTER_TYPE };
-    int filter_type = params->ndsp_filter_type;
+    int filter_type = params->track.ndsp_filter_type;
     if (filter_type < 0 || filter_type >= 6) {
         filter_type = 0;
     }
@@ -65,13 +65,23 @@ int generateParameterList(Track *track, TrackParameters *params, SampleBank *sam
              ndsp_biquad_filter_names[filter_type]);
     id++;
 
+    list_buffer[id] = (ParameterInfo) { .label         = "SVF",
+                                        .unique_id     = id,
+                                        .column        = 0,
+                                        .row_in_column = 4,
+                                        .type          = PARAM_TYPE_SVF_BUTTON };
+    int svf_mode    = params->track.svf_mode;
+    if (svf_mode < 0 || svf_mode >= SVF_MODE_COUNT) {
+        svf_mode = SVF_OFF;
+    }
+    snprintf(list_buffer[id].value_string, sizeof(list_buffer[id].value_string), "%s",
+             svf_mode_names[svf_mode]);
+    id++;
+
     // Column 1: Instrument-specific Parameters
     switch (track->instrument_type) {
     case SUB_SYNTH: {
-        SubSynthParameters *synth_params = (SubSynthParameters *) params->instrument_data;
-        if (!synth_params) {
-            break;
-        }
+        const SubSynthParameters *synth_params = &params->instrument.subsynth_params;
         list_buffer[id] = (ParameterInfo) { .label         = "MIDI Note",
                                             .unique_id     = id,
                                             .column        = 1,
@@ -122,23 +132,20 @@ int generateParameterList(Track *track, TrackParameters *params, SampleBank *sam
         break;
     }
     case FM_SYNTH: {
-        FMSynthParameters *fm_params = (FMSynthParameters *) params->instrument_data;
-        if (!fm_params) {
-            break;
-        }
+        const FMSynthParameters *fm_params = &params->instrument.fm_synth_params;
         list_buffer[id] = (ParameterInfo) { .label         = "Mod Depth",
                                             .unique_id     = id,
                                             .column        = 0,
-                                            .row_in_column = 4,
+                                            .row_in_column = 5,
                                             .type          = PARAM_TYPE_FLOAT_0_1 };
-        snprintf(list_buffer[id].value_string, sizeof(list_buffer[id].value_string), "%.2f",
+        snprintf(list_buffer[id].value_string, sizeof(list_buffer[id].value_string), "%.0f",
                  fm_params->mod_depth);
         id++;
 
         list_buffer[id] = (ParameterInfo) { .label         = "Mod Index",
                                             .unique_id     = id,
                                             .column        = 0,
-                                            .row_in_column = 5,
+                                            .row_in_column = 6,
                                             .type          = PARAM_TYPE_FLOAT_0_1 };
         snprintf(list_buffer[id].value_string, sizeof(list_buffer[id].value_string), "%.1f",
                  fm_params->mod_index);
@@ -186,13 +193,19 @@ int generateParameterList(Track *track, TrackParameters *params, SampleBank *sam
         snprintf(list_buffer[id].value_string, sizeof(list_buffer[id].value_string), "%d",
                  fm_params->env_dur);
         id++;
+
+        list_buffer[id] = (ParameterInfo) { .label         = "Algorithm",
+                                            .unique_id     = id,
+                                            .column        = 1,
+                                            .row_in_column = 5,
+                                            .type          = PARAM_TYPE_FM_ALGORITHM };
+        snprintf(list_buffer[id].value_string, sizeof(list_buffer[id].value_string), "%s",
+                 fm_algorithm_names[fm_params->algorithm]);
+        id++;
         break;
     }
     case OPUS_SAMPLER: {
-        OpusSamplerParameters *sampler_params = (OpusSamplerParameters *) params->instrument_data;
-        if (!sampler_params) {
-            break;
-        }
+        const OpusSamplerParameters *sampler_params = &params->instrument.sampler_params;
         list_buffer[id] = (ParameterInfo) { .label         = "Sample",
                                             .unique_id     = id,
                                             .column        = 1,
@@ -244,10 +257,7 @@ int generateParameterList(Track *track, TrackParameters *params, SampleBank *sam
         break;
     }
     case NOISE_SYNTH: {
-        NoiseSynthParameters *noise_params = (NoiseSynthParameters *) params->instrument_data;
-        if (!noise_params) {
-            break;
-        }
+        const NoiseSynthParameters *noise_params = &params->instrument.noise_synth_params;
         list_buffer[id] = (ParameterInfo) { .label         = "Envelope",
                                             .unique_id     = id,
                                             .column        = 1,
@@ -264,6 +274,24 @@ int generateParameterList(Track *track, TrackParameters *params, SampleBank *sam
         snprintf(list_buffer[id].value_string, sizeof(list_buffer[id].value_string), "%d",
                  noise_params->env_dur);
         id++;
+
+        list_buffer[id] = (ParameterInfo) { .label         = "Mode",
+                                            .unique_id     = id,
+                                            .column        = 1,
+                                            .row_in_column = 2,
+                                            .type          = PARAM_TYPE_NOISE_MODE };
+        snprintf(list_buffer[id].value_string, sizeof(list_buffer[id].value_string), "%s",
+                 noise_mode_names[noise_params->mode]);
+        id++;
+
+        list_buffer[id] = (ParameterInfo) { .label         = "Rate Div",
+                                            .unique_id     = id,
+                                            .column        = 1,
+                                            .row_in_column = 3,
+                                            .type          = PARAM_TYPE_INT };
+        snprintf(list_buffer[id].value_string, sizeof(list_buffer[id].value_string), "%d",
+                 noise_params->rate_div);
+        id++;
         break;
     }
     }
@@ -293,14 +321,16 @@ void drawStepSettingsView(Session *session, Track *tracks, int selected_row, int
     int    track_idx = selected_row - 1;
     Track *track     = &tracks[track_idx];
 
-    TrackParameters *params;
-    bool             is_all_steps = (selected_col == 0);
+    const StepParameters *params;
+    bool                  is_all_steps = (selected_col == 0);
 
     if (is_all_steps) {
         params = track->default_parameters;
     } else {
-        int step_idx = selected_col - 1;
-        params       = track->sequencer->steps[step_idx].data;
+        params = patternStepParams(track->sequencer->edit, selected_col - 1);
+        if (!params) {
+            params = track->default_parameters;
+        }
     }
 
     ParameterInfo param_list[MAX_VIEW_PARAMS];
@@ -333,7 +363,7 @@ void drawStepSettingsView(Session *session, Track *tracks, int selected_row, int
     if (is_all_steps) {
         is_active = !track->is_muted;
     } else {
-        is_active = track->sequencer->steps[selected_col - 1].active;
+        is_active = patternStepActive(track->sequencer->edit, selected_col - 1);
     }
 
     if (is_active) {
@@ -402,8 +432,9 @@ void drawStepSettingsView(Session *session, Track *tracks, int selected_row, int
                  CLR_LIGHT_GRAY);
 }
 
-void drawStepSettingsEditView(Track *track, TrackParameters *params, int selected_step_option,
-                              int selected_adsr_option, SampleBank *sample_bank) {
+void drawStepSettingsEditView(Track *track, const StepParameters *params,
+                              int selected_step_option, int selected_adsr_option,
+                              SampleBank *sample_bank) {
     C2D_DrawRectangle(0, 0, 0, TOP_SCREEN_WIDTH, SCREEN_HEIGHT, C2D_Color32(0, 0, 0, 128),
                       C2D_Color32(0, 0, 0, 128), C2D_Color32(0, 0, 0, 128),
                       C2D_Color32(0, 0, 0, 128));
@@ -448,38 +479,32 @@ void drawStepSettingsEditView(Track *track, TrackParameters *params, int selecte
             char        value_str[4][16];
 
             if (track->instrument_type == SUB_SYNTH) {
-                SubSynthParameters *synth_params = (SubSynthParameters *) params->instrument_data;
-                values[0]                        = synth_params->env_atk;
-                values[1]                        = synth_params->env_dec;
-                values[2]                        = synth_params->env_sus_level;
-                values[3]                        = synth_params->env_rel;
+                const SubSynthParameters *synth_params = &params->instrument.subsynth_params;
+                values[0]                              = synth_params->env_atk;
+                values[1]                              = synth_params->env_dec;
+                values[2]                              = synth_params->env_sus_level;
+                values[3]                              = synth_params->env_rel;
             } else if (track->instrument_type == FM_SYNTH) {
-                FMSynthParameters *fm_synth_params = (FMSynthParameters *) params->instrument_data;
-                if (!fm_synth_params) {
-                    values[0] = values[1] = values[2] = values[3] = 0;
-                } else {
-                    if (strcmp(param_to_edit->label, "Car Env") == 0) {
-                        values[0] = fm_synth_params->carrier_env_atk;
-                        values[1] = fm_synth_params->carrier_env_dec;
-                        values[2] = fm_synth_params->carrier_env_sus_level;
-                        values[3] = fm_synth_params->carrier_env_rel;
-                    } else { // Modulator Envelope
-                        values[0] = fm_synth_params->mod_env_atk;
-                        values[1] = fm_synth_params->mod_env_dec;
-                        values[2] = fm_synth_params->mod_env_sus_level;
-                        values[3] = fm_synth_params->mod_env_rel;
-                    }
+                const FMSynthParameters *fm_synth_params = &params->instrument.fm_synth_params;
+                if (strcmp(param_to_edit->label, "Car Env") == 0) {
+                    values[0] = fm_synth_params->carrier_env_atk;
+                    values[1] = fm_synth_params->carrier_env_dec;
+                    values[2] = fm_synth_params->carrier_env_sus_level;
+                    values[3] = fm_synth_params->carrier_env_rel;
+                } else { // Modulator Envelope
+                    values[0] = fm_synth_params->mod_env_atk;
+                    values[1] = fm_synth_params->mod_env_dec;
+                    values[2] = fm_synth_params->mod_env_sus_level;
+                    values[3] = fm_synth_params->mod_env_rel;
                 }
             } else if (track->instrument_type == NOISE_SYNTH) {
-                NoiseSynthParameters *noise_params =
-                    (NoiseSynthParameters *) params->instrument_data;
+                const NoiseSynthParameters *noise_params = &params->instrument.noise_synth_params;
                 values[0] = noise_params->env_atk;
                 values[1] = noise_params->env_dec;
                 values[2] = noise_params->env_sus_level;
                 values[3] = noise_params->env_rel;
             } else { // is_sampler
-                OpusSamplerParameters *sampler_params =
-                    (OpusSamplerParameters *) params->instrument_data;
+                const OpusSamplerParameters *sampler_params = &params->instrument.sampler_params;
                 values[0] = sampler_params->env_atk;
                 values[1] = sampler_params->env_dec;
                 values[2] = sampler_params->env_sus_level;
@@ -511,6 +536,44 @@ void drawStepSettingsEditView(Track *track, TrackParameters *params, int selecte
             }
             break;
         }
+        case PARAM_TYPE_SVF_BUTTON: {
+            // The mode goes unlabelled, its name says what it is
+            const TrackParameters *track_params = &params->track;
+            const char            *labels[]     = { "", "Cf", "Res", "Env", "Dec" };
+            char                   value_str[5][16];
+            int                    mode         = track_params->svf_mode;
+            if (mode < 0 || mode >= SVF_MODE_COUNT) {
+                mode = SVF_OFF;
+            }
+
+            snprintf(value_str[0], 16, "%s", svf_mode_names[mode]);
+            snprintf(value_str[1], 16, "%.0f", track_params->svf_cutoff);
+            snprintf(value_str[2], 16, "%.2f", track_params->svf_resonance);
+            snprintf(value_str[3], 16, "%+.1f", track_params->svf_env_amount);
+            snprintf(value_str[4], 16, "%d", track_params->svf_env_decay);
+
+            // Five fields to a line: smaller text than the envelope's four
+            float start_x = menu_x + 12;
+            for (int i = 0; i < 5; i++) {
+                C2D_Font current_font = (i == selected_adsr_option) ? font_heavy : font_angular;
+                u32      color        = (i == selected_adsr_option) ? CLR_YELLOW : CLR_WHITE;
+
+                C2D_TextBufClear(text_buf);
+                snprintf(text, sizeof(text), "%s%s%s", labels[i], labels[i][0] ? " " : "",
+                         value_str[i]);
+                C2D_TextFontParse(&text_obj, current_font, text_buf, text);
+                C2D_TextOptimize(&text_obj);
+
+                float text_width, text_height;
+                C2D_TextGetDimensions(&text_obj, TEXT_SCALE_SMALL, TEXT_SCALE_SMALL, &text_width,
+                                      &text_height);
+                float text_y = menu_y + (menu_height - text_height) / 2;
+                C2D_DrawText(&text_obj, C2D_WithColor, start_x, text_y, 0.0f, TEXT_SCALE_SMALL,
+                             TEXT_SCALE_SMALL, color);
+                start_x += text_width + 10;
+            }
+            break;
+        }
         case PARAM_TYPE_INT: {
             snprintf(text, sizeof(text), "%d", atoi(param_to_edit->value_string));
             C2D_TextFontParse(&text_obj, font_heavy, text_buf, text);
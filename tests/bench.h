@@ -0,0 +1,31 @@
+#ifndef BENCH_H
+#define BENCH_H
+
+#include "mock_3ds.h"
+
+#include <stdint.h>
+#include <time.h>
+
+// Host benchmark helpers. Benchmarks are built with optimisations (make bench) and are not part
+// of the unit test run.
+
+static inline uint64_t bench_now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t) ts.tv_sec * 1000000000ull + (uint64_t) ts.tv_nsec;
+}
+
+// Results that go into the JSON report (bench_runner --json path), for diffing runs across commits
+typedef struct {
+    const char *name;
+    u64         samples;
+    u64         elapsed_ns;
+    double      ns_per_sample;
+    double      samples_per_sec;
+    double      rate;      // samples needed per second of audio, 0 if not tied to it
+    double      rt_factor; // samples_per_sec / rate
+} BenchResult;
+
+extern BenchResult *benchRecord(const char *name, u64 samples, u64 elapsed_ns, double rate);
+
+#endif // BENCH_H
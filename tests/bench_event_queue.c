@@ -0,0 +1,152 @@
+#include "mock_3ds.h"
+#include "bench.h"
+#include "event_queue.h"
+#include "track_parameters.h"
+
+#include <pthread.h>
+#include <sched.h>
+#include <stdio.h>
+
+#define BENCH_PRODUCERS 2
+#define BENCH_EVENTS_PER_PRODUCER 200000
+
+// The queue event_queue.c replaced: one lock around every push and the whole step record copied
+// into and out of the ring. pthread_mutex stands in for LightLock, which the mock makes a no-op.
+typedef struct {
+    EventType   type;
+    int         track_id;
+    StepPayload step;
+} LegacyEvent;
+
+typedef struct {
+    LegacyEvent     events[EVENT_QUEUE_SIZE];
+    atomic_int      head;
+    atomic_int      tail;
+    pthread_mutex_t lock;
+} LegacyQueue;
+
+static bool legacyPush(LegacyQueue *q, const LegacyEvent *e) {
+    pthread_mutex_lock(&q->lock);
+    int head      = atomic_load_explicit(&q->head, memory_order_relaxed);
+    int next_head = (head + 1) % EVENT_QUEUE_SIZE;
+    if (next_head == atomic_load_explicit(&q->tail, memory_order_acquire)) {
+        pthread_mutex_unlock(&q->lock);
+        return false;
+    }
+    q->events[head] = *e;
+    atomic_store_explicit(&q->head, next_head, memory_order_release);
+    pthread_mutex_unlock(&q->lock);
+    return true;
+}
+
+static bool legacyPop(LegacyQueue *q, LegacyEvent *e) {
+    int tail = atomic_load_explicit(&q->tail, memory_order_relaxed);
+    if (atomic_load_explicit(&q->head, memory_order_acquire) == tail) {
+        return false;
+    }
+    *e = q->events[tail];
+    atomic_store_explicit(&q->tail, (tail + 1) % EVENT_QUEUE_SIZE, memory_order_release);
+    return true;
+}
+
+typedef struct {
+    LegacyQueue   *legacy;
+    EventQueue    *queue;
+    StepParameters step;
+} ProducerArgs;
+
+static void *legacyProducer(void *arg) {
+    ProducerArgs *args = arg;
+    LegacyEvent   e    = { .type = UPDATE_STEP, .track_id = 1 };
+    e.step             = (StepPayload) { .instrument_type = FM_SYNTH, .params = args->step };
+    for (int i = 0; i < BENCH_EVENTS_PER_PRODUCER; i++) {
+        while (!legacyPush(args->legacy, &e)) {
+            sched_yield();
+        }
+    }
+    return NULL;
+}
+
+static void *queueProducer(void *arg) {
+    ProducerArgs *args = arg;
+    for (int i = 0; i < BENCH_EVENTS_PER_PRODUCER; i++) {
+        while (!eventQueuePushStep(args->queue, UPDATE_STEP, 1, FM_SYNTH, &args->step)) {
+            sched_yield();
+        }
+    }
+    return NULL;
+}
+
+// Two producers (the main thread, which runs the UI, and the audio thread) against one consumer,
+// which yields when empty so single-core hosts still make progress; the sink keeps the payload
+// reads live
+static volatile float s_sink;
+
+static u64 runLegacy(const StepParameters *step) {
+    static LegacyQueue q;
+    atomic_init(&q.head, 0);
+    atomic_init(&q.tail, 0);
+    pthread_mutex_init(&q.lock, NULL);
+
+    ProducerArgs args = { .legacy = &q, .step = *step };
+    pthread_t    producers[BENCH_PRODUCERS];
+    u64          t0 = bench_now_ns();
+    for (int p = 0; p < BENCH_PRODUCERS; p++) {
+        pthread_create(&producers[p], NULL, legacyProducer, &args);
+    }
+    LegacyEvent e;
+    for (int n = 0; n < BENCH_PRODUCERS * BENCH_EVENTS_PER_PRODUCER;) {
+        if (legacyPop(&q, &e)) {
+            s_sink += e.step.params.instrument.fm_synth_params.carrier_freq;
+            n++;
+        } else {
+            sched_yield();
+        }
+    }
+    for (int p = 0; p < BENCH_PRODUCERS; p++) {
+        pthread_join(producers[p], NULL);
+    }
+    u64 elapsed = bench_now_ns() - t0;
+    pthread_mutex_destroy(&q.lock);
+    return elapsed;
+}
+
+static u64 runQueue(const StepParameters *step) {
+    static EventQueue q;
+    eventQueueInit(&q);
+
+    ProducerArgs args = { .queue = &q, .step = *step };
+    pthread_t    producers[BENCH_PRODUCERS];
+    u64          t0 = bench_now_ns();
+    for (int p = 0; p < BENCH_PRODUCERS; p++) {
+        pthread_create(&producers[p], NULL, queueProducer, &args);
+    }
+    Event e;
+    for (int n = 0; n < BENCH_PRODUCERS * BENCH_EVENTS_PER_PRODUCER;) {
+        if (eventQueuePop(&q, &e)) {
+            s_sink += eventQueuePayload(&q, &e)->params.instrument.fm_synth_params.carrier_freq;
+            eventQueueReleasePayload(&q, &e);
+            n++;
+        } else {
+            sched_yield();
+        }
+    }
+    for (int p = 0; p < BENCH_PRODUCERS; p++) {
+        pthread_join(producers[p], NULL);
+    }
+    return bench_now_ns() - t0;
+}
+
+void bench_event_queue(void) {
+    StepParameters step = defaultStepParameters(1, FM_SYNTH);
+    u64            n    = BENCH_PRODUCERS * BENCH_EVENTS_PER_PRODUCER;
+
+    printf("\n== event queue: %d producers, one consumer, %zu B events (%zu B locked) ==\n",
+           BENCH_PRODUCERS, sizeof(Event), sizeof(LegacyEvent));
+    u64 legacy_ns = runLegacy(&step);
+    u64 queue_ns  = runQueue(&step);
+    benchRecord("event_queue_locked", n, legacy_ns, 0);
+    benchRecord("event_queue_lockfree", n, queue_ns, 0);
+    printf("  locked     %8.1f ns/event\n", (double) legacy_ns / n);
+    printf("  lock-free  %8.1f ns/event\n", (double) queue_ns / n);
+}
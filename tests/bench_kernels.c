@@ -0,0 +1,351 @@
+#include "mock_3ds.h"
+#include "audio_utils.h"
+#include "bench.h"
+#include "clock.h"
+#include "engine_constants.h"
+#include "envelope.h"
+#include "event_queue.h"
+#include "noise_synth.h"
+#include "param_smoother.h"
+#include "samplers.h"
+#include "sequencer.h"
+#include "sine_table.h"
+#include "step_scheduler.h"
+#include "svf.h"
+#include "synth.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define KERNEL_BENCH_BLOCKS 400 // per run, 48 s of audio at SAMPLERATE
+#define KERNEL_BENCH_SAMPLES (SAMPLESPERBUF * KERNEL_BENCH_BLOCKS)
+#define KERNEL_BENCH_RUNS 5 // the fastest run is reported
+#define KERNEL_BENCH_MAX_BPM 200
+
+// Sequencer steps the audio thread needs per second in the worst case: every track on every
+// clock step at the highest tempo
+#define SEQUENCER_CALLS_PER_SEC (KERNEL_BENCH_MAX_BPM / 60.0 * STEPS_PER_BEAT * N_TRACKS)
+// Clock steps per second at the highest tempo, each one asks which tracks are due
+#define CLOCK_STEPS_PER_SEC (KERNEL_BENCH_MAX_BPM / 60.0 * STEPS_PER_BEAT)
+
+static volatile float s_sink;
+
+typedef struct {
+    PolyBLEPOscillator osc;
+    Envelope           env, sampler_env, noise_env;
+    SubSynth           subsynth;
+    FMSynth            fm_synth;
+    Sampler            sampler;
+    NoiseSynth         noise_synth, noise_synth_div;
+    SVFilter           svf;
+    GainSmoother       gain;
+    u32                frames[SAMPLESPERBUF];
+    Sample             sample;
+    u32               *buffer;
+    ndspWaveBuf        waveBuf;
+    float              floats[SAMPLESPERBUF * NCHANNELS];
+    s16                ints[SAMPLESPERBUF * NCHANNELS];
+    Sequencer          seq;
+    Pattern            track_patterns[N_TRACKS]; // one subdivision per track, see initRig
+    Sequencer          track_seqs[N_TRACKS];
+    StepPayload        step_payload;
+    EventQueue         queue;
+} KernelRig;
+
+static KernelRig s_rig;
+
+// Long sustain, retriggered by the kernels that would otherwise run it into silence
+static void initEnv(Envelope *env, float rate) {
+    *env = defaultEnvelopeStruct(rate);
+    updateEnvelope(env, 5, 50, 0.8f, 50, 60000);
+    triggerEnvelope(env);
+}
+
+static void initRig(KernelRig *rig) {
+    rig->osc = (PolyBLEPOscillator) { .samplerate = SAMPLERATE, .pulse_width = 0.5f };
+    setWaveform(&rig->osc, SQUARE);
+    setOscFrequency(&rig->osc, 220.0f);
+    initEnv(&rig->env, SAMPLERATE);
+    rig->subsynth = (SubSynth) { .osc = &rig->osc, .env = &rig->env };
+
+    // Every operator sounding and no feedback, which serialises the top operator sample by sample
+    initFMSynth(&rig->fm_synth, SAMPLERATE);
+    const float ratios[FM_OPERATORS] = { 1.0f, 2.0f, 3.0f, 1.0f };
+    for (int op = 0; op < FM_OPERATORS; op++) {
+        initEnv(&rig->fm_synth.ops[op].env, SAMPLERATE);
+        FMSetOperator(&rig->fm_synth, op, ratios[op], 0.8f);
+    }
+    FMSetModIndex(&rig->fm_synth, 2.0f);
+    FMSetFrequency(&rig->fm_synth, 220.0f);
+
+    rig->sample.pcm_data_size_in_frames = OPUSSAMPLERATE;
+    rig->sample.pcm_data = malloc(OPUSSAMPLERATE * NCHANNELS * sizeof(int16_t));
+    for (size_t i = 0; i < OPUSSAMPLERATE * NCHANNELS; i++) {
+        rig->sample.pcm_data[i] = (int16_t) (rand() % 20000 - 10000);
+    }
+    initEnv(&rig->sampler_env, OPUSSAMPLERATE);
+    rig->sampler = (Sampler) { .sample          = &rig->sample,
+                               .playback_mode   = LOOP,
+                               .samples_per_buf = OPUSSAMPLESPERFBUF,
+                               .samplerate      = OPUSSAMPLERATE,
+                               .env             = &rig->sampler_env };
+
+    initEnv(&rig->noise_env, SAMPLERATE);
+    rig->noise_synth     = (NoiseSynth) { .env = &rig->noise_env, .lfsr_register = 0x4000 };
+    rig->noise_synth_div = rig->noise_synth;
+    setNoiseRateDiv(&rig->noise_synth_div, 8);
+
+    // Resonant low-pass swept by its envelope, so every control period computes coefficients
+    initSVF(&rig->svf, SAMPLERATE);
+    SVFSetParams(&rig->svf, SVF_LOWPASS, 400.0f, 0.7f, 4.0f, 60000);
+    triggerEnvelope(&rig->noise_env);
+    renderNoiseSynthAudio(rig->frames, SAMPLESPERBUF, &rig->noise_synth);
+
+    // Centre pan, so both channels are scaled, with a ramp at the start of every block
+    initGainSmoother(&rig->gain, SAMPLERATE, 0.7f, 0.7f);
+
+    rig->buffer             = malloc(OPUSSAMPLESPERFBUF * sizeof(u32));
+    rig->waveBuf.data_vaddr = rig->buffer;
+
+    for (int i = 0; i < SAMPLESPERBUF * NCHANNELS; i++) {
+        rig->floats[i] = (float) ((i * 7919) % 4001 - 2000) / 1500.0f; // some values clip
+    }
+
+    StepParameters defaults = defaultStepParameters(1, FM_SYNTH);
+    initSequencer(&rig->seq, 16, &defaults);
+    for (int i = 0; i < 16; i++) {
+        patternSetStepActive(rig->seq.edit, i, (i % 3) == 0);
+    }
+    sequencerPublish(&rig->seq);
+
+    const int steps_per_beat[N_TRACKS] = { 4, 3, 8, 2, 6 };
+    for (int t = 0; t < N_TRACKS; t++) {
+        rig->track_patterns[t] = (Pattern) { .n_beats = 4, .steps_per_beat = steps_per_beat[t] };
+        rig->track_seqs[t]     = (Sequencer) { .playing = &rig->track_patterns[t] };
+    }
+
+    eventQueueInit(&rig->queue);
+}
+
+// Each kernel processes `samples` units of work and returns how many it did
+typedef size_t (*KernelFn)(KernelRig *rig, size_t samples);
+
+static size_t runFillSubSynth(KernelRig *rig, size_t samples) {
+    for (size_t pos = 0; pos < samples; pos += SAMPLESPERBUF) {
+        triggerEnvelope(&rig->env);
+        fillSubSynthAudiobuffer(&rig->waveBuf, SAMPLESPERBUF, &rig->subsynth);
+    }
+    return samples;
+}
+
+static size_t runFillFMSynth(KernelRig *rig, size_t samples) {
+    for (size_t pos = 0; pos < samples; pos += SAMPLESPERBUF) {
+        triggerFMSynth(&rig->fm_synth);
+        fillFMSynthAudiobuffer(&rig->waveBuf, SAMPLESPERBUF, &rig->fm_synth);
+    }
+    return samples;
+}
+
+static size_t runFillSampler(KernelRig *rig, size_t samples) {
+    size_t done = 0;
+    for (; done < samples; done += OPUSSAMPLESPERFBUF) {
+        triggerEnvelope(&rig->sampler_env);
+        fillSamplerAudioBuffer(&rig->waveBuf, OPUSSAMPLESPERFBUF, &rig->sampler);
+    }
+    return done;
+}
+
+static size_t runFillNoiseSynth(KernelRig *rig, size_t samples) {
+    for (size_t pos = 0; pos < samples; pos += SAMPLESPERBUF) {
+        triggerEnvelope(&rig->noise_env);
+        fillNoiseSynthAudiobuffer(&rig->waveBuf, SAMPLESPERBUF, &rig->noise_synth);
+    }
+    return samples;
+}
+
+static size_t runFillNoiseSynthDiv8(KernelRig *rig, size_t samples) {
+    for (size_t pos = 0; pos < samples; pos += SAMPLESPERBUF) {
+        triggerEnvelope(&rig->noise_env);
+        fillNoiseSynthAudiobuffer(&rig->waveBuf, SAMPLESPERBUF, &rig->noise_synth_div);
+    }
+    return samples;
+}
+
+static size_t runProcessSVFFrames(KernelRig *rig, size_t samples) {
+    for (size_t pos = 0; pos < samples; pos += SAMPLESPERBUF) {
+        triggerSVF(&rig->svf);
+        processSVFFrames(&rig->svf, rig->frames, SAMPLESPERBUF);
+    }
+    return samples;
+}
+
+static size_t runApplyGainSmoother(KernelRig *rig, size_t samples) {
+    for (size_t pos = 0; pos < samples; pos += SAMPLESPERBUF) {
+        gainSmootherSetTarget(&rig->gain, (pos / SAMPLESPERBUF) % 2 ? 0.7f : 0.5f, 0.7f);
+        applyGainSmoother(&rig->gain, rig->frames, SAMPLESPERBUF);
+    }
+    return samples;
+}
+
+static size_t runNextOscillatorSample(KernelRig *rig, size_t samples) {
+    float acc = 0.0f;
+    for (size_t i = 0; i < samples; i++) {
+        acc += nextOscillatorSample(&rig->osc);
+    }
+    s_sink = acc;
+    return samples;
+}
+
+static size_t runNextFMOscillatorSample(KernelRig *rig, size_t samples) {
+    float acc = 0.0f;
+    for (size_t pos = 0; pos < samples; pos += SAMPLESPERBUF) {
+        triggerFMSynth(&rig->fm_synth);
+        for (size_t i = 0; i < SAMPLESPERBUF; i++) {
+            acc += nextFMOscillatorSample(&rig->fm_synth);
+        }
+    }
+    s_sink = acc;
+    return samples;
+}
+
+static size_t runNextEnvelopeSample(KernelRig *rig, size_t samples) {
+    float acc = 0.0f;
+    for (size_t pos = 0; pos < samples; pos += SAMPLESPERBUF) {
+        triggerEnvelope(&rig->env);
+        for (size_t i = 0; i < SAMPLESPERBUF; i++) {
+            acc += nextEnvelopeSample(&rig->env);
+        }
+    }
+    s_sink = acc;
+    return samples;
+}
+
+// Counted per stereo frame, two conversions each
+static size_t runFloatToInt16(KernelRig *rig, size_t samples) {
+    for (size_t pos = 0; pos < samples; pos += SAMPLESPERBUF) {
+        for (size_t i = 0; i < SAMPLESPERBUF * NCHANNELS; i++) {
+            rig->ints[i] = floatToInt16(rig->floats[i]);
+        }
+    }
+    s_sink = rig->ints[SAMPLESPERBUF];
+    return samples;
+}
+
+// A clock step for one track as the audio thread takes it: advance, and copy a live step's
+// record into the schedule that will trigger it
+static size_t runSequencerTick(KernelRig *rig, size_t samples) {
+    int active = 0;
+    for (size_t i = 0; i < samples; i++) {
+        const StepParameters *step = updateSequencer(&rig->seq);
+        if (step) {
+            rig->step_payload = (StepPayload) { .instrument_type = FM_SYNTH, .params = *step };
+            active++;
+        }
+    }
+    s_sink = (float) active;
+    return samples;
+}
+
+// Which tracks are due on each clock step, asking every track as the audio thread used to
+static size_t runStepPolling(KernelRig *rig, size_t samples) {
+    int fired = 0;
+    for (size_t i = 1; i <= samples; i++) {
+        for (int t = 0; t < N_TRACKS; t++) {
+            fired += sequencerStepDue(&rig->track_seqs[t], (int) i);
+        }
+    }
+    s_sink = (float) fired;
+    return samples;
+}
+
+// The same through the step scheduler: steps nobody is due on are one comparison
+static size_t runStepScheduler(KernelRig *rig, size_t samples) {
+    StepScheduler sched;
+    stepSchedulerClear(&sched);
+    for (int t = 0; t < N_TRACKS; t++) {
+        stepSchedulerPush(&sched, t, 1);
+    }
+    int fired = 0;
+    for (size_t i = 1; i <= samples; i++) {
+        int t;
+        while ((t = stepSchedulerPopDue(&sched, (int) i)) >= 0) {
+            stepSchedulerPush(&sched, t, sequencerNextStepTick(&rig->track_seqs[t], (int) i));
+            fired++;
+        }
+    }
+    s_sink = (float) fired;
+    return samples;
+}
+
+// One push and one pop per unit, the queue kept a quarter full like a busy UI would
+static size_t runEventQueuePushPop(KernelRig *rig, size_t samples) {
+    Event in = { .type = TRIGGER_STEP, .track_id = 1 };
+    Event out;
+    for (int i = 0; i < EVENT_QUEUE_SIZE / 4; i++) {
+        eventQueuePush(&rig->queue, in);
+    }
+    for (size_t i = 0; i < samples; i++) {
+        in.track_id = (int) (i % N_TRACKS);
+        eventQueuePush(&rig->queue, in);
+        eventQueuePop(&rig->queue, &out);
+    }
+    while (eventQueuePop(&rig->queue, &out)) {
+    }
+    s_sink = (float) out.track_id;
+    return samples;
+}
+
+typedef struct {
+    const char *name;
+    KernelFn    run;
+    double      rate; // units needed per second of audio, 0 when not tied to the audio rate
+} Kernel;
+
+static const Kernel kernels[] = {
+    { "fillSubSynthAudiobuffer", runFillSubSynth, SAMPLERATE },
+    { "fillFMSynthAudiobuffer", runFillFMSynth, SAMPLERATE },
+    { "fillSamplerAudioBuffer", runFillSampler, OPUSSAMPLERATE },
+    { "fillNoiseSynthAudiobuffer", runFillNoiseSynth, SAMPLERATE },
+    { "fillNoise (rate div 8)", runFillNoiseSynthDiv8, SAMPLERATE },
+    { "processSVFFrames", runProcessSVFFrames, SAMPLERATE },
+    { "applyGainSmoother", runApplyGainSmoother, SAMPLERATE },
+    { "nextOscillatorSample", runNextOscillatorSample, SAMPLERATE },
+    { "nextFMOscillatorSample", runNextFMOscillatorSample, SAMPLERATE },
+    { "nextEnvelopeSample", runNextEnvelopeSample, SAMPLERATE },
+    { "floatToInt16", runFloatToInt16, SAMPLERATE },
+    { "sequencerTick", runSequencerTick, SEQUENCER_CALLS_PER_SEC },
+    { "stepDue (poll tracks)", runStepPolling, CLOCK_STEPS_PER_SEC },
+    { "stepScheduler", runStepScheduler, CLOCK_STEPS_PER_SEC },
+    { "eventQueuePush+Pop", runEventQueuePushPop, 0 },
+};
+
+void bench_kernels(void) {
+    initSineTable();
+    initRig(&s_rig);
+
+    printf("== kernels: %d samples per run, best of %d ==\n", KERNEL_BENCH_SAMPLES,
+           KERNEL_BENCH_RUNS);
+    printf("%-26s %10s %12s %12s\n", "kernel", "ns/sample", "Msamples/s", "x realtime");
+
+    for (size_t k = 0; k < sizeof(kernels) / sizeof(kernels[0]); k++) {
+        u64    best    = UINT64_MAX;
+        size_t samples = 0;
+        for (int run = 0; run < KERNEL_BENCH_RUNS; run++) {
+            u64 start = bench_now_ns();
+            samples   = kernels[k].run(&s_rig, KERNEL_BENCH_SAMPLES);
+            u64 took  = bench_now_ns() - start;
+            best      = took < best ? took : best;
+        }
+        BenchResult *r = benchRecord(kernels[k].name, samples, best, kernels[k].rate);
+        printf("%-26s %10.2f %12.2f ", r->name, r->ns_per_sample, r->samples_per_sec / 1e6);
+        if (r->rate > 0) {
+            printf("%12.0f\n", r->rt_factor);
+        } else {
+            printf("%12s\n", "-");
+        }
+    }
+
+    free(s_rig.sample.pcm_data);
+    free(s_rig.buffer);
+}
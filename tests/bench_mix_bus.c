@@ -0,0 +1,164 @@
+#include "mock_3ds.h"
+#include "bench.h"
+#include "engine_constants.h"
+#include "envelope.h"
+#include "mix_bus.h"
+#include "noise_synth.h"
+#include "samplers.h"
+#include "sine_table.h"
+#include "synth.h"
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define BENCH_BLOCKS 200
+#define BENCH_SAMPLE_FRAMES OPUSSAMPLERATE
+
+// The same five instruments main.c sets up, rendered either per channel or through the bus
+typedef struct {
+    PolyBLEPOscillator osc;
+    Envelope           sub_env, sampler_env[2], noise_env;
+    SubSynth           subsynth;
+    FMSynth            fm_synth;
+    Sampler            sampler[2];
+    NoiseSynth         noise_synth;
+} BenchRig;
+
+static Sample s_sample;
+
+static void initSample(void) {
+    s_sample.pcm_data_size_in_frames = BENCH_SAMPLE_FRAMES;
+    s_sample.pcm_data = malloc(BENCH_SAMPLE_FRAMES * NCHANNELS * sizeof(int16_t));
+    for (size_t i = 0; i < BENCH_SAMPLE_FRAMES * NCHANNELS; i++) {
+        s_sample.pcm_data[i] = (int16_t) (rand() % 20000 - 10000);
+    }
+}
+
+static void initEnv(Envelope *env, float rate) {
+    *env = defaultEnvelopeStruct(rate);
+    // Long sustain so every instrument stays audible for the whole run
+    updateEnvelope(env, 5, 50, 0.8f, 50, 60000);
+    triggerEnvelope(env);
+}
+
+static void initRig(BenchRig *rig, float synth_rate, size_t sampler_buf) {
+    rig->osc = (PolyBLEPOscillator) { .samplerate = synth_rate, .waveform = SQUARE,
+                                      .pulse_width = 0.5f };
+    setOscFrequency(&rig->osc, 220.0f);
+    initEnv(&rig->sub_env, synth_rate);
+    rig->subsynth = (SubSynth) { .osc = &rig->osc, .env = &rig->sub_env };
+
+    initFMSynth(&rig->fm_synth, synth_rate);
+    for (int op = 0; op < FM_OPERATORS; op++) {
+        initEnv(&rig->fm_synth.ops[op].env, synth_rate);
+        FMSetOperator(&rig->fm_synth, op, (float) (op + 1), 0.8f);
+    }
+    FMSetModIndex(&rig->fm_synth, 2.0f);
+    FMSetFrequency(&rig->fm_synth, 220.0f);
+
+    for (int i = 0; i < 2; i++) {
+        initEnv(&rig->sampler_env[i], OPUSSAMPLERATE);
+        rig->sampler[i] = (Sampler) { .sample          = &s_sample,
+                                      .playback_mode   = LOOP,
+                                      .samples_per_buf = sampler_buf,
+                                      .samplerate      = OPUSSAMPLERATE,
+                                      .env             = &rig->sampler_env[i] };
+    }
+
+    initEnv(&rig->noise_env, synth_rate);
+    rig->noise_synth = (NoiseSynth) { .env = &rig->noise_env, .lfsr_register = 0x4000 };
+}
+
+static void benchPerChannel(void) {
+    BenchRig rig;
+    initRig(&rig, SAMPLERATE, OPUSSAMPLESPERFBUF);
+
+    u32        *buffers[N_TRACKS];
+    ndspWaveBuf waveBufs[N_TRACKS];
+    size_t      sizes[N_TRACKS] = { SAMPLESPERBUF, SAMPLESPERBUF, OPUSSAMPLESPERFBUF,
+                                    OPUSSAMPLESPERFBUF, SAMPLESPERBUF };
+    for (int i = 0; i < N_TRACKS; i++) {
+        buffers[i]             = malloc(sizes[i] * sizeof(u32));
+        waveBufs[i].data_vaddr = buffers[i];
+    }
+
+    mock_reset_dsp_counters();
+    u64 start = bench_now_ns();
+    for (int b = 0; b < BENCH_BLOCKS; b++) {
+        fillSubSynthAudiobuffer(&waveBufs[0], sizes[0], &rig.subsynth);
+        fillFMSynthAudiobuffer(&waveBufs[1], sizes[1], &rig.fm_synth);
+        fillSamplerAudioBuffer(&waveBufs[2], sizes[2], &rig.sampler[0]);
+        fillSamplerAudioBuffer(&waveBufs[3], sizes[3], &rig.sampler[1]);
+        fillNoiseSynthAudiobuffer(&waveBufs[4], sizes[4], &rig.noise_synth);
+        for (int i = 0; i < N_TRACKS; i++) {
+            ndspChnWaveBufAdd(i, &waveBufs[i]);
+        }
+    }
+    u64 elapsed = bench_now_ns() - start;
+
+    // Every channel plays 120 ms per block; frames are counted at the synth rate so the figure
+    // lines up with the bus run at the same rate
+    printf("per-channel (synths at %5d Hz): %8.1f us/block  %6.1f ns/frame  %u flushes/block  "
+           "%zu bytes flushed/block  %u ndsp cmds/block\n",
+           SAMPLERATE, elapsed / 1000.0 / BENCH_BLOCKS,
+           (double) elapsed / ((double) BENCH_BLOCKS * SAMPLESPERBUF),
+           mock_dsp_flush_count / BENCH_BLOCKS, mock_dsp_flush_bytes / BENCH_BLOCKS,
+           mock_ndsp_command_count / BENCH_BLOCKS);
+
+    for (int i = 0; i < N_TRACKS; i++) {
+        free(buffers[i]);
+    }
+}
+
+// The bus at the given rate, all five instruments rendering at it
+static void benchMixBus(int rate, size_t samples_per_buf) {
+    BenchRig rig;
+    initRig(&rig, rate, samples_per_buf);
+
+    MixBus bus;
+    u32   *audio_buffer = malloc(2 * samples_per_buf * sizeof(u32));
+    float *accum_buffer = malloc(samples_per_buf * NCHANNELS * sizeof(float));
+    initializeMixBus(&bus, MIXBUS_CHANNEL, rate, samples_per_buf, audio_buffer, accum_buffer);
+
+    // Equal-power centre pan, as set by updateTrackParameters for the default parameters
+    float gain = cosf(M_PI / 4.0f);
+
+    mock_reset_dsp_counters();
+    u64 start = bench_now_ns();
+    for (int b = 0; b < BENCH_BLOCKS; b++) {
+        size_t size    = bus.samples_per_buf;
+        float *mix_buf = mixBusBegin(&bus);
+        mixSubSynthAudiobuffer(mix_buf, size, &rig.subsynth, gain, gain);
+        mixFMSynthAudiobuffer(mix_buf, size, &rig.fm_synth, gain, gain);
+        mixSamplerAudioBuffer(mix_buf, size, &rig.sampler[0], gain, gain);
+        mixSamplerAudioBuffer(mix_buf, size, &rig.sampler[1], gain, gain);
+        mixNoiseSynthAudiobuffer(mix_buf, size, &rig.noise_synth, gain, gain);
+        mixBusSubmit(&bus);
+    }
+    u64 elapsed = bench_now_ns() - start;
+
+    printf("mix bus     (synths at %5d Hz): %8.1f us/block  %6.1f ns/frame  %u flushes/block  "
+           "%zu bytes flushed/block  %u ndsp cmds/block\n",
+           rate, elapsed / 1000.0 / BENCH_BLOCKS,
+           (double) elapsed / ((double) BENCH_BLOCKS * samples_per_buf),
+           mock_dsp_flush_count / BENCH_BLOCKS, mock_dsp_flush_bytes / BENCH_BLOCKS,
+           mock_ndsp_command_count / BENCH_BLOCKS);
+
+    MixBus_deinit(&bus);
+    free(audio_buffer);
+}
+
+void bench_mix_bus(void) {
+    initSineTable();
+    initSample();
+
+    printf("== mix bus: %d tracks, %d blocks of 120 ms ==\n", N_TRACKS, BENCH_BLOCKS);
+    benchPerChannel();
+    // Like for like with the channels first, then at the rate the bus build runs
+    benchMixBus(SAMPLERATE, SAMPLESPERBUF);
+    benchMixBus(MIXBUS_SAMPLERATE, MIXBUS_SAMPLESPERBUF);
+
+    free(s_sample.pcm_data);
+}
@@ -0,0 +1,85 @@
+#include "mock_3ds.h"
+#include "bench.h"
+#include "engine_constants.h"
+#include "polybleposc.h"
+#include "sine_table.h"
+
+#include <math.h>
+#include <stdio.h>
+
+#define OSC_BENCH_SAMPLES (SAMPLESPERBUF * 1000)
+
+static volatile float s_sink;
+
+// nextOscillatorSample before the per-waveform kernels: dispatch, dt and fmod on every sample
+static float legacyOscillatorSample(PolyBLEPOscillator *osc) {
+    float sample;
+    float t = phaseToUnit(osc->phase);
+
+    switch (osc->waveform) {
+    case SINE:
+        sample = sineFromPhase(osc->phase);
+        break;
+    case SQUARE:
+        float square = t < osc->pulse_width ? 1.0f : -1.0f;
+        sample =
+            square + polyBLEP(osc, t) - polyBLEP(osc, fmod(t + (1.0f - osc->pulse_width), 1.0f));
+        break;
+    case SAW:
+        sample = ((2.0f * t) - 1.0f) - polyBLEP(osc, t);
+        break;
+    case TRIANGLE:
+        if (t < 0.5f) {
+            sample = 4.0f * t - 1.0f;
+        } else {
+            sample = -4.0f * (t - 0.5f) + 1.0f;
+        }
+        break;
+    default:
+        sample = sineFromPhase(osc->phase);
+        break;
+    }
+    osc->phase += osc->phase_inc;
+    return sample;
+}
+
+static double msamplesPerSec(u64 elapsed_ns) {
+    return OSC_BENCH_SAMPLES * 1000.0 / elapsed_ns;
+}
+
+void bench_oscillators(void) {
+    initSineTable();
+    printf("== oscillators: %d samples per waveform (Msamples/s) ==\n", OSC_BENCH_SAMPLES);
+    printf("%-10s %12s %12s %12s\n", "waveform", "before", "per-sample", "block");
+
+    static float buf[SAMPLESPERBUF];
+
+    for (int wf = 0; wf < WAVEFORM_COUNT; wf++) {
+        PolyBLEPOscillator osc = { .samplerate = SAMPLERATE, .pulse_width = 0.5f };
+        setWaveform(&osc, wf);
+        setOscFrequency(&osc, 220.0f);
+
+        float acc   = 0.0f;
+        u64   start = bench_now_ns();
+        for (int i = 0; i < OSC_BENCH_SAMPLES; i++) {
+            acc += legacyOscillatorSample(&osc);
+        }
+        double before = msamplesPerSec(bench_now_ns() - start);
+
+        start = bench_now_ns();
+        for (int i = 0; i < OSC_BENCH_SAMPLES; i++) {
+            acc += nextOscillatorSample(&osc);
+        }
+        double per_sample = msamplesPerSec(bench_now_ns() - start);
+
+        start = bench_now_ns();
+        for (int b = 0; b < OSC_BENCH_SAMPLES / SAMPLESPERBUF; b++) {
+            renderOscillatorBlock(&osc, buf, SAMPLESPERBUF);
+            acc += buf[b];
+        }
+        double block = msamplesPerSec(bench_now_ns() - start);
+
+        s_sink = acc;
+        printf("%-10s %12.1f %12.1f %12.1f\n", waveform_names[wf], before, per_sample, block);
+    }
+}
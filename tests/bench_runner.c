@@ -0,0 +1,77 @@
+#include "bench.h"
+#include "engine_constants.h"
+
+#include <stdio.h>
+#include <string.h>
+
+#define BENCH_MAX_RESULTS 64
+
+// Declare benchmark functions
+extern void bench_mix_bus(void);
+extern void bench_sine_table(void);
+extern void bench_oscillators(void);
+extern void bench_kernels(void);
+extern void bench_event_queue(void);
+
+static BenchResult s_results[BENCH_MAX_RESULTS];
+static int         s_n_results = 0;
+
+BenchResult *benchRecord(const char *name, u64 samples, u64 elapsed_ns, double rate) {
+    static BenchResult overflow;
+    BenchResult       *r = s_n_results < BENCH_MAX_RESULTS ? &s_results[s_n_results++] : &overflow;
+
+    double secs        = elapsed_ns > 0 ? elapsed_ns * 1e-9 : 1e-9;
+    r->name            = name;
+    r->samples         = samples;
+    r->elapsed_ns      = elapsed_ns;
+    r->ns_per_sample   = samples > 0 ? (double) elapsed_ns / samples : 0.0;
+    r->samples_per_sec = samples / secs;
+    r->rate            = rate;
+    r->rt_factor       = rate > 0 ? r->samples_per_sec / rate : 0.0;
+    return r;
+}
+
+static int writeJson(const char *path) {
+    FILE *f = fopen(path, "w");
+    if (!f) {
+        fprintf(stderr, "bench: cannot write %s\n", path);
+        return 1;
+    }
+    fprintf(f, "{\n  \"samplerate\": %d,\n  \"opus_samplerate\": %d,\n  \"results\": [\n",
+            SAMPLERATE, OPUSSAMPLERATE);
+    for (int i = 0; i < s_n_results; i++) {
+        BenchResult *r = &s_results[i];
+        fprintf(f,
+                "    {\"name\": \"%s\", \"samples\": %llu, \"elapsed_ns\": %llu, "
+                "\"ns_per_sample\": %.3f, \"samples_per_sec\": %.0f, \"rate\": %.1f, ",
+                r->name, (unsigned long long) r->samples, (unsigned long long) r->elapsed_ns,
+                r->ns_per_sample, r->samples_per_sec, r->rate);
+        if (r->rate > 0) {
+            fprintf(f, "\"rt_factor\": %.1f}", r->rt_factor);
+        } else {
+            fprintf(f, "\"rt_factor\": null}");
+        }
+        fprintf(f, "%s\n", i + 1 < s_n_results ? "," : "");
+    }
+    fprintf(f, "  ]\n}\n");
+    fclose(f);
+    printf("wrote %d results to %s\n", s_n_results, path);
+    return 0;
+}
+
+int main(int argc, char **argv) {
+    const char *json_path = NULL;
+    for (int i = 1; i + 1 < argc; i++) {
+        if (strcmp(argv[i], "--json") == 0) {
+            json_path = argv[i + 1];
+        }
+    }
+
+    bench_mix_bus();
+    bench_sine_table();
+    bench_oscillators();
+    bench_kernels();
+    bench_event_queue();
+
+    return json_path ? writeJson(json_path) : 0;
+}
@@ -0,0 +1,55 @@
+#include "mock_3ds.h"
+#include "bench.h"
+#include "polybleposc.h"
+#include "sine_table.h"
+
+#include <math.h>
+#include <stdio.h>
+
+#define SINE_BENCH_SAMPLES 4000000
+
+// Keeps the loops from being optimised away
+static volatile float s_sink;
+
+static void report(const char *name, u64 elapsed_ns) {
+    printf("%-30s %6.2f ns/sample  %7.1f Msamples/s\n", name,
+           (double) elapsed_ns / SINE_BENCH_SAMPLES, SINE_BENCH_SAMPLES * 1000.0 / elapsed_ns);
+}
+
+void bench_sine_table(void) {
+    initSineTable();
+    printf("== sine: %d samples ==\n", SINE_BENCH_SAMPLES);
+
+    // What nextOscillatorSample used to do: float radians, double sin, wrap loop
+    float phase = 0.0f, phase_inc = 220.0f * M_TWOPI / 32000.0f, acc = 0.0f;
+    u64   start = bench_now_ns();
+    for (int i = 0; i < SINE_BENCH_SAMPLES; i++) {
+        acc += sin(phase);
+        phase += phase_inc;
+        while (phase >= M_TWOPI) {
+            phase -= M_TWOPI;
+        }
+    }
+    report("sin() + float radian phase", bench_now_ns() - start);
+    s_sink = acc;
+
+    u32 uphase = 0, uphase_inc = (u32) (220.0f / 32000.0f * PHASE_RANGE);
+    acc        = 0.0f;
+    start      = bench_now_ns();
+    for (int i = 0; i < SINE_BENCH_SAMPLES; i++) {
+        acc += sineFromPhase(uphase);
+        uphase += uphase_inc;
+    }
+    report("sine table + u32 phase", bench_now_ns() - start);
+    s_sink = acc;
+
+    PolyBLEPOscillator osc = { .samplerate = 32000.0f, .waveform = SINE };
+    setOscFrequency(&osc, 220.0f);
+    acc   = 0.0f;
+    start = bench_now_ns();
+    for (int i = 0; i < SINE_BENCH_SAMPLES; i++) {
+        acc += nextOscillatorSample(&osc);
+    }
+    report("nextOscillatorSample (SINE)", bench_now_ns() - start);
+    s_sink = acc;
+}
@@ -14,11 +14,49 @@ u64 svcGetSystemTick(void) {
     return mock_system_tick;
 }
 
+u32    mock_dsp_flush_count    = 0;
+size_t mock_dsp_flush_bytes    = 0;
+u32    mock_ndsp_command_count = 0;
+
+void mock_reset_dsp_counters(void) {
+    mock_dsp_flush_count    = 0;
+    mock_dsp_flush_bytes    = 0;
+    mock_ndsp_command_count = 0;
+}
+
 void DSP_FlushDataCache(void *addr, size_t size) {
-    // Mock implementation
+    mock_dsp_flush_count++;
+    mock_dsp_flush_bytes += size;
 }
 
 Result ndspChnWaveBufAdd(int channel, ndspWaveBuf *waveBuf) {
-    // Mock implementation
+    mock_ndsp_command_count++;
+    if (waveBuf) {
+        waveBuf->status = NDSP_WBUF_QUEUED;
+    }
     return 0;
+}
+
+void ndspChnWaveBufClear(int id) {
+    mock_ndsp_command_count++;
+}
+
+void ndspChnReset(int id) {
+    mock_ndsp_command_count++;
+}
+
+void ndspChnSetInterp(int id, int type) {
+    mock_ndsp_command_count++;
+}
+
+void ndspChnSetRate(int id, float rate) {
+    mock_ndsp_command_count++;
+}
+
+void ndspChnSetFormat(int id, u16 format) {
+    mock_ndsp_command_count++;
+}
+
+void ndspChnSetMix(int id, float mix[12]) {
+    mock_ndsp_command_count++;
 }
\ No newline at end of file
@@ -40,14 +40,34 @@ typedef uint32_t u32;
 typedef int32_t  Result;
 
 // Mock for ndsp
+enum { NDSP_WBUF_FREE = 0, NDSP_WBUF_QUEUED = 1, NDSP_WBUF_PLAYING = 2, NDSP_WBUF_DONE = 3 };
+enum { NDSP_INTERP_POLYPHASE = 0, NDSP_INTERP_LINEAR = 1, NDSP_INTERP_NONE = 2 };
+#define NDSP_FORMAT_STEREO_PCM16 0x000A
+
 typedef struct {
     // Define necessary fields for ndspWaveBuf mock
-    u32 *data_vaddr;
-    u32  nsamples;
+    union {
+        s16        *data_pcm16;
+        const void *data_vaddr;
+    };
+    u32 nsamples;
+    u8  status;
 } ndspWaveBuf;
 
 void   DSP_FlushDataCache(void *addr, size_t size);
 Result ndspChnWaveBufAdd(int channel, ndspWaveBuf *waveBuf);
+void   ndspChnWaveBufClear(int id);
+void   ndspChnReset(int id);
+void   ndspChnSetInterp(int id, int type);
+void   ndspChnSetRate(int id, float rate);
+void   ndspChnSetFormat(int id, u16 format);
+void   ndspChnSetMix(int id, float mix[12]);
+
+// DSP command counters, used by the host benchmarks to compare output strategies
+extern u32    mock_dsp_flush_count;
+extern size_t mock_dsp_flush_bytes;
+extern u32    mock_ndsp_command_count;
+void          mock_reset_dsp_counters(void);
 
 // Mock for system ticks
 extern u64 mock_system_tick;
@@ -0,0 +1,75 @@
+#include "mock_3ds.h"
+#include "audio_simd.h"
+#include "audio_utils.h"
+#include "unity.h"
+
+#include <stdint.h>
+
+// Reference: what the fills did before the packed kernels
+static u32 referenceStereo(float x) {
+    s16 s = floatToInt16(x);
+    return ((u32) (u16) s << 16) | (u16) s;
+}
+
+static s32 referenceGain(s16 sample, s32 gain) {
+    int64_t v = ((int64_t) gain * sample) >> 16;
+    return v < -32768 ? -32768 : (v > 32767 ? 32767 : (s32) v);
+}
+
+void test_simd_saturate_and_pack(void) {
+    TEST_ASSERT_EQUAL_INT32(32767, ssat16(40000));
+    TEST_ASSERT_EQUAL_INT32(-32768, ssat16(-40000));
+    TEST_ASSERT_EQUAL_INT32(-5, ssat16(-5));
+
+    // Left in the low halfword, right in the high one
+    TEST_ASSERT_EQUAL_HEX32(0x8000ffffu, packStereo16(-1, -32768));
+    TEST_ASSERT_EQUAL_HEX32(0x00017fffu, packStereo16(32767, 1));
+}
+
+void test_simd_float_to_stereo_matches_reference(void) {
+    const float special[] = { 0.0f,     -0.0f,    1.0f,      -1.0f,     0.99999f, -0.99999f,
+                              1.5f,     -1.5f,    1e9f,      -1e9f,     3e-5f,    -3e-5f,
+                              0.5f,     -0.5f,    1.0f / 3.0f };
+    const size_t n_special = sizeof(special) / sizeof(special[0]);
+
+    float in[2048];
+    u32   out[2048];
+    for (size_t i = 0; i < n_special; i++) {
+        in[i] = special[i];
+    }
+    for (size_t i = n_special; i < 2048; i++) {
+        in[i] = -1.25f + 2.5f * (float) i / 2048.0f;
+    }
+
+    floatToStereoInt16(in, out, 2048);
+    for (size_t i = 0; i < 2048; i++) {
+        TEST_ASSERT_EQUAL_HEX32(referenceStereo(in[i]), out[i]);
+    }
+}
+
+void test_simd_stereo_gain_is_bit_exact(void) {
+    const s32 gains[] = { 0, 1, 12345, 32768, 65535, GAIN_Q16_ONE, 70000, 2 * GAIN_Q16_ONE,
+                          -GAIN_Q16_ONE };
+
+    for (size_t g = 0; g < sizeof(gains) / sizeof(gains[0]); g++) {
+        for (s32 s = -32768; s <= 32767; s++) {
+            // Different values left and right so a swapped half shows up
+            s16 left  = (s16) s;
+            s16 right = (s16) (-1 - s);
+            u32 frame = packStereo16(left, right);
+            u32 out   = stereoGainQ16(frame, gains[g]);
+
+            TEST_ASSERT_EQUAL_INT32(referenceGain(left, gains[g]), (s16) (out & 0xffff));
+            TEST_ASSERT_EQUAL_INT32(referenceGain(right, gains[g]), (s16) (out >> 16));
+        }
+    }
+}
+
+void test_simd_unity_gain_is_identity(void) {
+    u32 in[4]   = { 0x7fff8000u, 0x00010002u, 0xfffe1234u, 0u };
+    s32 gain[4] = { GAIN_Q16_ONE, GAIN_Q16_ONE, GAIN_Q16_ONE, GAIN_Q16_ONE };
+    u32 out[4];
+
+    applyStereoGainQ16(in, out, gain, 4);
+    TEST_ASSERT_EQUAL_MEMORY(in, out, sizeof(in));
+}
@@ -0,0 +1,81 @@
+#include "mock_3ds.h"
+#include "audio_stats.h"
+#include "unity.h"
+
+// Every duration lands in a bucket whose bounds contain it, and buckets never overlap
+void test_stats_buckets_cover_durations_in_order(void) {
+    u32 prev_upper = 0;
+    for (u32 idx = 0; idx < STATS_BUCKETS; idx++) {
+        u32 upper = statsBucketUpper(idx);
+        if (idx > 0) {
+            TEST_ASSERT_TRUE(upper > prev_upper);
+            TEST_ASSERT_EQUAL_UINT32(idx, statsBucketIndex(prev_upper + 1));
+        }
+        TEST_ASSERT_EQUAL_UINT32(idx, statsBucketIndex(upper));
+        prev_upper = upper;
+    }
+    TEST_ASSERT_EQUAL_UINT32(0xFFFFFFFFu, prev_upper);
+
+    // Bucket width stays within 1/8 of the value it holds
+    const u32 samples[] = { 9, 100, 4321, 268111, 32173422 };
+    for (int i = 0; i < 5; i++) {
+        u32 upper = statsBucketUpper(statsBucketIndex(samples[i]));
+        TEST_ASSERT_TRUE(upper >= samples[i]);
+        TEST_ASSERT_TRUE(upper - samples[i] <= samples[i] / 8);
+    }
+}
+
+void test_stats_percentiles_follow_recorded_durations(void) {
+    static AudioStats stats;
+    audioStatsReset(&stats);
+    TEST_ASSERT_EQUAL_UINT32(0, statsPercentile(&stats.stages[STAGE_WAKE], 50));
+
+    audioStatsBeginWrite(&stats);
+    // 1000 short blocks and 10 long ones
+    for (int i = 0; i < 1000; i++) {
+        audioStatsRecord(&stats, STAGE_WAKE, 1000 + i);
+    }
+    for (int i = 0; i < 10; i++) {
+        audioStatsRecord(&stats, STAGE_WAKE, 500000);
+    }
+    audioStatsEndWrite(&stats);
+
+    const StageHistogram *hist = &stats.stages[STAGE_WAKE];
+    TEST_ASSERT_EQUAL_UINT32(1010, hist->count);
+    TEST_ASSERT_EQUAL_UINT32(500000, hist->max);
+
+    u32 p50 = statsPercentile(hist, 50);
+    TEST_ASSERT_TRUE(p50 >= 1504 && p50 <= 1504 + 1504 / 8);
+    u32 p99 = statsPercentile(hist, 99);
+    TEST_ASSERT_TRUE(p99 >= 1999 && p99 < 500000);
+    TEST_ASSERT_EQUAL_UINT32(500000, statsPercentile(hist, 100));
+}
+
+void test_stats_snapshot_rejects_writes_in_progress(void) {
+    static AudioStats stats;
+    static AudioStats copy;
+    audioStatsReset(&stats);
+
+    audioStatsBeginWrite(&stats);
+    stats.underruns = 3;
+    TEST_ASSERT_FALSE(audioStatsSnapshot(&stats, &copy));
+    audioStatsEndWrite(&stats);
+
+    TEST_ASSERT_TRUE(audioStatsSnapshot(&stats, &copy));
+    TEST_ASSERT_EQUAL_UINT32(3, copy.underruns);
+}
+
+void test_stats_load_is_busy_share_of_window(void) {
+    static AudioStats stats;
+    audioStatsReset(&stats);
+
+    u64 now  = 1000;
+    u64 step = STATS_LOAD_WINDOW / 100;
+    audioStatsAddBusy(&stats, 0, now);
+    // One step past the window so it closes
+    for (int i = 0; i < 101; i++) {
+        now += step;
+        audioStatsAddBusy(&stats, step / 4, now);
+    }
+    TEST_ASSERT_UINT32_WITHIN(1, 250, stats.load_permille);
+}
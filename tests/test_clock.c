@@ -2,102 +2,180 @@
 #include "clock.h"
 #include "unity.h"
 #include <math.h>
+#include <stdio.h>
 
-// This must match the value in clock.c
-#define CLOCK_RESOLUTION_SHIFT 8
+#define TEST_SAMPLERATE 32000.0f
 
-// Helper to get the precise unscaled ticks per step for tests
-double get_unscaled_ticks_per_step_f(float bpm) {
-    double ticks_per_beat = (double) SYSCLOCK_ARM11 * 60.0 / bpm;
-    return ticks_per_beat / STEPS_PER_BEAT;
+// Helper to get the precise frames per step for tests
+double get_frames_per_step_f(float bpm) {
+    return TEST_SAMPLERATE * 60.0 / bpm / STEPS_PER_BEAT;
 }
 
-void test_setBpm_calculates_correct_ticks_per_step(void) {
+// A playing clock at the given tempo, a full step away from its next tick
+static Clock stepStartClock(MusicalTime *mt, float bpm) {
+    Clock clock = { .samplerate = TEST_SAMPLERATE, .barBeats = mt };
+    setBpm(&clock, bpm);
+    startClock(&clock);
+    clock.phase = 0; // Override priming for this test
+    return clock;
+}
+
+void test_setBpm_calculates_correct_frames_per_step(void) {
     MusicalTime mt    = { 0 };
-    Clock       clock = { .barBeats = &mt };
+    Clock       clock = { .samplerate = TEST_SAMPLERATE, .barBeats = &mt };
 
     setBpm(&clock, 120.0f);
 
-    double unscaled_ticks_per_step_f = get_unscaled_ticks_per_step_f(120.0f);
-    u64 expected_ticks_per_step = (u64) (unscaled_ticks_per_step_f * (1 << CLOCK_RESOLUTION_SHIFT));
-
-    TEST_ASSERT_EQUAL_UINT64(expected_ticks_per_step, clock.ticks_per_step);
+    u64 expected_frames_per_step =
+        (u64) (get_frames_per_step_f(120.0f) * ((u64) 1 << CLOCK_FRAME_SHIFT));
+    TEST_ASSERT_EQUAL_UINT64(expected_frames_per_step, clock.frames_per_step);
 }
 
-void test_updateClock_should_not_tick_if_not_enough_time_has_passed(void) {
+void test_advanceClock_should_not_tick_if_not_enough_frames_have_passed(void) {
     MusicalTime mt    = { 0 };
-    Clock       clock = { .barBeats = &mt };
-    setBpm(&clock, 120.0f);
-    startClock(&clock);
-    clock.time_accumulator = 0; // Override priming for this test
+    Clock       clock = stepStartClock(&mt, 120.0f);
+    u16         offsets[MAX_TICKS_PER_BLOCK];
 
-    double unscaled_ticks_per_step_f = get_unscaled_ticks_per_step_f(120.0f);
-
-    // Advance time by less than one step
-    mock_advance_system_tick((u64) unscaled_ticks_per_step_f - 1);
-
-    int ticked = updateClock(&clock);
+    // Advance by less than one step
+    u32 frames = (u32) get_frames_per_step_f(120.0f);
+    int ticked = advanceClock(&clock, frames, offsets, MAX_TICKS_PER_BLOCK);
 
     TEST_ASSERT_EQUAL(0, ticked);
 }
 
-void test_updateClock_should_tick_and_update_musical_time(void) {
+void test_advanceClock_should_tick_after_one_step_of_frames(void) {
     MusicalTime mt    = { 0 };
-    Clock       clock = { .barBeats = &mt };
-    setBpm(&clock, 120.0f);
-    startClock(&clock);
-    clock.time_accumulator = 0; // Override priming for this test
-
-    double unscaled_ticks_per_step_f = get_unscaled_ticks_per_step_f(120.0f);
+    Clock       clock = stepStartClock(&mt, 120.0f);
+    u16         offsets[MAX_TICKS_PER_BLOCK];
 
-    // Advance time by exactly one step, rounding up to ensure the threshold is met.
-    mock_advance_system_tick((u64) ceil(unscaled_ticks_per_step_f));
-
-    int ticked = updateClock(&clock);
+    // Advance by one step, rounding up to ensure the threshold is met
+    u32 frames = (u32) ceil(get_frames_per_step_f(120.0f));
+    int ticked = advanceClock(&clock, frames, offsets, MAX_TICKS_PER_BLOCK);
 
     TEST_ASSERT_EQUAL(1, ticked);
 }
 
-void test_updateClock_accumulator_handles_remainder(void) {
+void test_advanceClock_accumulator_handles_remainder(void) {
     MusicalTime mt    = { 0 };
-    Clock       clock = { .barBeats = &mt };
-    setBpm(&clock, 120.0f);
-    startClock(&clock);
-    clock.time_accumulator = 0; // Override priming for this test
+    Clock       clock = stepStartClock(&mt, 120.0f);
+    u16         offsets[MAX_TICKS_PER_BLOCK];
+    double      frames_per_step = get_frames_per_step_f(120.0f);
 
-    double unscaled_ticks_per_step_f = get_unscaled_ticks_per_step_f(120.0f);
-
-    // --- First Tick ---
     // Advance by ~1.5 steps. This should cause exactly one tick.
-    u64 advance1 = (u64) ceil(unscaled_ticks_per_step_f * 1.5);
-    mock_advance_system_tick(advance1);
+    u32 advance1 = (u32) ceil(frames_per_step * 1.5);
+    TEST_ASSERT_EQUAL(1, advanceClock(&clock, advance1, offsets, MAX_TICKS_PER_BLOCK));
 
-    int ticked = updateClock(&clock);
-    TEST_ASSERT_EQUAL(1, ticked);
+    // The remaining frames up to the 2-step mark should tick again
+    u32 advance2 = (u32) ceil(frames_per_step * 2.0) - advance1;
+    TEST_ASSERT_EQUAL(1, advanceClock(&clock, advance2, offsets, MAX_TICKS_PER_BLOCK));
+}
 
-    // --- Second Tick ---
-    // Calculate the total time needed for two full steps from the beginning.
-    u64 total_ticks_for_2_steps = (u64) ceil(unscaled_ticks_per_step_f * 2.0);
-    // Calculate the remaining time we need to advance to reach the 2-step mark.
-    u64 advance2 = total_ticks_for_2_steps - advance1;
-    mock_advance_system_tick(advance2);
+void test_setBpm_keeps_phase_across_tempo_change(void) {
+    MusicalTime mt    = { 0 };
+    Clock       clock = stepStartClock(&mt, 120.0f);
+    u16         offsets[MAX_TICKS_PER_BLOCK];
+
+    // A third of the way into a step at 120 BPM, then half the tempo: still a third of the way
+    u32 frames = (u32) (get_frames_per_step_f(120.0f) / 3);
+    TEST_ASSERT_EQUAL(0, advanceClock(&clock, frames, offsets, MAX_TICKS_PER_BLOCK));
+    double before = (double) clock.phase / clock.frames_per_step;
+    setBpm(&clock, 60.0f);
+    double after = (double) clock.phase / clock.frames_per_step;
+    TEST_ASSERT_TRUE(fabs(after - before) < 1e-6);
+
+    // The rest of the step is two thirds of a step at the new tempo
+    double rest = get_frames_per_step_f(60.0f) * (1.0 - after);
+    TEST_ASSERT_EQUAL(0, advanceClock(&clock, (u32) rest - 1, offsets, MAX_TICKS_PER_BLOCK));
+    TEST_ASSERT_EQUAL(1, advanceClock(&clock, 2, offsets, MAX_TICKS_PER_BLOCK));
+}
 
-    ticked = updateClock(&clock);
-    TEST_ASSERT_EQUAL(1, ticked); // Should tick again
+void test_clockDisplayRead_skips_a_publish_in_progress(void) {
+    ClockDisplayState state     = { 0 };
+    ClockDisplay      published = { .bar = 3, .beat = 1, .bpm = 97.0f, .status = PLAYING };
+
+    clockDisplayPublish(&state, &published);
+    ClockDisplay read = clockDisplayRead(&state);
+    TEST_ASSERT_EQUAL(3, read.bar);
+    TEST_ASSERT_EQUAL(PLAYING, read.status);
+
+    // A writer caught half way: the reader keeps the last consistent state
+    state.seq++;
+    state.display.bar = 4;
+    read              = clockDisplayRead(&state);
+    TEST_ASSERT_EQUAL(3, read.bar);
+    TEST_ASSERT_EQUAL_FLOAT(97.0f, read.bpm);
 }
 
-void test_updateClock_does_not_tick_when_stopped(void) {
+void test_advanceClock_places_ticks_within_one_sample(void) {
+    const float bpms[]        = { 60.0f, 97.0f, 120.0f, 143.5f, 173.0f, 200.0f };
+    const u32   block_samples = 3840;
+    const float samplerate    = TEST_SAMPLERATE;
+    const int   n_blocks      = 250; // 30 seconds
+
+    for (size_t b = 0; b < sizeof(bpms) / sizeof(bpms[0]); b++) {
+        MusicalTime mt    = { 0 };
+        Clock       clock = { .samplerate = samplerate, .barBeats = &mt };
+        setBpm(&clock, bpms[b]);
+        startClock(&clock);
+
+        double samples_per_tick = samplerate * 60.0 / bpms[b] / STEPS_PER_BEAT;
+        double max_error        = 0.0;
+        double max_block_error  = 0.0;
+        int    ticks            = 0;
+        for (int block = 0; block < n_blocks; block++) {
+            u16 offsets[MAX_TICKS_PER_BLOCK];
+            int n = advanceClock(&clock, block_samples, offsets, MAX_TICKS_PER_BLOCK);
+            for (int i = 0; i < n; i++) {
+                double ideal = ticks * samples_per_tick;
+                double at =
+                    (double) block * block_samples + clockOffsetToFrames(offsets[i], block_samples);
+                max_error       = fmax(max_error, fabs(at - ideal));
+                max_block_error = fmax(max_block_error, fabs(block * block_samples - ideal));
+                ticks++;
+            }
+        }
+
+        char msg[96];
+        snprintf(msg, sizeof(msg), "%.1f BPM: max error %.3f samples (block start: %.0f)",
+                 bpms[b], max_error, max_block_error);
+        TEST_MESSAGE(msg);
+        // No tick lost or doubled (the last one may sit right on the end of the run)
+        TEST_ASSERT_TRUE(fabs(ticks - n_blocks * block_samples / samples_per_tick) <= 1.0);
+        TEST_ASSERT_TRUE(max_error <= 1.0);
+    }
+}
+
+void test_advanceClock_does_not_tick_when_stopped(void) {
     MusicalTime mt    = { 0 };
-    Clock       clock = { .barBeats = &mt };
+    Clock       clock = { .samplerate = TEST_SAMPLERATE, .barBeats = &mt };
+    u16         offsets[MAX_TICKS_PER_BLOCK];
     setBpm(&clock, 120.0f);
-    startClock(&clock);
-    stopClock(&clock);
 
-    double unscaled_ticks_per_step_f = get_unscaled_ticks_per_step_f(120.0f);
+    int ticked = advanceClock(&clock, 3840, offsets, MAX_TICKS_PER_BLOCK);
 
-    mock_advance_system_tick((u64) unscaled_ticks_per_step_f * 2);
+    TEST_ASSERT_EQUAL(0, ticked);
+}
 
-    int ticked = updateClock(&clock);
+void test_advanceMusicalTime_rolls_beats_into_bars(void) {
+    MusicalTime mt    = { .beats_per_bar = 4 };
+    Clock       clock = { .barBeats = &mt };
 
-    TEST_ASSERT_EQUAL(0, ticked);
+    advanceMusicalTime(&clock);
+    TEST_ASSERT_EQUAL(1, mt.steps);
+    TEST_ASSERT_EQUAL(0, mt.bar);
+    TEST_ASSERT_EQUAL(0, mt.beat);
+    TEST_ASSERT_EQUAL(0, mt.deltaStep);
+
+    // Last step of the first bar, then the first step of the second
+    for (int i = 1; i < 4 * STEPS_PER_BEAT; i++) {
+        advanceMusicalTime(&clock);
+    }
+    TEST_ASSERT_EQUAL(0, mt.bar);
+    TEST_ASSERT_EQUAL(3, mt.beat);
+    TEST_ASSERT_EQUAL(STEPS_PER_BEAT - 1, mt.deltaStep);
+
+    advanceMusicalTime(&clock);
+    TEST_ASSERT_EQUAL(1, mt.bar);
+    TEST_ASSERT_EQUAL(0, mt.beat);
+    TEST_ASSERT_EQUAL(0, mt.deltaStep);
 }
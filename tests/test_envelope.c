@@ -75,4 +75,117 @@ void test_envelope_adsr_progression(void) {
     }
     TEST_ASSERT_EQUAL(ENVELOPE_STATE_IDLE, env.state);
     TEST_ASSERT_EQUAL_FLOAT(0.0f, env.output);
-}
\ No newline at end of file
+}
+
+// Per-sample state machine as it was before block rendering, kept as the reference the block
+// renderer has to reproduce exactly
+static float referenceEnvelopeSample(Envelope *env) {
+    switch (env->state) {
+    case ENVELOPE_STATE_IDLE:
+        env->output = 0.0f;
+        break;
+    case ENVELOPE_STATE_ATTACK:
+        env->output += env->attack_rate;
+        if (env->output >= 1.0f) {
+            env->output = 1.0f;
+            env->state  = ENVELOPE_STATE_DECAY;
+        }
+        break;
+    case ENVELOPE_STATE_DECAY:
+        env->output -= env->decay_rate;
+        if (env->output <= env->sustain_level) {
+            env->output  = env->sustain_level;
+            env->state   = ENVELOPE_STATE_SUSTAIN;
+            env->env_pos = 0;
+        }
+        break;
+    case ENVELOPE_STATE_SUSTAIN:
+        env->env_pos++;
+        if (env->env_pos >= env->dur_samples) {
+            env->state = ENVELOPE_STATE_RELEASE;
+        }
+        break;
+    case ENVELOPE_STATE_RELEASE:
+        env->output -= env->release_rate;
+        if (env->output <= 0.0f) {
+            env->output = 0.0f;
+            env->state  = ENVELOPE_STATE_IDLE;
+        }
+        break;
+    }
+    return env->output;
+}
+
+#define BLOCK_TEST_SAMPLES 24000
+
+typedef struct {
+    float sr;
+    int   attack_ms, decay_ms;
+    float sustain;
+    int   release_ms, dur_ms;
+} EnvelopeConfig;
+
+// Runs the reference and the block renderer side by side for a whole note, with a retrigger and
+// an early release part way through, and fails on the first differing sample
+static void assertBlockMatchesReference(const EnvelopeConfig *cfg, size_t block) {
+    Envelope ref = defaultEnvelopeStruct(cfg->sr);
+    updateEnvelope(&ref, cfg->attack_ms, cfg->decay_ms, cfg->sustain, cfg->release_ms,
+                   cfg->dur_ms);
+    Envelope blk = ref;
+    triggerEnvelope(&ref);
+    triggerEnvelope(&blk);
+
+    static float expected[BLOCK_TEST_SAMPLES];
+    static float actual[BLOCK_TEST_SAMPLES];
+
+    size_t pos = 0;
+    while (pos < BLOCK_TEST_SAMPLES) {
+        size_t n = BLOCK_TEST_SAMPLES - pos < block ? BLOCK_TEST_SAMPLES - pos : block;
+        for (size_t i = 0; i < n; i++) {
+            expected[pos + i] = referenceEnvelopeSample(&ref);
+        }
+        renderEnvelopeBlock(&blk, &actual[pos], n);
+        pos += n;
+
+        // Events land on block boundaries, like they do in the audio thread
+        if (pos == 7 * block) {
+            triggerEnvelope(&ref);
+            triggerEnvelope(&blk);
+        } else if (pos == 13 * block) {
+            releaseEnvelope(&ref);
+            releaseEnvelope(&blk);
+        } else if (pos == 40 * block) {
+            triggerEnvelope(&ref);
+            triggerEnvelope(&blk);
+        }
+
+        TEST_ASSERT_EQUAL(ref.state, blk.state);
+        TEST_ASSERT_EQUAL_UINT32(ref.env_pos, blk.env_pos);
+    }
+
+    TEST_ASSERT_EQUAL_MEMORY(expected, actual, sizeof(expected));
+}
+
+void test_envelope_block_matches_per_sample_reference(void) {
+    const EnvelopeConfig configs[] = {
+        { 32000.0f, 10, 10, 0.5f, 10, 100 },  { 48000.0f, 1, 3, 0.8f, 7, 20 },
+        { 32000.0f, 50, 200, 0.1f, 300, 50 }, { 44100.0f, 3, 0, 0.7f, 0, 5 },
+        { 48000.0f, 0, 10, 0.5f, 10, 100 },   { 32000.0f, 2, 2, 1.0f, 2, 0 },
+        { 48000.0f, 333, 77, 0.0f, 999, 13 },
+    };
+    const size_t blocks[] = { 1, 3, 64, 100, 3840 };
+
+    for (size_t c = 0; c < sizeof(configs) / sizeof(configs[0]); c++) {
+        for (size_t b = 0; b < sizeof(blocks) / sizeof(blocks[0]); b++) {
+            assertBlockMatchesReference(&configs[c], blocks[b]);
+        }
+    }
+}
+
+void test_envelope_block_handles_null_envelope(void) {
+    float out[8] = { 1, 1, 1, 1, 1, 1, 1, 1 };
+    renderEnvelopeBlock(NULL, out, 8);
+    for (int i = 0; i < 8; i++) {
+        TEST_ASSERT_EQUAL_FLOAT(0.0f, out[i]);
+    }
+}
@@ -13,8 +13,7 @@ void test_event_queue_init_should_set_head_and_tail_to_zero(void) {
 void test_event_queue_push_and_pop_should_work_correctly(void) {
     EventQueue q;
     eventQueueInit(&q);
-    TrackParameters tp = { .track_id = 1 };
-    Event e_push       = { .type = TRIGGER_STEP, .track_id = 1, .data.step_data.base_params = tp };
+    Event e_push = { .type = SET_BPM, .track_id = 1, .data.bpm_data.bpm = 97.0f };
 
     bool pushed = eventQueuePush(&q, e_push);
     TEST_ASSERT_TRUE(pushed);
@@ -23,23 +22,48 @@ void test_event_queue_push_and_pop_should_work_correctly(void) {
     bool  popped = eventQueuePop(&q, &e_pop);
     TEST_ASSERT_TRUE(popped);
     TEST_ASSERT_EQUAL(e_push.type, e_pop.type);
-    TEST_ASSERT_EQUAL(e_push.data.step_data.base_params.track_id,
-                      e_pop.data.step_data.base_params.track_id);
+    TEST_ASSERT_EQUAL(e_push.track_id, e_pop.track_id);
+    TEST_ASSERT_EQUAL_FLOAT(97.0f, e_pop.data.bpm_data.bpm);
+}
+
+void test_event_queue_step_payloads_are_pooled(void) {
+    EventQueue q;
+    eventQueueInit(&q);
+    StepParameters step = defaultStepParameters(3, SUB_SYNTH);
+    step.instrument.subsynth_params.osc_freq = 440.0f;
+
+    // Each step event holds a payload until the consumer hands it back
+    for (int i = 0; i < EVENT_PAYLOAD_SLOTS; i++) {
+        TEST_ASSERT_TRUE(eventQueuePushStep(&q, UPDATE_STEP, 3, SUB_SYNTH, &step));
+    }
+    TEST_ASSERT_FALSE(eventQueuePushStep(&q, UPDATE_STEP, 3, SUB_SYNTH, &step));
+
+    Event e;
+    TEST_ASSERT_TRUE(eventQueuePop(&q, &e));
+    TEST_ASSERT_EQUAL(UPDATE_STEP, e.type);
+    const StepPayload *payload = eventQueuePayload(&q, &e);
+    TEST_ASSERT_NOT_NULL(payload);
+    TEST_ASSERT_EQUAL(SUB_SYNTH, payload->instrument_type);
+    TEST_ASSERT_EQUAL_INT(3, payload->params.track.track_id);
+    TEST_ASSERT_EQUAL_FLOAT(440.0f, payload->params.instrument.subsynth_params.osc_freq);
+
+    // Popped but not released, the slot is still taken
+    TEST_ASSERT_FALSE(eventQueuePushStep(&q, UPDATE_STEP, 3, SUB_SYNTH, &step));
+    eventQueueReleasePayload(&q, &e);
+    TEST_ASSERT_TRUE(eventQueuePushStep(&q, TRIGGER_STEP, 3, SUB_SYNTH, &step));
 }
 
 void test_event_queue_should_not_push_when_full(void) {
     EventQueue q;
     eventQueueInit(&q);
 
-    for (int i = 0; i < EVENT_QUEUE_SIZE - 1; i++) {
-        TrackParameters tp = { .track_id = i };
-        Event e      = { .type = TRIGGER_STEP, .track_id = i, .data.step_data.base_params = tp };
+    for (int i = 0; i < EVENT_QUEUE_SIZE; i++) {
+        Event e      = { .type = SET_MUTE, .track_id = i };
         bool  pushed = eventQueuePush(&q, e);
         TEST_ASSERT_TRUE(pushed);
     }
 
-    TrackParameters tp_full = { .track_id = 99 };
-    Event e_full = { .type = TRIGGER_STEP, .track_id = 99, .data.step_data.base_params = tp_full };
+    Event e_full = { .type = SET_MUTE, .track_id = 99 };
     bool  pushed = eventQueuePush(&q, e_full);
     TEST_ASSERT_FALSE(pushed);
 }
@@ -57,9 +81,8 @@ void test_event_queue_wraparound_should_work_correctly(void) {
     eventQueueInit(&q);
 
     // Fill the queue
-    for (int i = 0; i < EVENT_QUEUE_SIZE - 1; i++) {
-        TrackParameters tp = { .track_id = i };
-        Event e      = { .type = TRIGGER_STEP, .track_id = i, .data.step_data.base_params = tp };
+    for (int i = 0; i < EVENT_QUEUE_SIZE; i++) {
+        Event e      = { .type = SET_MUTE, .track_id = i };
         bool  pushed = eventQueuePush(&q, e);
         TEST_ASSERT_TRUE(pushed);
     }
@@ -73,27 +96,26 @@ void test_event_queue_wraparound_should_work_correctly(void) {
 
     // Push more events to force wraparound
     for (int i = 0; i < 5; i++) {
-        TrackParameters tp = { .track_id = i + 20 };
-        Event e = { .type = TRIGGER_STEP, .track_id = i + 20, .data.step_data.base_params = tp };
+        Event e      = { .type = SET_MUTE, .track_id = i + 40 };
         bool  pushed = eventQueuePush(&q, e);
         TEST_ASSERT_TRUE(pushed);
     }
 
     // Pop remaining events and check their values
-    for (int i = 5; i < EVENT_QUEUE_SIZE - 1; i++) {
+    for (int i = 5; i < EVENT_QUEUE_SIZE; i++) {
         Event e;
         bool  popped = eventQueuePop(&q, &e);
         TEST_ASSERT_TRUE(popped);
-        TEST_ASSERT_EQUAL(TRIGGER_STEP, e.type);
-        TEST_ASSERT_EQUAL(i, e.data.step_data.base_params.track_id);
+        TEST_ASSERT_EQUAL(SET_MUTE, e.type);
+        TEST_ASSERT_EQUAL(i, e.track_id);
     }
 
     for (int i = 0; i < 5; i++) {
         Event e;
         bool  popped = eventQueuePop(&q, &e);
         TEST_ASSERT_TRUE(popped);
-        TEST_ASSERT_EQUAL(TRIGGER_STEP, e.type);
-        TEST_ASSERT_EQUAL(i + 20, e.data.step_data.base_params.track_id);
+        TEST_ASSERT_EQUAL(SET_MUTE, e.type);
+        TEST_ASSERT_EQUAL(i + 40, e.track_id);
     }
 
     // Queue should be empty now
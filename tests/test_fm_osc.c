@@ -0,0 +1,63 @@
+#include "mock_3ds.h"
+#include "engine_constants.h"
+#include "fm_osc.h"
+#include "unity.h"
+
+#include <math.h>
+
+#define FM_TEST_RATE 32000.0f
+
+static void setupSynth(FMSynth *fm, int algorithm) {
+    initFMSynth(fm, FM_TEST_RATE);
+    FMSetAlgorithm(fm, algorithm);
+    FMSetModIndex(fm, 3.0f);
+    FMSetFeedback(fm, 0.4f);
+    for (int op = 0; op < FM_OPERATORS; op++) {
+        // Different lengths so operators go idle at different points of a block
+        updateEnvelope(&fm->ops[op].env, 1 + op * 3, 50, 0.5f, 20, 40 + op * 10);
+        FMSetOperator(fm, op, (float) (op + 1), 0.7f);
+    }
+    FMSetFrequency(fm, 330.0f);
+    triggerFMSynth(fm);
+}
+
+void test_fm_algorithms_route_to_operator_one(void) {
+    FMSynth fm;
+    initFMSynth(&fm, FM_TEST_RATE);
+    for (int a = 0; a < FM_ALGORITHM_COUNT; a++) {
+        FMSetAlgorithm(&fm, a);
+        TEST_ASSERT_TRUE(FMIsCarrier(&fm, 0));
+        TEST_ASSERT_NOT_NULL(fm_algorithm_names[a]);
+    }
+
+    FMSetAlgorithm(&fm, FM_ALGO_STACK);
+    TEST_ASSERT_FALSE(FMIsCarrier(&fm, 3));
+    FMSetAlgorithm(&fm, FM_ALGO_ADDITIVE);
+    TEST_ASSERT_TRUE(FMIsCarrier(&fm, 3));
+
+    // Out of range algorithms are ignored
+    FMSetAlgorithm(&fm, FM_ALGORITHM_COUNT);
+    TEST_ASSERT_EQUAL(FM_ALGO_ADDITIVE, fm.algorithm);
+}
+
+void test_fm_block_matches_per_sample_and_goes_idle(void) {
+    initSineTable();
+    for (int a = 0; a < FM_ALGORITHM_COUNT; a++) {
+        FMSynth block, ref;
+        setupSynth(&block, a);
+        setupSynth(&ref, a);
+
+        s16 out[50];
+        int nonzero = 0;
+        for (int b = 0; b < 200; b++) {
+            renderFMBlock(&block, out, 50);
+            for (int i = 0; i < 50; i++) {
+                s16 r = (s16) lrintf(nextFMOscillatorSample(&ref) * 32768.0f);
+                TEST_ASSERT_EQUAL_INT16(r, out[i]);
+                nonzero += out[i] != 0;
+            }
+        }
+        TEST_ASSERT_TRUE(nonzero > 0);
+        TEST_ASSERT_TRUE(FMIsIdle(&block));
+    }
+}
@@ -0,0 +1,359 @@
+#include "mock_3ds.h"
+#include "audio_simd.h"
+#include "engine_constants.h"
+#include "noise_synth.h"
+#include "samplers.h"
+#include "sine_table.h"
+#include "synth.h"
+#include "unity.h"
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Golden-audio regression tests. Each case renders a fixed parameter set through an instrument's
+// real render path and hashes the int16 output against golden_hashes.inc. A hash mismatch alone is
+// not a failure when the case allows a tolerance: the output is then compared with a reference
+// render (exact sine, or the per-sample path) and must stay within the SNR and peak error limits.
+//
+//   GOLDEN_UPDATE=1      print the current hashes in table form instead of checking them:
+//                        GOLDEN_UPDATE=1 build/tests/test_runner | grep '^    {' > <the .inc>
+//   GOLDEN_STRICT=1      require every hash to match
+//   GOLDEN_MIN_SNR_DB=x  override the SNR limit of every case with a tolerance
+//   GOLDEN_MAX_PEAK=n    override the peak error limit (in LSB) of every case with a tolerance
+
+#define GOLDEN_FRAMES 8000
+#define GOLDEN_BLOCK 1000 // rendered in blocks, the way the audio thread calls the instruments
+#define GOLDEN_SAMPLE_FRAMES 4000
+
+typedef struct {
+    const char *name;
+    u64         hash;
+} GoldenHash;
+
+static const GoldenHash golden_hashes[] = {
+#include "golden_hashes.inc"
+};
+
+typedef struct {
+    int   atk, dec;
+    float sus;
+    int   rel, dur;
+} EnvConfig;
+
+// A percussive hit that finishes inside the render, and a pad released two thirds of the way in
+static const EnvConfig env_configs[] = { { 1, 40, 0.0f, 10, 60 }, { 30, 200, 0.6f, 150, 180 } };
+#define N_ENV_CONFIGS (int) (sizeof(env_configs) / sizeof(env_configs[0]))
+
+// Tolerances for when a hash is allowed to move: the sine LUT against libm (about 92 dB today),
+// and rounding differences against the per-sample float path (the sampler's Q16 gain is ~80 dB)
+#define SINE_LUT_MIN_SNR_DB 80.0
+#define SINE_LUT_MAX_PEAK 4
+#define FLOAT_PATH_MIN_SNR_DB 75.0
+#define FLOAT_PATH_MAX_PEAK 2
+
+static s16 s_out[GOLDEN_FRAMES * NCHANNELS];
+static s16 s_ref[GOLDEN_FRAMES * NCHANNELS];
+static u32 s_block[GOLDEN_BLOCK];
+
+static bool envFlag(const char *name) {
+    const char *v = getenv(name);
+    return v && *v && strcmp(v, "0") != 0;
+}
+
+// FNV-1a over the samples as little-endian int16, independent of host byte order
+static u64 hashSamples(const s16 *samples, size_t n) {
+    u64 h = 0xcbf29ce484222325ull;
+    for (size_t i = 0; i < n; i++) {
+        u16 s = (u16) samples[i];
+        h     = (h ^ (s & 0xFF)) * 0x100000001b3ull;
+        h     = (h ^ (s >> 8)) * 0x100000001b3ull;
+    }
+    return h;
+}
+
+static void compareSamples(const s16 *out, const s16 *ref, size_t n, double *snr_db, int *peak) {
+    double signal = 0.0, noise = 0.0;
+    *peak         = 0;
+    for (size_t i = 0; i < n; i++) {
+        int err = out[i] - ref[i];
+        signal += (double) ref[i] * ref[i];
+        noise += (double) err * err;
+        *peak = abs(err) > *peak ? abs(err) : *peak;
+    }
+    *snr_db = noise == 0.0 ? INFINITY : 10.0 * log10(signal / noise);
+}
+
+static void unpackFrames(const u32 *frames, s16 *out, size_t n) {
+    for (size_t i = 0; i < n; i++) {
+        out[i * NCHANNELS]     = (s16) (frames[i] & 0xFFFF);
+        out[i * NCHANNELS + 1] = (s16) (frames[i] >> 16);
+    }
+}
+
+// Checks s_out against the golden hash for name. ref may be NULL for cases that must be exact.
+static void checkGolden(const char *name, const s16 *ref, double min_snr_db, int max_peak) {
+    size_t n    = GOLDEN_FRAMES * NCHANNELS;
+    u64    hash = hashSamples(s_out, n);
+    if (envFlag("GOLDEN_UPDATE")) {
+        printf("    { \"%s\", 0x%016llxull },\n", name, (unsigned long long) hash);
+        return;
+    }
+
+    const GoldenHash *golden = NULL;
+    for (size_t i = 0; i < sizeof(golden_hashes) / sizeof(golden_hashes[0]); i++) {
+        if (strcmp(golden_hashes[i].name, name) == 0) {
+            golden = &golden_hashes[i];
+        }
+    }
+    char msg[256];
+    if (!golden) {
+        snprintf(msg, sizeof(msg), "%s: no golden hash, run with GOLDEN_UPDATE=1", name);
+        TEST_FAIL_MESSAGE(msg);
+        return;
+    }
+    if (golden->hash == hash) {
+        return;
+    }
+
+    if (!ref || envFlag("GOLDEN_STRICT")) {
+        snprintf(msg, sizeof(msg), "%s: hash 0x%016llx, expected 0x%016llx", name,
+                 (unsigned long long) hash, (unsigned long long) golden->hash);
+        TEST_FAIL_MESSAGE(msg);
+        return;
+    }
+
+    const char *snr_override  = getenv("GOLDEN_MIN_SNR_DB");
+    const char *peak_override = getenv("GOLDEN_MAX_PEAK");
+    min_snr_db                = snr_override ? atof(snr_override) : min_snr_db;
+    max_peak                  = peak_override ? atoi(peak_override) : max_peak;
+
+    double snr_db;
+    int    peak;
+    compareSamples(s_out, ref, n, &snr_db, &peak);
+    snprintf(msg, sizeof(msg), "%s: hash changed, SNR %.1f dB (min %.1f), peak error %d (max %d)",
+             name, snr_db, min_snr_db, peak, max_peak);
+    if (snr_db < min_snr_db || peak > max_peak) {
+        TEST_FAIL_MESSAGE(msg);
+    } else {
+        TEST_MESSAGE(msg);
+    }
+}
+
+static Envelope makeEnvelope(const EnvConfig *cfg, float rate) {
+    Envelope env = defaultEnvelopeStruct(rate);
+    updateEnvelope(&env, cfg->atk, cfg->dec, cfg->sus, cfg->rel, cfg->dur);
+    triggerEnvelope(&env);
+    return env;
+}
+
+typedef struct {
+    Waveform    waveform;
+    float       pulse_width;
+    const char *name;
+} SubSynthShape;
+
+static const SubSynthShape sub_shapes[] = { { SINE, 0.5f, "sine" },
+                                            { SQUARE, 0.5f, "square50" },
+                                            { SQUARE, 0.25f, "square25" },
+                                            { SAW, 0.5f, "saw" },
+                                            { TRIANGLE, 0.5f, "triangle" } };
+static const float         sub_freqs[]  = { 110.0f, 1760.0f };
+
+static void setupSubSynth(SubSynth *ss, PolyBLEPOscillator *osc, Envelope *env,
+                          const SubSynthShape *shape, float freq, const EnvConfig *cfg) {
+    *osc = (PolyBLEPOscillator) { .samplerate = SAMPLERATE, .pulse_width = shape->pulse_width };
+    setWaveform(osc, shape->waveform);
+    setOscFrequency(osc, freq);
+    *env = makeEnvelope(cfg, SAMPLERATE);
+    *ss  = (SubSynth) { .osc = osc, .env = env };
+}
+
+void test_golden_subsynth_sweep(void) {
+    initSineTable();
+    for (size_t s = 0; s < sizeof(sub_shapes) / sizeof(sub_shapes[0]); s++) {
+        for (size_t f = 0; f < sizeof(sub_freqs) / sizeof(sub_freqs[0]); f++) {
+            for (int e = 0; e < N_ENV_CONFIGS; e++) {
+                SubSynth           ss;
+                PolyBLEPOscillator osc;
+                Envelope           env;
+                setupSubSynth(&ss, &osc, &env, &sub_shapes[s], sub_freqs[f], &env_configs[e]);
+                for (int pos = 0; pos < GOLDEN_FRAMES; pos += GOLDEN_BLOCK) {
+                    renderSubSynthAudio(s_block, GOLDEN_BLOCK, &ss);
+                    unpackFrames(s_block, &s_out[pos * NCHANNELS], GOLDEN_BLOCK);
+                }
+
+                // Reference: the sine from libm on the same phase, the rest per sample
+                setupSubSynth(&ss, &osc, &env, &sub_shapes[s], sub_freqs[f], &env_configs[e]);
+                for (int i = 0; i < GOLDEN_FRAMES; i++) {
+                    float x;
+                    if (osc.waveform == SINE) {
+                        x = (float) sin(osc.phase * (2.0 * M_PI / 4294967296.0));
+                        osc.phase += osc.phase_inc;
+                    } else {
+                        x = nextOscillatorSample(&osc);
+                    }
+                    float g = nextEnvelopeSample(&env);
+                    x       = fmaxf(-1.0f, fminf(1.0f, x)) * fmaxf(0.0f, fminf(1.0f, g));
+                    s_ref[i * NCHANNELS] = s_ref[i * NCHANNELS + 1] = floatToInt16Sat(x);
+                }
+
+                char name[64];
+                snprintf(name, sizeof(name), "sub_%s_%dhz_env%d", sub_shapes[s].name,
+                         (int) sub_freqs[f], e);
+                bool sine = sub_shapes[s].waveform == SINE;
+                checkGolden(name, s_ref, sine ? SINE_LUT_MIN_SNR_DB : FLOAT_PATH_MIN_SNR_DB,
+                            sine ? SINE_LUT_MAX_PEAK : FLOAT_PATH_MAX_PEAK);
+            }
+        }
+    }
+}
+
+typedef struct {
+    FMAlgorithm algorithm;
+    float       freq, index, feedback;
+} FMPatch;
+
+static const FMPatch fm_patches[] = { { FM_ALGO_STACK, 110.0f, 2.0f, 0.0f },
+                                      { FM_ALGO_BRANCH, 440.0f, 4.0f, 0.5f },
+                                      { FM_ALGO_TWO_STACKS, 220.0f, 3.0f, 0.2f },
+                                      { FM_ALGO_ADDITIVE, 440.0f, 0.0f, 0.0f } };
+
+static void setupFM(FMSynth *fm, const FMPatch *patch, const EnvConfig *cfg) {
+    const float ratios[FM_OPERATORS] = { 1.0f, 1.0f, 2.0f, 3.0f };
+    const float levels[FM_OPERATORS] = { 1.0f, 0.8f, 0.6f, 0.4f };
+    initFMSynth(fm, SAMPLERATE);
+    FMSetAlgorithm(fm, patch->algorithm);
+    FMSetModIndex(fm, patch->index);
+    FMSetFeedback(fm, patch->feedback);
+    for (int op = 0; op < FM_OPERATORS; op++) {
+        fm->ops[op].env = makeEnvelope(cfg, SAMPLERATE);
+        FMSetOperator(fm, op, ratios[op], levels[op]);
+    }
+    FMSetFrequency(fm, patch->freq);
+    triggerFMSynth(fm);
+}
+
+void test_golden_fm_synth_sweep(void) {
+    initSineTable();
+    for (size_t p = 0; p < sizeof(fm_patches) / sizeof(fm_patches[0]); p++) {
+        for (int e = 0; e < N_ENV_CONFIGS; e++) {
+            FMSynth fm;
+            setupFM(&fm, &fm_patches[p], &env_configs[e]);
+            for (int pos = 0; pos < GOLDEN_FRAMES; pos += GOLDEN_BLOCK) {
+                renderFMSynthAudio(s_block, GOLDEN_BLOCK, &fm);
+                unpackFrames(s_block, &s_out[pos * NCHANNELS], GOLDEN_BLOCK);
+            }
+
+            // The per-sample path steps the envelopes one sample at a time
+            setupFM(&fm, &fm_patches[p], &env_configs[e]);
+            for (int i = 0; i < GOLDEN_FRAMES; i++) {
+                s16 x                = (s16) lrintf(nextFMOscillatorSample(&fm) * 32768.0f);
+                s_ref[i * NCHANNELS] = s_ref[i * NCHANNELS + 1] = x;
+            }
+
+            char name[64];
+            snprintf(name, sizeof(name), "fm4_%s_%dhz_env%d",
+                     fm_algorithm_names[fm_patches[p].algorithm], (int) fm_patches[p].freq, e);
+            checkGolden(name, s_ref, FLOAT_PATH_MIN_SNR_DB, FLOAT_PATH_MAX_PEAK);
+        }
+    }
+}
+
+static void setupSampler(Sampler *sampler, Sample *sample, Envelope *env, PlaybackMode mode,
+                         int64_t start, const EnvConfig *cfg) {
+    *env     = makeEnvelope(cfg, OPUSSAMPLERATE);
+    *sampler = (Sampler) { .sample          = sample,
+                           .playback_mode   = mode,
+                           .start_position  = start,
+                           .samples_per_buf = GOLDEN_BLOCK,
+                           .samplerate      = OPUSSAMPLERATE,
+                           .env             = env,
+                           .current_frame   = start / NCHANNELS };
+}
+
+void test_golden_sampler_sweep(void) {
+    // Fixed-seed noise burst with a decaying tone on top, shorter than the render
+    static int16_t pcm[GOLDEN_SAMPLE_FRAMES * NCHANNELS];
+    u32            seed = 12345;
+    for (int i = 0; i < GOLDEN_SAMPLE_FRAMES; i++) {
+        seed       = seed * 1664525u + 1013904223u;
+        float tone = sinf(i * 0.05f) * 20000.0f * (1.0f - (float) i / GOLDEN_SAMPLE_FRAMES);
+        pcm[i * NCHANNELS]     = (int16_t) (tone + (float) ((seed >> 16) % 8000) - 4000.0f);
+        pcm[i * NCHANNELS + 1] = (int16_t) (-tone);
+    }
+    Sample sample = { .pcm_data = pcm, .pcm_data_size_in_frames = GOLDEN_SAMPLE_FRAMES };
+
+    const PlaybackMode modes[]  = { ONE_SHOT, LOOP };
+    const int64_t      starts[] = { 0, GOLDEN_SAMPLE_FRAMES / 2 * NCHANNELS };
+    for (int m = 0; m < 2; m++) {
+        for (int s = 0; s < 2; s++) {
+            for (int e = 0; e < N_ENV_CONFIGS; e++) {
+                Sampler  sampler;
+                Envelope env;
+                setupSampler(&sampler, &sample, &env, modes[m], starts[s], &env_configs[e]);
+                for (int pos = 0; pos < GOLDEN_FRAMES; pos += GOLDEN_BLOCK) {
+                    renderSamplerAudio(s_block, GOLDEN_BLOCK, &sampler);
+                    unpackFrames(s_block, &s_out[pos * NCHANNELS], GOLDEN_BLOCK);
+                }
+
+                // Reference: the same frames scaled by the envelope in float
+                setupSampler(&sampler, &sample, &env, modes[m], starts[s], &env_configs[e]);
+                for (int i = 0; i < GOLDEN_FRAMES; i++) {
+                    float g = nextEnvelopeSample(&env);
+                    for (int c = 0; c < NCHANNELS; c++) {
+                        float x = sampler.finished
+                                      ? 0.0f
+                                      : int16ToFloat(pcm[sampler.current_frame * NCHANNELS + c]);
+                        s_ref[i * NCHANNELS + c] = floatToInt16Sat(x * g);
+                    }
+                    if (!sampler.finished && ++sampler.current_frame >= GOLDEN_SAMPLE_FRAMES) {
+                        sampler.current_frame = 0;
+                        sampler.finished      = modes[m] == ONE_SHOT;
+                    }
+                }
+
+                char name[64];
+                snprintf(name, sizeof(name), "sampler_%s_start%d_env%d",
+                         modes[m] == LOOP ? "loop" : "oneshot", (int) starts[s], e);
+                checkGolden(name, s_ref, FLOAT_PATH_MIN_SNR_DB, FLOAT_PATH_MAX_PEAK);
+            }
+        }
+    }
+}
+
+// The LFSR sequence is integer, only the envelope is float: no reference, the hash must match
+void test_golden_noise_synth_sweep(void) {
+    const u16 seeds[] = { 0x4000, 0x1234 };
+    for (int s = 0; s < 2; s++) {
+        for (int e = 0; e < N_ENV_CONFIGS; e++) {
+            Envelope   env   = makeEnvelope(&env_configs[e], SAMPLERATE);
+            NoiseSynth noise = { .env = &env, .lfsr_register = seeds[s] };
+            for (int pos = 0; pos < GOLDEN_FRAMES; pos += GOLDEN_BLOCK) {
+                renderNoiseSynthAudio(s_block, GOLDEN_BLOCK, &noise);
+                unpackFrames(s_block, &s_out[pos * NCHANNELS], GOLDEN_BLOCK);
+            }
+
+            char name[64];
+            snprintf(name, sizeof(name), "noise_seed%04x_env%d", seeds[s], e);
+            checkGolden(name, NULL, 0.0, 0);
+        }
+    }
+}
+
+void test_golden_compare_reports_snr_and_peak(void) {
+    s16 ref[4] = { 1000, -1000, 1000, -1000 };
+    s16 out[4] = { 1000, -1000, 1010, -1000 };
+
+    double snr_db;
+    int    peak;
+    compareSamples(ref, ref, 4, &snr_db, &peak);
+    TEST_ASSERT_TRUE(isinf(snr_db));
+    TEST_ASSERT_EQUAL_INT(0, peak);
+
+    compareSamples(out, ref, 4, &snr_db, &peak);
+    TEST_ASSERT_EQUAL_INT(10, peak);
+    TEST_ASSERT_TRUE(fabs(snr_db - 10.0 * log10(4.0e6 / 100.0)) < 1e-9);
+    TEST_ASSERT_TRUE(hashSamples(out, 4) != hashSamples(ref, 4));
+}
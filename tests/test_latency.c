@@ -0,0 +1,68 @@
+#include "mock_3ds.h"
+#include "engine_constants.h"
+#include "latency.h"
+#include "mix_bus.h"
+#include "unity.h"
+
+// Buffers are allocated once for LATENCY_MAX_QUEUED_MS, every profile has to fit in them
+void test_latency_profiles_fit_the_buffers(void) {
+    const float rates[] = { SAMPLERATE, OPUSSAMPLERATE };
+
+    for (int id = 0; id < LATENCY_PROFILE_COUNT; id++) {
+        const LatencyProfile *profile = &latency_profiles[id];
+        TEST_ASSERT_NOT_NULL(profile->name);
+        TEST_ASSERT_TRUE(profile->n_wavebufs >= 2 && profile->n_wavebufs <= MAX_WAVEBUFS);
+        TEST_ASSERT_TRUE(profile->block_ms * profile->n_wavebufs <= LATENCY_MAX_QUEUED_MS);
+        if (id > 0) {
+            // Stepping up after an underrun has to buy longer blocks
+            TEST_ASSERT_TRUE(profile->block_ms > latency_profiles[id - 1].block_ms);
+        }
+
+        for (int r = 0; r < 2; r++) {
+            // Whole frames, so every channel's blocks last exactly as long
+            u32 frames = latencyBlockFrames(id, rates[r]);
+            TEST_ASSERT_EQUAL_UINT32(rates[r] * profile->block_ms, frames * 1000);
+        }
+    }
+    TEST_ASSERT_EQUAL_UINT32(SAMPLESPERBUF, latencyBlockFrames(LATENCY_120MS, SAMPLERATE));
+}
+
+void test_mix_bus_latency_switch_reslices_the_buffer(void) {
+    static u32   audio[2 * MIXBUS_SAMPLESPERBUF];
+    static float accum[MIXBUS_SAMPLESPERBUF * NCHANNELS];
+    MixBus       bus;
+    initializeMixBus(&bus, MIXBUS_CHANNEL, MIXBUS_SAMPLERATE, MIXBUS_SAMPLESPERBUF, audio, accum);
+
+    mixBusSetLatency(&bus, LATENCY_10MS);
+    u32 frames = latencyBlockFrames(LATENCY_10MS, MIXBUS_SAMPLERATE);
+    TEST_ASSERT_EQUAL_UINT32(frames, bus.samples_per_buf);
+    TEST_ASSERT_EQUAL_INT(latency_profiles[LATENCY_10MS].n_wavebufs, bus.n_wavebufs);
+    for (int i = 0; i < bus.n_wavebufs; i++) {
+        TEST_ASSERT_EQUAL_PTR(&audio[i * frames], bus.waveBuf[i].data_vaddr);
+        TEST_ASSERT_EQUAL_UINT32(frames, bus.waveBuf[i].nsamples);
+        TEST_ASSERT_EQUAL_UINT8(NDSP_WBUF_QUEUED, bus.waveBuf[i].status);
+    }
+
+    // Blocks are filled round robin over all the wavebufs
+    for (int i = 0; i < bus.n_wavebufs; i++) {
+        TEST_ASSERT_EQUAL_INT(i, bus.fillBlock);
+        mixBusBegin(&bus);
+        mixBusSubmit(&bus);
+    }
+    TEST_ASSERT_EQUAL_INT(0, bus.fillBlock);
+
+    mixBusSetLatency(&bus, LATENCY_120MS);
+    TEST_ASSERT_EQUAL_UINT32(MIXBUS_SAMPLESPERBUF, bus.samples_per_buf);
+    TEST_ASSERT_EQUAL_PTR(&audio[MIXBUS_SAMPLESPERBUF], bus.waveBuf[1].data_vaddr);
+}
+
+void test_waveBufs_starved_only_when_all_have_played(void) {
+    ndspWaveBuf waveBufs[3] = { { .status = NDSP_WBUF_DONE },
+                                { .status = NDSP_WBUF_PLAYING },
+                                { .status = NDSP_WBUF_DONE } };
+    TEST_ASSERT_FALSE(waveBufsStarved(waveBufs, 3));
+    TEST_ASSERT_TRUE(waveBufsStarved(waveBufs, 1));
+
+    waveBufs[1].status = NDSP_WBUF_DONE;
+    TEST_ASSERT_TRUE(waveBufsStarved(waveBufs, 3));
+}
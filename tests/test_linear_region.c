@@ -0,0 +1,103 @@
+#include "linear_region.h"
+#include "mock_3ds.h"
+#include "sequencer.h"
+#include "track_arena.h"
+#include "unity.h"
+
+#include <stdint.h>
+
+// What the five tracks' arenas may hold of the linear heap between them
+#define INSTRUMENTS_BUDGET_BYTES (16 * 1024)
+// What the five tracks' patterns may hold of the ordinary heap: the edit copy, the snapshot
+// playing, one published after it and the spare, each about 55 KB
+#define SEQUENCER_BUDGET_BYTES (1200 * 1024)
+
+void test_linear_tags_track_usage_and_regions_bump(void) {
+    LinearUsage before = linearUsage(LINEAR_TAG_UI);
+
+    void *a = linearAllocTagged(LINEAR_TAG_UI, 100);
+    void *b = linearAllocTagged(LINEAR_TAG_UI, 28);
+    TEST_ASSERT_NOT_NULL(a);
+    TEST_ASSERT_NOT_NULL(b);
+    LinearUsage usage = linearUsage(LINEAR_TAG_UI);
+    TEST_ASSERT_EQUAL_UINT32(before.in_use + 128, usage.in_use);
+    TEST_ASSERT_EQUAL_UINT32(before.n_blocks + 2, usage.n_blocks);
+
+    linearFreeTagged(LINEAR_TAG_UI, a);
+    usage = linearUsage(LINEAR_TAG_UI);
+    TEST_ASSERT_EQUAL_UINT32(before.in_use + 28, usage.in_use);
+    TEST_ASSERT_TRUE(usage.peak >= before.in_use + 128);
+    linearUsageResetPeaks();
+    TEST_ASSERT_EQUAL_UINT32(usage.in_use, linearUsage(LINEAR_TAG_UI).peak);
+    linearFreeTagged(LINEAR_TAG_UI, b);
+
+    // Blocks come out aligned against the address until the region runs dry, a reset reuses it
+    LinearRegion region;
+    TEST_ASSERT_TRUE(linearRegionInit(&region, LINEAR_TAG_BUFFERS, 1024));
+    u8 *first  = linearRegionAlloc(&region, 10, 1);
+    u8 *second = linearRegionAlloc(&region, 300, 0x80);
+    TEST_ASSERT_NOT_NULL(first);
+    TEST_ASSERT_NOT_NULL(second);
+    TEST_ASSERT_EQUAL_UINT32(0, (uintptr_t) second % 0x80);
+    TEST_ASSERT_TRUE(second >= first + 10);
+    TEST_ASSERT_NULL(linearRegionAlloc(&region, 1024, 1));
+    TEST_ASSERT_NULL(linearRegionAlloc(&region, 8, 3));
+    linearRegionReset(&region);
+    TEST_ASSERT_EQUAL_PTR(first, linearRegionAlloc(&region, 10, 1));
+    linearRegionDestroy(&region);
+    TEST_ASSERT_NULL(region.base);
+
+    // A heap smaller than the request fails the allocation rather than the test process
+    linearMockSetCapacity(linearUsageTotal() + 64);
+    TEST_ASSERT_NULL(linearAllocTagged(LINEAR_TAG_SAMPLES, 128));
+    TEST_ASSERT_FALSE(linearRegionInit(&region, LINEAR_TAG_BUFFERS, 128));
+    linearMockSetCapacity(0);
+}
+
+void test_linear_track_arenas_fit_instrument_budget(void) {
+    const InstrumentType types[N_TRACKS] = { SUB_SYNTH, FM_SYNTH, OPUS_SAMPLER, OPUS_SAMPLER,
+                                             NOISE_SYNTH };
+    TrackArena           arenas[N_TRACKS];
+    LinearUsage          before = linearUsage(LINEAR_TAG_INSTRUMENTS);
+
+    linearUsageResetPeaks();
+    for (int i = 0; i < N_TRACKS; i++) {
+        TEST_ASSERT_TRUE(createTrackArena(&arenas[i], i, types[i], TRACK_ARENA_STEPS));
+    }
+    LinearUsage usage = linearUsage(LINEAR_TAG_INSTRUMENTS);
+    TEST_ASSERT_EQUAL_UINT32(before.n_blocks + N_TRACKS, usage.n_blocks);
+    TEST_ASSERT_TRUE(usage.peak - before.in_use <= INSTRUMENTS_BUDGET_BYTES);
+
+    for (int i = 0; i < N_TRACKS; i++) {
+        destroyTrackArena(&arenas[i]);
+    }
+    TEST_ASSERT_EQUAL_UINT32(before.in_use, linearUsage(LINEAR_TAG_INSTRUMENTS).in_use);
+}
+
+void test_sequencer_patterns_fit_budget_off_the_linear_heap(void) {
+    Sequencer      seqs[N_TRACKS];
+    StepParameters defaults = defaultStepParameters(0, SUB_SYNTH);
+    size_t         linear   = linearUsageTotal();
+    SequencerUsage before   = sequencerUsage();
+
+    sequencerUsageResetPeak();
+    for (int i = 0; i < N_TRACKS; i++) {
+        TEST_ASSERT_TRUE(initSequencer(&seqs[i], 16, &defaults));
+        // Edits played and reclaimed a few times over, with one left waiting to be picked up
+        for (int round = 0; round < 3; round++) {
+            TEST_ASSERT_TRUE(sequencerPublish(&seqs[i]));
+            updateSequencer(&seqs[i]);
+            sequencerReclaim(&seqs[i]);
+        }
+        TEST_ASSERT_TRUE(sequencerPublish(&seqs[i]));
+    }
+    SequencerUsage usage = sequencerUsage();
+    TEST_ASSERT_TRUE(usage.n_blocks - before.n_blocks <= 4 * N_TRACKS);
+    TEST_ASSERT_TRUE(usage.peak - before.in_use <= SEQUENCER_BUDGET_BYTES);
+    TEST_ASSERT_EQUAL_UINT32(linear, linearUsageTotal());
+
+    for (int i = 0; i < N_TRACKS; i++) {
+        cleanupSequencer(&seqs[i]);
+    }
+    TEST_ASSERT_EQUAL_UINT32(before.in_use, sequencerUsage().in_use);
+}
@@ -0,0 +1,65 @@
+#include "mock_3ds.h"
+#include "audio_simd.h"
+#include "engine_constants.h"
+#include "param_smoother.h"
+#include "sine_table.h"
+#include "unity.h"
+
+#include <math.h>
+#include <string.h>
+
+#define SMOOTHER_TEST_RATE 32000.0f
+#define SMOOTHER_TEST_FRAMES 400
+
+void test_pan_law_table_matches_cos_sin(void) {
+    initSineTable();
+    for (float pan = -1.0f; pan <= 1.0f; pan += 0.05f) {
+        float gain_l, gain_r;
+        float pan_rad = (pan + 1.0f) * (float) M_PI / 4.0f;
+        panLawGains(pan, 0.8f, &gain_l, &gain_r);
+        TEST_ASSERT_FLOAT_WITHIN(1e-4f, cosf(pan_rad) * 0.8f, gain_l);
+        TEST_ASSERT_FLOAT_WITHIN(1e-4f, sinf(pan_rad) * 0.8f, gain_r);
+    }
+}
+
+void test_gain_smoother_ramps_large_changes_only(void) {
+    static u32   frames[SMOOTHER_TEST_FRAMES];
+    static float mixed[SMOOTHER_TEST_FRAMES * NCHANNELS];
+    GainSmoother smoother, mixer;
+    initGainSmoother(&smoother, SMOOTHER_TEST_RATE, 1.0f, 1.0f);
+    u32 ramp_frames = smoother.ramp_frames;
+    TEST_ASSERT_EQUAL_UINT32(SMOOTHER_TEST_RATE * GAIN_RAMP_MS / 1000, ramp_frames);
+
+    // Repeats are free, small moves jump
+    TEST_ASSERT_FALSE(gainSmootherSetTarget(&smoother, 1.0f, 1.0f));
+    TEST_ASSERT_TRUE(gainSmootherSetTarget(&smoother, 0.999f, 1.0f));
+    TEST_ASSERT_FALSE(gainSmootherIsRamping(&smoother));
+    TEST_ASSERT_EQUAL_FLOAT(0.999f, smoother.gain[0]);
+
+    // A large move ramps without steps bigger than the ramp increment, split across calls
+    gainSmootherSetTarget(&smoother, 0.25f, 1.0f);
+    TEST_ASSERT_TRUE(gainSmootherIsRamping(&smoother));
+    mixer = smoother;
+    for (size_t i = 0; i < SMOOTHER_TEST_FRAMES; i++) {
+        frames[i] = packStereo16(16000, -16000);
+    }
+    memset(mixed, 0, sizeof(mixed));
+    mixGainSmoother(&mixer, mixed, frames, 7);
+    mixGainSmoother(&mixer, &mixed[7 * NCHANNELS], &frames[7], SMOOTHER_TEST_FRAMES - 7);
+    applyGainSmoother(&smoother, frames, 7);
+    applyGainSmoother(&smoother, &frames[7], SMOOTHER_TEST_FRAMES - 7);
+    TEST_ASSERT_FALSE(gainSmootherIsRamping(&smoother));
+    TEST_ASSERT_EQUAL_FLOAT(0.25f, smoother.gain[0]);
+    TEST_ASSERT_EQUAL_FLOAT(0.25f, mixer.gain[0]);
+
+    s16 prev     = 16000;
+    s32 max_step = (s32) (16000 * 0.75f / (float) ramp_frames) + 2;
+    for (size_t i = 0; i < SMOOTHER_TEST_FRAMES; i++) {
+        s16 left = (s16) (frames[i] & 0xFFFF);
+        TEST_ASSERT_TRUE(left <= prev && prev - left <= max_step);
+        TEST_ASSERT_EQUAL_INT16(-16000, (s16) (frames[i] >> 16));
+        TEST_ASSERT_FLOAT_WITHIN(2.0f / 32768.0f, left / 32768.0f, mixed[i * NCHANNELS]);
+        prev = left;
+    }
+    TEST_ASSERT_INT_WITHIN(1, 4000, (s16) (frames[ramp_frames] & 0xFFFF));
+}
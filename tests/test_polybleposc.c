@@ -0,0 +1,57 @@
+#include "mock_3ds.h"
+#include "polybleposc.h"
+#include "sine_table.h"
+#include "unity.h"
+
+#include <string.h>
+
+#define OSC_TEST_SAMPLES 4096
+
+// The block kernels and the per-sample path are generated from the same expressions, so any
+// block split has to give the same samples
+void test_oscillator_block_matches_per_sample(void) {
+    initSineTable();
+
+    static float expected[OSC_TEST_SAMPLES];
+    static float actual[OSC_TEST_SAMPLES];
+    const size_t blocks[] = { 1, 7, 64, OSC_TEST_SAMPLES };
+
+    for (int wf = 0; wf < WAVEFORM_COUNT; wf++) {
+        for (size_t b = 0; b < sizeof(blocks) / sizeof(blocks[0]); b++) {
+            PolyBLEPOscillator ref = { .samplerate = 32000.0f, .pulse_width = 0.3f };
+            setWaveform(&ref, wf);
+            setOscFrequency(&ref, 1234.5f);
+            PolyBLEPOscillator blk = ref;
+
+            for (int i = 0; i < OSC_TEST_SAMPLES; i++) {
+                expected[i] = nextOscillatorSample(&ref);
+            }
+            for (size_t pos = 0; pos < OSC_TEST_SAMPLES; pos += blocks[b]) {
+                size_t left = OSC_TEST_SAMPLES - pos;
+                renderOscillatorBlock(&blk, &actual[pos], left < blocks[b] ? left : blocks[b]);
+            }
+
+            TEST_ASSERT_EQUAL_MEMORY(expected, actual, sizeof(expected));
+            TEST_ASSERT_EQUAL_UINT32(ref.phase, blk.phase);
+        }
+    }
+}
+
+void test_oscillator_square_follows_pulse_width(void) {
+    initSineTable();
+
+    // Low frequency so the polyBLEP corrections only touch the samples next to each edge
+    PolyBLEPOscillator osc = { .samplerate = 32000.0f, .waveform = SQUARE, .pulse_width = 0.25f };
+    setOscFrequency(&osc, 100.0f);
+
+    float out[320];
+    renderOscillatorBlock(&osc, out, 320);
+
+    int high = 0;
+    for (int i = 0; i < 320; i++) {
+        high += out[i] > 0.0f;
+    }
+    TEST_ASSERT_INT_WITHIN(2, 80, high);
+    TEST_ASSERT_FLOAT_WITHIN(0.001f, 1.0f, out[40]);
+    TEST_ASSERT_FLOAT_WITHIN(0.001f, -1.0f, out[200]);
+}
@@ -10,20 +10,104 @@ void tearDown(void) {}
 // Declare test functions
 extern void test_sequence_length_update(void);
 extern void test_sequence_step_update(void);
+extern void test_sequencer_step_due_follows_subdivision(void);
+extern void test_sequencer_publishes_snapshots_between_steps(void);
+extern void test_sequencer_keeps_playing_while_cleanup_queue_is_full(void);
+extern void test_copy_step_field_copies_only_that_field(void);
+extern void test_copy_step_field_copies_filter_settings(void);
 extern void test_envelope_initialization(void);
 extern void test_envelope_trigger_and_release(void);
 extern void test_envelope_adsr_progression(void);
+extern void test_envelope_block_matches_per_sample_reference(void);
+extern void test_envelope_block_handles_null_envelope(void);
+
+// Sine table tests
+extern void test_sine_table_accuracy(void);
+extern void test_sine_oscillator_phase_wraps_without_drift(void);
+
+// Oscillator tests
+extern void test_oscillator_block_matches_per_sample(void);
+extern void test_oscillator_square_follows_pulse_width(void);
+
+// FM synth tests
+extern void test_fm_algorithms_route_to_operator_one(void);
+extern void test_fm_block_matches_per_sample_and_goes_idle(void);
+
+// Noise synth tests
+extern void test_noise_word_lfsr_matches_single_shift_reference(void);
+extern void test_noise_7bit_period_and_rate_divider(void);
+
+// State-variable filter tests
+extern void test_svf_fast_tan_tracks_tan(void);
+extern void test_svf_modes_shape_the_spectrum(void);
+extern void test_svf_envelope_opens_the_cutoff(void);
+
+// Parameter smoothing tests
+extern void test_pan_law_table_matches_cos_sin(void);
+extern void test_gain_smoother_ramps_large_changes_only(void);
+
+// Track arena tests
+extern void test_track_arena_lays_out_hot_then_cold_on_cache_lines(void);
+
+// Linear heap tests
+extern void test_linear_tags_track_usage_and_regions_bump(void);
+extern void test_linear_track_arenas_fit_instrument_budget(void);
+extern void test_sequencer_patterns_fit_budget_off_the_linear_heap(void);
+
+// Packed int16 kernel tests
+extern void test_simd_saturate_and_pack(void);
+extern void test_simd_float_to_stereo_matches_reference(void);
+extern void test_simd_stereo_gain_is_bit_exact(void);
+extern void test_simd_unity_gain_is_identity(void);
+
+// Silent track tests
+extern void test_idle_instruments_are_silent_and_render_zeros(void);
+extern void test_triggered_or_finished_instruments(void);
+extern void test_mix_bus_silence_skips_flush_and_keeps_bookkeeping(void);
+extern void test_sampler_past_the_end_is_finished(void);
+
+// Track block render tests
+extern void test_silent_track_blocks_are_skipped_and_counted(void);
+extern void test_scheduled_step_renders_a_silent_track(void);
+extern void test_resonant_filter_tail_is_not_skipped(void);
+
+// Golden audio tests
+extern void test_golden_subsynth_sweep(void);
+extern void test_golden_fm_synth_sweep(void);
+extern void test_golden_sampler_sweep(void);
+extern void test_golden_noise_synth_sweep(void);
+extern void test_golden_compare_reports_snr_and_peak(void);
+
+// Latency profile tests
+extern void test_latency_profiles_fit_the_buffers(void);
+extern void test_mix_bus_latency_switch_reslices_the_buffer(void);
+extern void test_waveBufs_starved_only_when_all_have_played(void);
+
+// Audio thread statistics tests
+extern void test_stats_buckets_cover_durations_in_order(void);
+extern void test_stats_percentiles_follow_recorded_durations(void);
+extern void test_stats_snapshot_rejects_writes_in_progress(void);
+extern void test_stats_load_is_busy_share_of_window(void);
 
 // Clock tests
-extern void test_setBpm_calculates_correct_ticks_per_step(void);
-extern void test_updateClock_should_not_tick_if_not_enough_time_has_passed(void);
-extern void test_updateClock_should_tick_and_update_musical_time(void);
-extern void test_updateClock_accumulator_handles_remainder(void);
-extern void test_updateClock_does_not_tick_when_stopped(void);
+extern void test_setBpm_calculates_correct_frames_per_step(void);
+extern void test_advanceClock_should_not_tick_if_not_enough_frames_have_passed(void);
+extern void test_advanceClock_should_tick_after_one_step_of_frames(void);
+extern void test_advanceClock_accumulator_handles_remainder(void);
+extern void test_setBpm_keeps_phase_across_tempo_change(void);
+extern void test_clockDisplayRead_skips_a_publish_in_progress(void);
+extern void test_advanceClock_places_ticks_within_one_sample(void);
+extern void test_advanceClock_does_not_tick_when_stopped(void);
+extern void test_advanceMusicalTime_rolls_beats_into_bars(void);
+
+// Step scheduler tests
+extern void test_step_scheduler_pops_in_tick_order(void);
+extern void test_step_scheduler_matches_polling_every_track(void);
 
 // Event queue tests
 extern void test_event_queue_init_should_set_head_and_tail_to_zero(void);
 extern void test_event_queue_push_and_pop_should_work_correctly(void);
+extern void test_event_queue_step_payloads_are_pooled(void);
 extern void test_event_queue_should_not_push_when_full(void);
 extern void test_event_queue_should_not_pop_when_empty(void);
 extern void test_event_queue_wraparound_should_work_correctly(void);
@@ -34,22 +118,106 @@ int main(void) {
     // Sequencer tests
     RUN_TEST(test_sequence_length_update);
     RUN_TEST(test_sequence_step_update);
+    RUN_TEST(test_sequencer_step_due_follows_subdivision);
+    RUN_TEST(test_sequencer_publishes_snapshots_between_steps);
+    RUN_TEST(test_sequencer_keeps_playing_while_cleanup_queue_is_full);
+    RUN_TEST(test_copy_step_field_copies_only_that_field);
+    RUN_TEST(test_copy_step_field_copies_filter_settings);
 
     // Envelope tests
     RUN_TEST(test_envelope_initialization);
     RUN_TEST(test_envelope_trigger_and_release);
     RUN_TEST(test_envelope_adsr_progression);
+    RUN_TEST(test_envelope_block_matches_per_sample_reference);
+    RUN_TEST(test_envelope_block_handles_null_envelope);
+
+    // Sine table tests
+    RUN_TEST(test_sine_table_accuracy);
+    RUN_TEST(test_sine_oscillator_phase_wraps_without_drift);
+
+    // Oscillator tests
+    RUN_TEST(test_oscillator_block_matches_per_sample);
+    RUN_TEST(test_oscillator_square_follows_pulse_width);
+
+    // FM synth tests
+    RUN_TEST(test_fm_algorithms_route_to_operator_one);
+    RUN_TEST(test_fm_block_matches_per_sample_and_goes_idle);
+
+    // Noise synth tests
+    RUN_TEST(test_noise_word_lfsr_matches_single_shift_reference);
+    RUN_TEST(test_noise_7bit_period_and_rate_divider);
+
+    // State-variable filter tests
+    RUN_TEST(test_svf_fast_tan_tracks_tan);
+    RUN_TEST(test_svf_modes_shape_the_spectrum);
+    RUN_TEST(test_svf_envelope_opens_the_cutoff);
+
+    // Parameter smoothing tests
+    RUN_TEST(test_pan_law_table_matches_cos_sin);
+    RUN_TEST(test_gain_smoother_ramps_large_changes_only);
+
+    // Track arena tests
+    RUN_TEST(test_track_arena_lays_out_hot_then_cold_on_cache_lines);
+
+    // Linear heap tests
+    RUN_TEST(test_linear_tags_track_usage_and_regions_bump);
+    RUN_TEST(test_linear_track_arenas_fit_instrument_budget);
+    RUN_TEST(test_sequencer_patterns_fit_budget_off_the_linear_heap);
+
+    // Packed int16 kernel tests
+    RUN_TEST(test_simd_saturate_and_pack);
+    RUN_TEST(test_simd_float_to_stereo_matches_reference);
+    RUN_TEST(test_simd_stereo_gain_is_bit_exact);
+    RUN_TEST(test_simd_unity_gain_is_identity);
+
+    // Silent track tests
+    RUN_TEST(test_idle_instruments_are_silent_and_render_zeros);
+    RUN_TEST(test_triggered_or_finished_instruments);
+    RUN_TEST(test_mix_bus_silence_skips_flush_and_keeps_bookkeeping);
+    RUN_TEST(test_sampler_past_the_end_is_finished);
+
+    // Track block render tests
+    RUN_TEST(test_silent_track_blocks_are_skipped_and_counted);
+    RUN_TEST(test_scheduled_step_renders_a_silent_track);
+    RUN_TEST(test_resonant_filter_tail_is_not_skipped);
+
+    // Golden audio tests
+    RUN_TEST(test_golden_subsynth_sweep);
+    RUN_TEST(test_golden_fm_synth_sweep);
+    RUN_TEST(test_golden_sampler_sweep);
+    RUN_TEST(test_golden_noise_synth_sweep);
+    RUN_TEST(test_golden_compare_reports_snr_and_peak);
+
+    // Latency profile tests
+    RUN_TEST(test_latency_profiles_fit_the_buffers);
+    RUN_TEST(test_mix_bus_latency_switch_reslices_the_buffer);
+    RUN_TEST(test_waveBufs_starved_only_when_all_have_played);
+
+    // Audio thread statistics tests
+    RUN_TEST(test_stats_buckets_cover_durations_in_order);
+    RUN_TEST(test_stats_percentiles_follow_recorded_durations);
+    RUN_TEST(test_stats_snapshot_rejects_writes_in_progress);
+    RUN_TEST(test_stats_load_is_busy_share_of_window);
 
     // Clock tests
-    RUN_TEST(test_setBpm_calculates_correct_ticks_per_step);
-    RUN_TEST(test_updateClock_should_not_tick_if_not_enough_time_has_passed);
-    RUN_TEST(test_updateClock_should_tick_and_update_musical_time);
-    RUN_TEST(test_updateClock_accumulator_handles_remainder);
-    RUN_TEST(test_updateClock_does_not_tick_when_stopped);
+    RUN_TEST(test_setBpm_calculates_correct_frames_per_step);
+    RUN_TEST(test_advanceClock_should_not_tick_if_not_enough_frames_have_passed);
+    RUN_TEST(test_advanceClock_should_tick_after_one_step_of_frames);
+    RUN_TEST(test_advanceClock_accumulator_handles_remainder);
+    RUN_TEST(test_setBpm_keeps_phase_across_tempo_change);
+    RUN_TEST(test_clockDisplayRead_skips_a_publish_in_progress);
+    RUN_TEST(test_advanceClock_places_ticks_within_one_sample);
+    RUN_TEST(test_advanceClock_does_not_tick_when_stopped);
+    RUN_TEST(test_advanceMusicalTime_rolls_beats_into_bars);
+
+    // Step scheduler tests
+    RUN_TEST(test_step_scheduler_pops_in_tick_order);
+    RUN_TEST(test_step_scheduler_matches_polling_every_track);
 
     // Event queue tests
     RUN_TEST(test_event_queue_init_should_set_head_and_tail_to_zero);
     RUN_TEST(test_event_queue_push_and_pop_should_work_correctly);
+    RUN_TEST(test_event_queue_step_payloads_are_pooled);
     RUN_TEST(test_event_queue_should_not_push_when_full);
     RUN_TEST(test_event_queue_should_not_pop_when_empty);
     RUN_TEST(test_event_queue_wraparound_should_work_correctly);
@@ -3,30 +3,187 @@
 #include "unity.h"
 
 void test_sequence_length_update(void) {
-    Sequencer seq = { .n_beats = 4, .steps_per_beat = 4 };
-    seq.steps     = linearAlloc((seq.n_beats * seq.steps_per_beat) * sizeof(SeqStep));
+    Sequencer      seq;
+    StepParameters defaults = defaultStepParameters(0, SUB_SYNTH);
+    TEST_ASSERT_TRUE(initSequencer(&seq, 16, &defaults));
+    StepParameters *params  = seq.edit->params;
+    params[15].track.volume = 0.5f;
+    patternSetStepActive(seq.edit, 15, true);
 
+    // Lengthening only changes the length: new steps are their own default records
+    SequencerUsage before = sequencerUsage();
+    updateSeqLength(&seq, 32);
+    TEST_ASSERT_EQUAL(8, seq.edit->n_beats);
+    TEST_ASSERT_EQUAL_PTR(params, seq.edit->params);
+    TEST_ASSERT_FALSE(patternStepActive(seq.edit, 31));
+    TEST_ASSERT_EQUAL_FLOAT(1.0f, seq.edit->params[31].track.volume);
+    seq.edit->params[31].track.volume = 0.25f;
+    TEST_ASSERT_EQUAL_FLOAT(1.0f, seq.edit->params[30].track.volume);
+
+    // Steps dropped and brought back are as they were left
     updateSeqLength(&seq, 8);
-    TEST_ASSERT_EQUAL(2, seq.n_beats);
+    TEST_ASSERT_EQUAL(2, seq.edit->n_beats);
+    TEST_ASSERT_NULL(patternStepParams(seq.edit, 15));
+    updateSeqLength(&seq, MAXSEQUENCELENGTH);
+    TEST_ASSERT_TRUE(patternStepActive(seq.edit, 15));
+    TEST_ASSERT_EQUAL_FLOAT(0.5f, seq.edit->params[15].track.volume);
+    TEST_ASSERT_EQUAL_FLOAT(0.25f, seq.edit->params[31].track.volume);
+    TEST_ASSERT_EQUAL_UINT32(before.n_blocks, sequencerUsage().n_blocks);
+
+    // Only the edit copy changed until it is published
+    TEST_ASSERT_EQUAL(16, patternLength(seq.playing));
+    TEST_ASSERT_TRUE(sequencerPublish(&seq));
+    updateSequencer(&seq);
+    TEST_ASSERT_EQUAL(MAXSEQUENCELENGTH, patternLength(seq.playing));
 
     cleanupSequencer(&seq);
 }
 
 void test_sequence_step_update(void) {
-    size_t    num_steps = 4;
-    Sequencer seq       = { .n_beats = 1, .steps_per_beat = 4, .cur_step = 0 };
-    seq.steps           = linearAlloc(num_steps * sizeof(SeqStep));
-
-    for (size_t i = 0; i < num_steps; i++) {
-        seq.steps[i].active = (i % 2 == 0); // steps 0 and 2 are active
+    Sequencer      seq;
+    StepParameters defaults = defaultStepParameters(2, FM_SYNTH);
+    TEST_ASSERT_TRUE(initSequencer(&seq, 4, &defaults));
+    for (size_t i = 0; i < 4; i++) {
+        patternSetStepActive(seq.edit, i, i % 2 == 0); // steps 0 and 2 are active
     }
+    seq.edit->params[0].instrument.fm_synth_params.carrier_freq = 110.0f;
+    TEST_ASSERT_TRUE(sequencerPublish(&seq));
 
-    SeqStep step = updateSequencer(&seq);
-    TEST_ASSERT_TRUE(step.active); // Should be step 0
+    const StepParameters *step = updateSequencer(&seq);
+    TEST_ASSERT_EQUAL_PTR(&seq.playing->params[0], step); // Should be step 0
     TEST_ASSERT_EQUAL(1, seq.cur_step);
-    step = updateSequencer(&seq);
-    TEST_ASSERT_FALSE(step.active); // Should be step 1
+    TEST_ASSERT_NULL(updateSequencer(&seq)); // Step 1 is off
     TEST_ASSERT_EQUAL(2, seq.cur_step);
 
+    TEST_ASSERT_EQUAL_FLOAT(110.0f, step->instrument.fm_synth_params.carrier_freq);
+
+    patternToggleStep(seq.edit, 1);
+    patternToggleStep(seq.edit, 2);
+    patternToggleStep(seq.edit, 4); // past the end, ignored
+    TEST_ASSERT_TRUE(patternStepActive(seq.edit, 1));
+    TEST_ASSERT_FALSE(patternStepActive(seq.edit, 2));
+    TEST_ASSERT_FALSE(patternStepActive(seq.edit, 4));
+    TEST_ASSERT_NULL(patternStepParams(seq.edit, 4));
+
     cleanupSequencer(&seq);
 }
+
+void test_sequencer_publishes_snapshots_between_steps(void) {
+    SequencerUsage before = sequencerUsage();
+    Sequencer      seq;
+    StepParameters defaults = defaultStepParameters(1, SUB_SYNTH);
+    TEST_ASSERT_TRUE(initSequencer(&seq, 4, &defaults));
+    const Pattern *first = seq.playing;
+
+    // Edits stay private until published, then the next step plays them
+    patternSetStepActive(seq.edit, 0, true);
+    TEST_ASSERT_FALSE(patternStepActive(seq.playing, 0));
+    TEST_ASSERT_TRUE(sequencerPublish(&seq));
+    TEST_ASSERT_EQUAL_PTR(first, seq.playing);
+    TEST_ASSERT_NOT_NULL(updateSequencer(&seq));
+    const Pattern *second = seq.playing;
+    TEST_ASSERT_TRUE(second != first);
+
+    // A snapshot superseded before the audio thread took it is reused straight away
+    TEST_ASSERT_TRUE(sequencerPublish(&seq));
+    Pattern *unseen = atomic_load(&seq.pending);
+    TEST_ASSERT_TRUE(sequencerPublish(&seq));
+    TEST_ASSERT_EQUAL_PTR(unseen, seq.spare);
+
+    // Snapshots played before come back through the cleanup queue; one spare is enough
+    sequencerReclaim(&seq);
+    updateSequencer(&seq);
+    sequencerReclaim(&seq);
+    TEST_ASSERT_EQUAL_PTR(unseen, seq.spare);
+    TEST_ASSERT_TRUE(sequencerPublish(&seq));
+    TEST_ASSERT_EQUAL_PTR(unseen, atomic_load(&seq.pending));
+    TEST_ASSERT_NULL(seq.spare);
+
+    cleanupSequencer(&seq);
+    TEST_ASSERT_EQUAL_UINT32(before.n_blocks, sequencerUsage().n_blocks);
+}
+
+void test_sequencer_keeps_playing_while_cleanup_queue_is_full(void) {
+    Sequencer      seq;
+    StepParameters defaults = defaultStepParameters(1, SUB_SYNTH);
+    TEST_ASSERT_TRUE(initSequencer(&seq, 4, &defaults));
+
+    // Never reclaimed, so the audio thread runs out of slots to retire snapshots into
+    for (int i = 0; i < SEQ_RETIRED_SLOTS - 1; i++) {
+        TEST_ASSERT_TRUE(sequencerPublish(&seq));
+        updateSequencer(&seq);
+        TEST_ASSERT_NULL(atomic_load(&seq.pending));
+    }
+    const Pattern *playing = seq.playing;
+    TEST_ASSERT_TRUE(sequencerPublish(&seq));
+    updateSequencer(&seq);
+    TEST_ASSERT_EQUAL_PTR(playing, seq.playing);
+    TEST_ASSERT_NOT_NULL(atomic_load(&seq.pending));
+
+    sequencerReclaim(&seq);
+    updateSequencer(&seq);
+    TEST_ASSERT_TRUE(playing != seq.playing);
+
+    cleanupSequencer(&seq);
+}
+
+void test_sequencer_step_due_follows_subdivision(void) {
+    Pattern   pattern = { .n_beats = 4, .steps_per_beat = 4 };
+    Sequencer seq     = { .playing = &pattern };
+    int       due     = 0;
+
+    // One beat of clock steps holds steps_per_beat sequencer steps, the first on clock step 1
+    TEST_ASSERT_TRUE(sequencerStepDue(&seq, 1));
+    for (int clock_step = 1; clock_step <= STEPS_PER_BEAT; clock_step++) {
+        due += sequencerStepDue(&seq, clock_step);
+    }
+    TEST_ASSERT_EQUAL(4, due);
+
+    pattern.steps_per_beat = 0;
+    TEST_ASSERT_FALSE(sequencerStepDue(&seq, 1));
+}
+
+void test_copy_step_field_copies_only_that_field(void) {
+    StepParameters src = defaultStepParameters(1, FM_SYNTH);
+    StepParameters dst = defaultStepParameters(1, FM_SYNTH);
+    src.track.volume                         = 0.25f;
+    src.track.pan                            = -0.5f;
+    src.instrument.fm_synth_params.mod_index = 0.9f;
+
+    copyStepField(&dst, &src, FM_SYNTH, STEP_FIELD_VOLUME);
+    TEST_ASSERT_EQUAL_FLOAT(0.25f, dst.track.volume);
+    TEST_ASSERT_EQUAL_FLOAT(0.0f, dst.track.pan);
+    TEST_ASSERT_EQUAL_FLOAT(0.25f, dst.instrument.fm_synth_params.mod_index);
+
+    copyStepField(&dst, &src, FM_SYNTH, STEP_FIELD_MOD_INDEX);
+    TEST_ASSERT_EQUAL_FLOAT(0.9f, dst.instrument.fm_synth_params.mod_index);
+
+    // A field the instrument does not have leaves the record alone
+    StepParameters sub = defaultStepParameters(0, SUB_SYNTH);
+    copyStepField(&sub, &src, SUB_SYNTH, STEP_FIELD_MOD_INDEX);
+    TEST_ASSERT_EQUAL_FLOAT(0.5f, sub.instrument.subsynth_params.pulse_width);
+}
+
+void test_copy_step_field_copies_filter_settings(void) {
+    StepParameters src = defaultStepParameters(2, OPUS_SAMPLER);
+    StepParameters dst = defaultStepParameters(2, OPUS_SAMPLER);
+    src.track.svf_mode       = SVF_BANDPASS;
+    src.track.svf_cutoff     = 800.0f;
+    src.track.svf_resonance  = 0.7f;
+    src.track.svf_env_amount = -2.0f;
+    src.track.svf_env_decay  = 350;
+
+    copyStepField(&dst, &src, OPUS_SAMPLER, STEP_FIELD_SVF_MODE);
+    TEST_ASSERT_EQUAL(SVF_BANDPASS, dst.track.svf_mode);
+    TEST_ASSERT_EQUAL_FLOAT(2000.0f, dst.track.svf_cutoff);
+
+    copyStepField(&dst, &src, OPUS_SAMPLER, STEP_FIELD_SVF_CUTOFF);
+    copyStepField(&dst, &src, OPUS_SAMPLER, STEP_FIELD_SVF_RESONANCE);
+    copyStepField(&dst, &src, OPUS_SAMPLER, STEP_FIELD_SVF_ENV_AMOUNT);
+    copyStepField(&dst, &src, OPUS_SAMPLER, STEP_FIELD_SVF_ENV_DECAY);
+    TEST_ASSERT_EQUAL_FLOAT(800.0f, dst.track.svf_cutoff);
+    TEST_ASSERT_EQUAL_FLOAT(0.7f, dst.track.svf_resonance);
+    TEST_ASSERT_EQUAL_FLOAT(-2.0f, dst.track.svf_env_amount);
+    TEST_ASSERT_EQUAL(350, dst.track.svf_env_decay);
+    TEST_ASSERT_EQUAL_FLOAT(0.0f, dst.track.pan);
+}
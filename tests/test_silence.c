@@ -0,0 +1,143 @@
+#include "mock_3ds.h"
+#include "engine_constants.h"
+#include "instrument.h"
+#include "mix_bus.h"
+#include "noise_synth.h"
+#include "samplers.h"
+#include "sine_table.h"
+#include "synth.h"
+#include "track_parameters.h"
+#include "unity.h"
+
+#include <string.h>
+
+#define SILENCE_TEST_SAMPLES 256
+
+static u32 s_buffer[SILENCE_TEST_SAMPLES];
+
+static ndspWaveBuf dirtyWaveBuf(void) {
+    memset(s_buffer, 0x5a, sizeof(s_buffer));
+    ndspWaveBuf waveBuf = { .data_vaddr = s_buffer };
+    return waveBuf;
+}
+
+static void assertBufferIsZero(void) {
+    for (int i = 0; i < SILENCE_TEST_SAMPLES; i++) {
+        TEST_ASSERT_EQUAL_HEX32(0, s_buffer[i]);
+    }
+}
+
+// Skipping a block is only lossless if rendering it would have produced zeros
+void test_idle_instruments_are_silent_and_render_zeros(void) {
+    initSineTable();
+
+    Envelope           env = defaultEnvelopeStruct(32000.0f);
+    PolyBLEPOscillator osc = { .samplerate = 32000.0f, .waveform = SAW };
+    setOscFrequency(&osc, 440.0f);
+
+    SubSynth subsynth = { .osc = &osc, .env = &env };
+    TEST_ASSERT_TRUE(isSubSynthSilent(&subsynth));
+    ndspWaveBuf waveBuf = dirtyWaveBuf();
+    fillSubSynthAudiobuffer(&waveBuf, SILENCE_TEST_SAMPLES, &subsynth);
+    assertBufferIsZero();
+
+    FMSynth fm_synth;
+    initFMSynth(&fm_synth, 32000.0f);
+    FMSetFrequency(&fm_synth, 220.0f);
+    TEST_ASSERT_TRUE(isFMSynthSilent(&fm_synth));
+    waveBuf = dirtyWaveBuf();
+    fillFMSynthAudiobuffer(&waveBuf, SILENCE_TEST_SAMPLES, &fm_synth);
+    assertBufferIsZero();
+
+    NoiseSynth noise = { .env = &env, .lfsr_register = 0x4000 };
+    TEST_ASSERT_TRUE(isNoiseSynthSilent(&noise));
+    waveBuf = dirtyWaveBuf();
+    fillNoiseSynthAudiobuffer(&waveBuf, SILENCE_TEST_SAMPLES, &noise);
+    assertBufferIsZero();
+
+    int16_t pcm[8 * NCHANNELS] = { 1000, -1000, 2000, -2000, 3000, -3000, 4000, -4000 };
+    Sample  sample             = { .pcm_data = pcm, .pcm_data_size_in_frames = 8 };
+    Sampler sampler            = { .sample          = &sample,
+                                   .playback_mode   = LOOP,
+                                   .samples_per_buf = SILENCE_TEST_SAMPLES,
+                                   .env             = &env };
+    TEST_ASSERT_TRUE(isSamplerSilent(&sampler));
+    waveBuf = dirtyWaveBuf();
+    fillSamplerAudioBuffer(&waveBuf, SILENCE_TEST_SAMPLES, &sampler);
+    assertBufferIsZero();
+}
+
+void test_triggered_or_finished_instruments(void) {
+    Envelope           env = defaultEnvelopeStruct(32000.0f);
+    PolyBLEPOscillator osc = { .samplerate = 32000.0f, .waveform = SQUARE };
+    SubSynth           subsynth = { .osc = &osc, .env = &env };
+    NoiseSynth         noise    = { .env = &env, .lfsr_register = 0x4000 };
+
+    triggerEnvelope(&env);
+    TEST_ASSERT_FALSE(isSubSynthSilent(&subsynth));
+    TEST_ASSERT_FALSE(isNoiseSynthSilent(&noise));
+
+    // A one-shot sample that has played out is silent even while its envelope still runs
+    int16_t pcm[2 * NCHANNELS] = { 0 };
+    Sample  sample             = { .pcm_data = pcm, .pcm_data_size_in_frames = 2 };
+    Sampler sampler = { .sample = &sample, .playback_mode = ONE_SHOT, .env = &env };
+    TEST_ASSERT_FALSE(isSamplerSilent(&sampler));
+    sampler.finished = true;
+    TEST_ASSERT_TRUE(isSamplerSilent(&sampler));
+
+    TEST_ASSERT_TRUE(isSubSynthSilent(NULL));
+    TEST_ASSERT_TRUE(isSamplerSilent(NULL));
+}
+
+void test_mix_bus_silence_skips_flush_and_keeps_bookkeeping(void) {
+    static u32   audio[2 * SILENCE_TEST_SAMPLES];
+    static float accum[SILENCE_TEST_SAMPLES * NCHANNELS];
+    static u32   silence[SILENCE_TEST_SAMPLES];
+    MixBus       bus;
+    initializeMixBus(&bus, MIXBUS_CHANNEL, 48000.0f, SILENCE_TEST_SAMPLES, audio, accum);
+
+    mock_reset_dsp_counters();
+    mixBusSubmitSilence(&bus, silence);
+    TEST_ASSERT_EQUAL_UINT32(0, mock_dsp_flush_count);
+    TEST_ASSERT_EQUAL_INT(1, bus.fillBlock);
+    TEST_ASSERT_EQUAL_PTR(silence, bus.waveBuf[0].data_vaddr);
+    TEST_ASSERT_EQUAL_UINT32(SILENCE_TEST_SAMPLES, bus.waveBuf[0].nsamples);
+
+    // Next time round the block renders into its own memory again
+    bus.fillBlock = 0;
+    mixBusBegin(&bus);
+    mixBusSubmit(&bus);
+    TEST_ASSERT_EQUAL_PTR(&audio[0], bus.waveBuf[0].data_vaddr);
+    TEST_ASSERT_EQUAL_UINT32(1, mock_dsp_flush_count);
+}
+
+// A start past the end of the sample, or a shorter sample swapped in while playing, must finish
+// the sampler instead of reading past its pcm data
+void test_sampler_past_the_end_is_finished(void) {
+    Envelope env = defaultEnvelopeStruct(32000.0f);
+    int16_t  pcm[4 * NCHANNELS];
+    for (size_t i = 0; i < 4 * NCHANNELS; i++) {
+        pcm[i] = 0x4000;
+    }
+    Sample  sample  = { .pcm_data = pcm, .pcm_data_size_in_frames = 4 };
+    Sampler sampler = { .sample = &sample, .playback_mode = ONE_SHOT, .env = &env };
+
+    OpusSamplerParameters params = { .playback_mode = ONE_SHOT, .start_position = 8 * NCHANNELS };
+    applyInstrumentStep(OPUS_SAMPLER, &sampler, &params, true);
+    TEST_ASSERT_TRUE(sampler.finished);
+    TEST_ASSERT_TRUE(isSamplerSilent(&sampler));
+
+    params.start_position = 0;
+    applyInstrumentStep(OPUS_SAMPLER, &sampler, &params, true);
+    TEST_ASSERT_FALSE(sampler.finished);
+
+    // Playing on from frame 3 of a sample that now only has 2
+    float mix[SILENCE_TEST_SAMPLES * NCHANNELS] = { 0 };
+    sampler.current_frame                        = 3;
+    sample.pcm_data_size_in_frames               = 2;
+    mixSamplerAudioBuffer(mix, SILENCE_TEST_SAMPLES, &sampler, 1.0f, 1.0f);
+    TEST_ASSERT_TRUE(sampler.finished);
+    for (size_t i = 0; i < SILENCE_TEST_SAMPLES * NCHANNELS; i++) {
+        TEST_ASSERT_EQUAL_FLOAT(0.0f, mix[i]);
+    }
+}
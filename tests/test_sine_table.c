@@ -0,0 +1,51 @@
+#include "mock_3ds.h"
+#include "polybleposc.h"
+#include "sine_table.h"
+#include "unity.h"
+
+#include <math.h>
+#include <stdio.h>
+
+#define ACCURACY_POINTS 1000003u
+
+// Q15 quantisation (1/65534) plus linear interpolation over 1024 entries (~4.7e-6), i.e. below
+// one LSB of the 16-bit output
+#define SINE_TABLE_MAX_ERROR 3.0e-5
+
+void test_sine_table_accuracy(void) {
+    initSineTable();
+
+    double max_err = 0.0;
+    double sum_sq  = 0.0;
+    u32    step    = (u32) (PHASE_RANGE / ACCURACY_POINTS);
+    u32    phase   = 12345;
+    for (u32 i = 0; i < ACCURACY_POINTS; i++) {
+        double expected = sin(2.0 * M_PI * (phase / 4294967296.0));
+        double err      = fabs(sineFromPhase(phase) - expected);
+        max_err         = err > max_err ? err : max_err;
+        sum_sq += err * err;
+        phase += step;
+    }
+
+    char report[128];
+    snprintf(report, sizeof(report), "sine table: max error %.2e (%.1f dB), rms error %.2e",
+             max_err, 20.0 * log10(max_err), sqrt(sum_sq / ACCURACY_POINTS));
+    TEST_MESSAGE(report);
+
+    TEST_ASSERT_LESS_THAN_FLOAT(SINE_TABLE_MAX_ERROR, max_err);
+}
+
+void test_sine_oscillator_phase_wraps_without_drift(void) {
+    initSineTable();
+
+    // 1 kHz at 32 kHz is exactly 2^27 per sample, so one second is a whole number of cycles
+    PolyBLEPOscillator osc = { .samplerate = 32000.0f, .waveform = SINE };
+    setOscFrequency(&osc, 1000.0f);
+    TEST_ASSERT_EQUAL_UINT32(1u << 27, osc.phase_inc);
+
+    for (int i = 0; i < 32000; i++) {
+        float expected = sinf(2.0f * (float) M_PI * (float) (i % 32) / 32.0f);
+        TEST_ASSERT_FLOAT_WITHIN(SINE_TABLE_MAX_ERROR, expected, nextOscillatorSample(&osc));
+    }
+    TEST_ASSERT_EQUAL_UINT32(0, osc.phase);
+}
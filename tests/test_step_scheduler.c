@@ -0,0 +1,68 @@
+#include "mock_3ds.h"
+#include "clock.h"
+#include "sequencer.h"
+#include "step_scheduler.h"
+#include "unity.h"
+
+void test_step_scheduler_pops_in_tick_order(void) {
+    StepScheduler sched;
+    stepSchedulerClear(&sched);
+    TEST_ASSERT_EQUAL(INT_MAX, stepSchedulerNextTick(&sched));
+
+    TEST_ASSERT_TRUE(stepSchedulerPush(&sched, 0, 7));
+    TEST_ASSERT_TRUE(stepSchedulerPush(&sched, 3, 4));
+    TEST_ASSERT_TRUE(stepSchedulerPush(&sched, 1, 4));
+    TEST_ASSERT_TRUE(stepSchedulerPush(&sched, 2, 13));
+    TEST_ASSERT_TRUE(stepSchedulerPush(&sched, 4, 1));
+    TEST_ASSERT_FALSE(stepSchedulerPush(&sched, 5, 1)); // one slot per track
+    TEST_ASSERT_EQUAL(1, stepSchedulerNextTick(&sched));
+
+    // Nothing past the tick asked for, ties in track order
+    TEST_ASSERT_EQUAL(4, stepSchedulerPopDue(&sched, 4));
+    TEST_ASSERT_EQUAL(1, stepSchedulerPopDue(&sched, 4));
+    TEST_ASSERT_EQUAL(3, stepSchedulerPopDue(&sched, 4));
+    TEST_ASSERT_EQUAL(-1, stepSchedulerPopDue(&sched, 4));
+    TEST_ASSERT_EQUAL(7, stepSchedulerNextTick(&sched));
+    TEST_ASSERT_EQUAL(0, stepSchedulerPopDue(&sched, 100));
+    TEST_ASSERT_EQUAL(2, stepSchedulerPopDue(&sched, 100));
+    TEST_ASSERT_EQUAL(-1, stepSchedulerPopDue(&sched, 100));
+}
+
+// Tracks on different subdivisions fire on the same clock steps polling every track would
+void test_step_scheduler_matches_polling_every_track(void) {
+    const int spb[N_TRACKS] = { 4, 3, 8, 1, 6 };
+    Pattern   patterns[N_TRACKS];
+    Sequencer seqs[N_TRACKS];
+    for (int t = 0; t < N_TRACKS; t++) {
+        patterns[t] = (Pattern) { .n_beats = 4, .steps_per_beat = spb[t] };
+        seqs[t]     = (Sequencer) { .playing = &patterns[t] };
+    }
+
+    StepScheduler sched;
+    stepSchedulerClear(&sched);
+    for (int t = 0; t < N_TRACKS; t++) {
+        stepSchedulerPush(&sched, t, 1);
+    }
+
+    int fired = 0;
+    for (int clock_step = 1; clock_step <= 4 * STEPS_PER_BEAT; clock_step++) {
+        bool due[N_TRACKS] = { false };
+        int  t;
+        while ((t = stepSchedulerPopDue(&sched, clock_step)) >= 0) {
+            due[t] = true;
+            stepSchedulerPush(&sched, t, sequencerNextStepTick(&seqs[t], clock_step));
+            fired++;
+        }
+        for (t = 0; t < N_TRACKS; t++) {
+            TEST_ASSERT_EQUAL(sequencerStepDue(&seqs[t], clock_step), due[t]);
+        }
+    }
+    TEST_ASSERT_EQUAL(4 * (4 + 3 + 8 + 1 + 6), fired);
+
+    // A subdivision change lands on the new grid, as polling would have it
+    patterns[0].steps_per_beat = 8;
+    TEST_ASSERT_EQUAL(4, sequencerNextStepTick(&seqs[0], 1));
+    TEST_ASSERT_EQUAL(7, sequencerNextStepTick(&seqs[0], 5));
+    patterns[0].steps_per_beat = 0;
+    TEST_ASSERT_EQUAL(0, sequencerNextStepTick(&seqs[0], 1));
+}
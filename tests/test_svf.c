@@ -0,0 +1,92 @@
+#include "mock_3ds.h"
+#include "audio_simd.h"
+#include "engine_constants.h"
+#include "svf.h"
+#include "unity.h"
+
+#include <math.h>
+#include <string.h>
+
+#define SVF_TEST_RATE 32000.0f
+#define SVF_TEST_FRAMES 2048
+
+void test_svf_fast_tan_tracks_tan(void) {
+    for (float x = 0.01f; x < (float) M_PI / 4.0f; x += 0.01f) {
+        TEST_ASSERT_FLOAT_WITHIN(1e-3f * tanf(x), tanf(x), SVFFastTan(x));
+    }
+    float nyquist_limit = (float) M_PI * 0.45f;
+    TEST_ASSERT_FLOAT_WITHIN(0.04f * tanf(nyquist_limit), tanf(nyquist_limit),
+                             SVFFastTan(nyquist_limit));
+}
+
+static void fillTone(u32 *frames, size_t n, float freq, float amplitude, float dc) {
+    for (size_t i = 0; i < n; i++) {
+        s32 s     = (s32) (dc + amplitude * sinf(2.0f * (float) M_PI * freq * i / SVF_TEST_RATE));
+        frames[i] = packStereo16(s, s);
+    }
+}
+
+// Mean absolute level of the left channel over the second half, once the filter has settled
+static float settledLevel(const u32 *frames, size_t n) {
+    float sum = 0.0f;
+    for (size_t i = n / 2; i < n; i++) {
+        sum += fabsf((float) (s16) (frames[i] & 0xFFFF));
+    }
+    return sum / (float) (n - n / 2);
+}
+
+void test_svf_modes_shape_the_spectrum(void) {
+    static u32 frames[SVF_TEST_FRAMES];
+    SVFilter   svf;
+
+    // Low-pass at 500 Hz: DC through, a 6 kHz tone mostly gone
+    initSVF(&svf, SVF_TEST_RATE);
+    SVFSetParams(&svf, SVF_LOWPASS, 500.0f, 0.0f, 0.0f, 100);
+    fillTone(frames, SVF_TEST_FRAMES, 6000.0f, 0.0f, 10000.0f);
+    processSVFFrames(&svf, frames, SVF_TEST_FRAMES);
+    TEST_ASSERT_FLOAT_WITHIN(20.0f, 10000.0f, settledLevel(frames, SVF_TEST_FRAMES));
+
+    initSVF(&svf, SVF_TEST_RATE);
+    SVFSetParams(&svf, SVF_LOWPASS, 500.0f, 0.0f, 0.0f, 100);
+    fillTone(frames, SVF_TEST_FRAMES, 6000.0f, 10000.0f, 0.0f);
+    processSVFFrames(&svf, frames, SVF_TEST_FRAMES);
+    TEST_ASSERT_LESS_THAN_FLOAT(100.0f, settledLevel(frames, SVF_TEST_FRAMES));
+
+    // High-pass takes the DC out, and the channels stay identical
+    initSVF(&svf, SVF_TEST_RATE);
+    SVFSetParams(&svf, SVF_HIGHPASS, 500.0f, 0.0f, 0.0f, 100);
+    fillTone(frames, SVF_TEST_FRAMES, 6000.0f, 0.0f, 10000.0f);
+    processSVFFrames(&svf, frames, SVF_TEST_FRAMES);
+    TEST_ASSERT_LESS_THAN_FLOAT(20.0f, settledLevel(frames, SVF_TEST_FRAMES));
+    for (size_t i = 0; i < SVF_TEST_FRAMES; i++) {
+        TEST_ASSERT_EQUAL_INT16((s16) (frames[i] & 0xFFFF), (s16) (frames[i] >> 16));
+    }
+
+    // Bypassed, the frames are left alone
+    u32 copy[SVF_TEST_FRAMES];
+    fillTone(frames, SVF_TEST_FRAMES, 6000.0f, 10000.0f, 0.0f);
+    memcpy(copy, frames, sizeof(copy));
+    SVFSetParams(&svf, SVF_OFF, 500.0f, 0.0f, 0.0f, 100);
+    processSVFFrames(&svf, frames, SVF_TEST_FRAMES);
+    TEST_ASSERT_EQUAL_MEMORY(copy, frames, sizeof(copy));
+}
+
+void test_svf_envelope_opens_the_cutoff(void) {
+    static u32 frames[SVF_TEST_FRAMES];
+    SVFilter   swept, fixed;
+    initSVF(&swept, SVF_TEST_RATE);
+    initSVF(&fixed, SVF_TEST_RATE);
+    SVFSetParams(&swept, SVF_LOWPASS, 300.0f, 0.0f, 4.0f, 1000);
+    SVFSetParams(&fixed, SVF_LOWPASS, 300.0f, 0.0f, 0.0f, 1000);
+    triggerSVF(&swept);
+    triggerSVF(&fixed);
+
+    // A 2 kHz tone gets through while the envelope holds the cutoff four octaves up
+    u32 other[SVF_TEST_FRAMES];
+    fillTone(frames, SVF_TEST_FRAMES, 2000.0f, 10000.0f, 0.0f);
+    memcpy(other, frames, sizeof(other));
+    processSVFFrames(&swept, frames, SVF_TEST_FRAMES);
+    processSVFFrames(&fixed, other, SVF_TEST_FRAMES);
+    TEST_ASSERT_GREATER_THAN_FLOAT(4.0f * settledLevel(other, SVF_TEST_FRAMES),
+                                   settledLevel(frames, SVF_TEST_FRAMES));
+}
@@ -0,0 +1,55 @@
+#include "mock_3ds.h"
+#include "noise_synth.h"
+#include "samplers.h"
+#include "synth.h"
+#include "track_arena.h"
+#include "unity.h"
+
+static bool inArena(const TrackArena *arena, const void *p) {
+    return (const u8 *) p >= arena->base && (const u8 *) p < arena->base + arena->size;
+}
+
+void test_track_arena_lays_out_hot_then_cold_on_cache_lines(void) {
+    const InstrumentType types[] = { SUB_SYNTH, OPUS_SAMPLER, FM_SYNTH, NOISE_SYNTH };
+    for (size_t t = 0; t < sizeof(types) / sizeof(types[0]); t++) {
+        TrackArena arena;
+        TEST_ASSERT_TRUE(createTrackArena(&arena, (int) t, types[t], TRACK_ARENA_STEPS));
+
+        size_t offsets[] = { arena.instrument, arena.osc, arena.env, arena.sequencer,
+                             arena.default_params };
+        for (size_t i = 0; i < sizeof(offsets) / sizeof(offsets[0]); i++) {
+            TEST_ASSERT_EQUAL_UINT32(0, offsets[i] % CACHE_LINE_BYTES);
+        }
+        TEST_ASSERT_TRUE(arena.osc < arena.sequencer && arena.env < arena.sequencer);
+
+        // The instrument's own pointers stay inside the block
+        void *instrument = trackArenaAt(&arena, arena.instrument);
+        if (types[t] == SUB_SYNTH) {
+            TEST_ASSERT_TRUE(inArena(&arena, ((SubSynth *) instrument)->osc));
+            TEST_ASSERT_TRUE(inArena(&arena, ((SubSynth *) instrument)->env));
+        } else if (types[t] == OPUS_SAMPLER) {
+            TEST_ASSERT_TRUE(inArena(&arena, ((Sampler *) instrument)->env));
+        } else if (types[t] == NOISE_SYNTH) {
+            TEST_ASSERT_TRUE(inArena(&arena, ((NoiseSynth *) instrument)->env));
+        }
+
+        // The steps are one dense table of default records, none playing yet, and the audio
+        // thread starts on a snapshot of them
+        Sequencer      *seq      = trackArenaAt(&arena, arena.sequencer);
+        StepParameters *defaults = trackArenaAt(&arena, arena.default_params);
+        TEST_ASSERT_EQUAL_INT(TRACK_ARENA_STEPS, patternLength(seq->edit));
+        TEST_ASSERT_NOT_NULL(seq->playing);
+        TEST_ASSERT_TRUE(seq->playing != seq->edit);
+        for (size_t i = 0; i < TRACK_ARENA_STEPS; i++) {
+            TEST_ASSERT_FALSE(patternStepActive(seq->playing, i));
+            TEST_ASSERT_EQUAL_INT((int) t, seq->edit->params[i].track.track_id);
+            TEST_ASSERT_EQUAL_FLOAT(defaults->track.svf_cutoff,
+                                    seq->playing->params[i].track.svf_cutoff);
+        }
+        TEST_ASSERT_TRUE(inArena(&arena, defaults));
+
+        destroyTrackArena(&arena);
+        TEST_ASSERT_NULL(arena.base);
+        destroyTrackArena(&arena);
+    }
+}
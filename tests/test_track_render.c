@@ -0,0 +1,116 @@
+#include "mock_3ds.h"
+#include "engine_constants.h"
+#include "sine_table.h"
+#include "synth.h"
+#include "track_render.h"
+#include "unity.h"
+
+#include <string.h>
+
+#define RENDER_TEST_FRAMES 256
+
+static Envelope           s_env;
+static PolyBLEPOscillator s_osc;
+static SubSynth           s_subsynth;
+
+// A sub synth track at unity gain, its envelope idle
+static Track idleSubSynthTrack(void) {
+    initSineTable();
+    s_env = defaultEnvelopeStruct(32000.0f);
+    s_osc = (PolyBLEPOscillator) { .samplerate = 32000.0f, .pulse_width = 0.5f };
+    setWaveform(&s_osc, SQUARE);
+    setOscFrequency(&s_osc, 220.0f);
+    s_subsynth = (SubSynth) { .osc = &s_osc, .env = &s_env };
+
+    Track track = { .instrument_type = SUB_SYNTH, .instrument_data = &s_subsynth };
+    initGainSmoother(&track.gain, 32000.0f, 1.0f, 1.0f);
+    initSVF(&track.svf, 32000.0f);
+    return track;
+}
+
+void test_silent_track_blocks_are_skipped_and_counted(void) {
+    Track         track    = idleSubSynthTrack();
+    TrackSchedule schedule = { 0 };
+    u32           block[RENDER_TEST_FRAMES];
+
+    for (u32 i = 1; i <= 3; i++) {
+        memset(block, 0x5a, sizeof(block));
+        TEST_ASSERT_FALSE(renderTrackBlock(&track, &schedule, block, RENDER_TEST_FRAMES,
+                                           applyTrackStep, renderTrackSegment));
+        TEST_ASSERT_EQUAL_UINT32(i, track.skipped_blocks);
+        TEST_ASSERT_EQUAL_UINT32(i, schedule.rendered_blocks);
+        TEST_ASSERT_EQUAL_HEX32(0x5a5a5a5a, block[0]); // left for the caller's silence buffer
+    }
+}
+
+// A step due in the block wakes the track: the block is rendered, silent up to the step only
+void test_scheduled_step_renders_a_silent_track(void) {
+    Track          track    = idleSubSynthTrack();
+    TrackSchedule  schedule = { .rendered_blocks = 1 };
+    StepParameters step     = defaultStepParameters(0, SUB_SYNTH);
+    u32            block[RENDER_TEST_FRAMES];
+
+    scheduleStep(&schedule, 1, 0x8000, SUB_SYNTH, &step);
+    TEST_ASSERT_FALSE(trackBlockIsSilent(&track, &schedule));
+    TEST_ASSERT_TRUE(renderTrackBlock(&track, &schedule, block, RENDER_TEST_FRAMES,
+                                      applyTrackStep, renderTrackSegment));
+    TEST_ASSERT_EQUAL_UINT32(0, track.skipped_blocks);
+    TEST_ASSERT_EQUAL_UINT32(2, schedule.rendered_blocks);
+    TEST_ASSERT_EQUAL_UINT32(schedule.tail, schedule.head);
+
+    size_t at      = clockOffsetToFrames(0x8000, RENDER_TEST_FRAMES);
+    bool   audible = false;
+    for (size_t i = 0; i < RENDER_TEST_FRAMES; i++) {
+        if (i < at) {
+            TEST_ASSERT_EQUAL_HEX32(0, block[i]);
+        } else {
+            audible |= block[i] != 0;
+        }
+    }
+    TEST_ASSERT_TRUE(audible);
+}
+
+// A resonant filter rings on after its instrument goes idle: the blocks holding the tail are
+// rendered, and skipping only starts once it has died away, with the filter left clear
+void test_resonant_filter_tail_is_not_skipped(void) {
+    Track          track    = idleSubSynthTrack();
+    TrackSchedule  schedule = { 0 };
+    StepParameters step     = defaultStepParameters(0, SUB_SYNTH);
+    u32            block[RENDER_TEST_FRAMES];
+
+    step.track.svf_mode                           = SVF_LOWPASS;
+    step.track.svf_cutoff                         = 500.0f;
+    step.track.svf_resonance                      = 1.0f;
+    step.instrument.subsynth_params.env_atk       = 1;
+    step.instrument.subsynth_params.env_dec       = 5;
+    step.instrument.subsynth_params.env_sus_level = 0.0f;
+    step.instrument.subsynth_params.env_rel       = 5;
+    step.instrument.subsynth_params.env_dur       = 10;
+    scheduleStep(&schedule, 0, 0, SUB_SYNTH, &step);
+
+    int rendered = 0;
+    do {
+        TEST_ASSERT_TRUE(renderTrackBlock(&track, &schedule, block, RENDER_TEST_FRAMES,
+                                          applyTrackStep, renderTrackSegment));
+    } while (!instrumentIsSilent(SUB_SYNTH, &s_subsynth) && ++rendered < 100);
+    TEST_ASSERT_TRUE(instrumentIsSilent(SUB_SYNTH, &s_subsynth));
+
+    // The instrument is done, the filter is not
+    TEST_ASSERT_FALSE(trackBlockIsSilent(&track, &schedule));
+    TEST_ASSERT_TRUE(renderTrackBlock(&track, &schedule, block, RENDER_TEST_FRAMES,
+                                      applyTrackStep, renderTrackSegment));
+    bool tail = false;
+    for (size_t i = 0; i < RENDER_TEST_FRAMES; i++) {
+        tail |= block[i] != 0;
+    }
+    TEST_ASSERT_TRUE(tail);
+
+    for (int i = 0; i < 1000 && !trackBlockIsSilent(&track, &schedule); i++) {
+        renderTrackBlock(&track, &schedule, block, RENDER_TEST_FRAMES, applyTrackStep,
+                         renderTrackSegment);
+    }
+    TEST_ASSERT_FALSE(renderTrackBlock(&track, &schedule, block, RENDER_TEST_FRAMES,
+                                       applyTrackStep, renderTrackSegment));
+    TEST_ASSERT_EQUAL_FLOAT(0.0f, track.svf.ic1eq[0]);
+    TEST_ASSERT_EQUAL_FLOAT(0.0f, track.svf.ic2eq[0]);
+}
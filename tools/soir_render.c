@@ -0,0 +1,490 @@
+// soir-render: offline renderer for the host. Plays the sequencer against a simulated sample clock
+// instead of the DSP, so a pattern can be bounced to WAV as fast as the CPU allows. Every track is
+// rendered on its own worker into a stem by the audio thread's own block render (track_render.h),
+// then the stems are summed into the mix, scaled by the mix gain (1/N_TRACKS unless -g says).
+//
+//   soir-render [-b bars] [-t bpm] [-o mix.wav] [-S stem_prefix] [-j jobs] [-g mix_gain]
+//               [-p track:x...x...] [-s track:sample.wav] [-f track:lp|bp|hp:cutoff[:env]]
+//
+// Runs at the mix bus rate (48 kHz) with the same block-quantised clock as the audio thread.
+// Sampler tracks play 16-bit PCM WAV files, as opus decoding is not available on the host.
+
+#include "clock.h"
+#include "engine_constants.h"
+#include "instrument.h"
+#include "param_smoother.h"
+#include "sequencer.h"
+#include "svf.h"
+#include "synth.h"
+#include "track_parameters.h"
+#include "track_render.h"
+
+#include <limits.h>
+#include <math.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define RENDER_RATE OPUSSAMPLERATE
+#define RENDER_BLOCK_FRAMES 1920 // 40 ms, the default latency profile's block
+#define RENDER_BEATS_PER_BAR 4
+#define RENDER_MAX_STEPS 64
+#define RENDER_MAX_JOBS 16
+
+static const InstrumentType track_types[N_TRACKS] = { SUB_SYNTH, FM_SYNTH, OPUS_SAMPLER,
+                                                      OPUS_SAMPLER, NOISE_SYNTH };
+static const char *default_patterns[N_TRACKS]     = { "x...x...x...x...", "..x...x...x..x..",
+                                                      "x.......x.......", "....x.......x...",
+                                                      "x.x.x.x.x.x.x.x." };
+
+typedef struct {
+    InstrumentType type;
+    const char    *pattern;
+    const char    *sample_path;
+
+    // Instrument state, one of these is live depending on type
+    Envelope           env;
+    PolyBLEPOscillator osc;
+    SubSynth           subsynth;
+    FMSynth            fm_synth;
+    Sampler            sampler;
+    NoiseSynth         noise_synth;
+    Sample             sample;
+    SVFMode            svf_mode; // from -f, applied to every step
+    float              svf_cutoff;
+    float              svf_env_amount;
+
+    Sequencer     seq;
+    Track         track; // instrument, filter and gains, rendered like the audio thread's
+    TrackSchedule schedule;
+
+    float *stem; // interleaved stereo, a whole number of blocks long
+    double render_sec;
+} RenderTrack;
+
+typedef struct {
+    RenderTrack *tracks;
+    float        bpm;
+    u32          n_blocks;
+    atomic_int   next_job;
+} RenderJobs;
+
+static double nowSeconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double) ts.tv_sec + (double) ts.tv_nsec * 1e-9;
+}
+
+static void putLE16(FILE *f, u16 v) {
+    fputc(v & 0xFF, f);
+    fputc(v >> 8, f);
+}
+
+static void putLE32(FILE *f, u32 v) {
+    putLE16(f, v & 0xFFFF);
+    putLE16(f, v >> 16);
+}
+
+static u32 getLE32(const u8 *p) {
+    return (u32) p[0] | ((u32) p[1] << 8) | ((u32) p[2] << 16) | ((u32) p[3] << 24);
+}
+
+static u16 getLE16(const u8 *p) {
+    return (u16) (p[0] | (p[1] << 8));
+}
+
+// Writes interleaved stereo float frames as a 16-bit PCM WAV, saturating at full scale. Samples
+// that had to be saturated are reported, as they are heard as clipping.
+static bool writeWav(const char *path, const float *frames, u32 n_frames) {
+    FILE *f = fopen(path, "wb");
+    if (!f) {
+        fprintf(stderr, "soir-render: cannot write %s\n", path);
+        return false;
+    }
+    u32 data_bytes = n_frames * NCHANNELS * sizeof(int16_t);
+    fwrite("RIFF", 1, 4, f);
+    putLE32(f, 36 + data_bytes);
+    fwrite("WAVEfmt ", 1, 8, f);
+    putLE32(f, 16);
+    putLE16(f, 1); // PCM
+    putLE16(f, NCHANNELS);
+    putLE32(f, RENDER_RATE);
+    putLE32(f, RENDER_RATE * NCHANNELS * sizeof(int16_t));
+    putLE16(f, NCHANNELS * sizeof(int16_t));
+    putLE16(f, 16);
+    fwrite("data", 1, 4, f);
+    putLE32(f, data_bytes);
+    u32 clipped = 0;
+    for (u32 i = 0; i < n_frames * NCHANNELS; i++) {
+        float s = frames[i] * 32767.0f;
+        if (s > 32767.0f || s < -32768.0f) {
+            s = s > 0.0f ? 32767.0f : -32768.0f;
+            clipped++;
+        }
+        putLE16(f, (u16) (int16_t) lrintf(s));
+    }
+    bool ok = !ferror(f);
+    fclose(f);
+    if (clipped > 0) {
+        fprintf(stderr, "soir-render: %s clips on %u of %u samples\n", path, clipped,
+                n_frames * NCHANNELS);
+    }
+    return ok;
+}
+
+// Loads a 16-bit PCM WAV into the sampler's interleaved stereo layout. Mono files are duplicated.
+static bool loadWavSample(const char *path, Sample *sample) {
+    FILE *f = fopen(path, "rb");
+    if (!f) {
+        fprintf(stderr, "soir-render: cannot open %s\n", path);
+        return false;
+    }
+    fseek(f, 0, SEEK_END);
+    long size = ftell(f);
+    fseek(f, 0, SEEK_SET);
+    u8 *file = malloc(size);
+    if (!file || fread(file, 1, size, f) != (size_t) size || size < 12 ||
+        memcmp(file, "RIFF", 4) || memcmp(file + 8, "WAVE", 4)) {
+        fprintf(stderr, "soir-render: %s is not a WAV file\n", path);
+        fclose(f);
+        free(file);
+        return false;
+    }
+    fclose(f);
+
+    u16       channels = 0, bits = 0, format = 0;
+    u32       rate     = 0;
+    const u8 *data     = NULL;
+    u32       data_len = 0;
+    for (long pos = 12; pos + 8 <= size;) {
+        u32 len = getLE32(file + pos + 4);
+        if (!memcmp(file + pos, "fmt ", 4) && len >= 16) {
+            format   = getLE16(file + pos + 8);
+            channels = getLE16(file + pos + 10);
+            rate     = getLE32(file + pos + 12);
+            bits     = getLE16(file + pos + 22);
+        } else if (!memcmp(file + pos, "data", 4)) {
+            data     = file + pos + 8;
+            data_len = (pos + 8 + (long) len <= size) ? len : (u32) (size - pos - 8);
+        }
+        pos += 8 + len + (len & 1);
+    }
+    if (format != 1 || bits != 16 || (channels != 1 && channels != NCHANNELS) || !data) {
+        fprintf(stderr, "soir-render: %s must be 16-bit PCM, mono or stereo\n", path);
+        free(file);
+        return false;
+    }
+    if (rate != RENDER_RATE) {
+        fprintf(stderr, "soir-render: %s is %u Hz, played back at %d Hz\n", path, rate,
+                RENDER_RATE);
+    }
+
+    size_t frames     = data_len / (channels * sizeof(int16_t));
+    sample->pcm_data  = malloc(frames * NCHANNELS * sizeof(int16_t));
+    sample->path      = (char *) path;
+    sample->ref_count = 1;
+    if (!sample->pcm_data) {
+        free(file);
+        return false;
+    }
+    for (size_t i = 0; i < frames; i++) {
+        for (int c = 0; c < NCHANNELS; c++) {
+            size_t src                          = i * channels + (channels == 1 ? 0 : c);
+            sample->pcm_data[i * NCHANNELS + c] = (int16_t) getLE16(data + src * 2);
+        }
+    }
+    sample->pcm_data_size_in_frames = frames;
+    sample->pcm_length              = frames;
+    free(file);
+    return true;
+}
+
+// Builds the instrument and its sequence the same way main does, at the render rate
+static bool setupTrack(RenderTrack *track, int track_id) {
+    float rate       = RENDER_RATE;
+    void *instrument = NULL;
+    track->env       = defaultEnvelopeStruct(rate);
+    updateEnvelope(&track->env, 20, 200, 0.6, 50, 300);
+
+    switch (track->type) {
+    case SUB_SYNTH:
+        track->osc      = (PolyBLEPOscillator) { .samplerate = rate, .pulse_width = 0.5f };
+        track->subsynth = (SubSynth) { .env = &track->env, .osc = &track->osc };
+        setWaveform(&track->osc, SQUARE);
+        setOscFrequency(&track->osc, 220.0f);
+        instrument        = &track->subsynth;
+        break;
+    case FM_SYNTH:
+        initFMSynth(&track->fm_synth, rate);
+        FMSetFrequency(&track->fm_synth, 220.0f);
+        for (int op = 0; op < FM_OPERATORS; op++) {
+            track->fm_synth.ops[op].env = track->env;
+        }
+        instrument = &track->fm_synth;
+        break;
+    case OPUS_SAMPLER:
+        track->sampler = (Sampler) { .env = &track->env, .samplerate = rate, .finished = true };
+        if (track->sample_path) {
+            if (!loadWavSample(track->sample_path, &track->sample)) {
+                return false;
+            }
+            track->sampler.sample = &track->sample;
+        }
+        instrument = &track->sampler;
+        break;
+    case NOISE_SYNTH:
+        track->noise_synth = (NoiseSynth) { .env = &track->env, .lfsr_register = 0x4000 };
+        instrument         = &track->noise_synth;
+        break;
+    }
+
+    size_t n_steps = strlen(track->pattern);
+    if (n_steps == 0 || n_steps > RENDER_MAX_STEPS || n_steps % 4 != 0) {
+        fprintf(stderr, "soir-render: track %d pattern must be 4..%d steps, a multiple of 4\n",
+                track_id, RENDER_MAX_STEPS);
+        return false;
+    }
+    StepParameters defaults = defaultStepParameters(track_id, track->type);
+    if (track->svf_mode != SVF_OFF) {
+        defaults.track.svf_mode       = track->svf_mode;
+        defaults.track.svf_cutoff     = track->svf_cutoff;
+        defaults.track.svf_env_amount = track->svf_env_amount;
+    }
+    if (!initSequencer(&track->seq, n_steps, &defaults)) {
+        fprintf(stderr, "soir-render: out of memory for track %d's pattern\n", track_id);
+        return false;
+    }
+    for (size_t i = 0; i < n_steps; i++) {
+        patternSetStepActive(track->seq.edit, i, track->pattern[i] == 'x');
+    }
+    sequencerPublish(&track->seq);
+    track->track = (Track) { .instrument_type = track->type,
+                             .instrument_data = instrument,
+                             .rate            = rate,
+                             .volume          = defaults.track.volume,
+                             .pan             = defaults.track.pan };
+    float gain_l, gain_r;
+    panLawGains(defaults.track.pan, defaults.track.volume, &gain_l, &gain_r);
+    initGainSmoother(&track->track.gain, rate, gain_l, gain_r);
+    initSVF(&track->track.svf, rate);
+    return true;
+}
+
+// Plays one track's sequence through its own clock, block by block, like the audio thread does
+static void renderTrack(RenderTrack *track, float bpm, u32 n_blocks) {
+    MusicalTime time  = { .beats_per_bar = RENDER_BEATS_PER_BAR };
+    Clock       clock = { .samplerate = RENDER_RATE, .barBeats = &time };
+    setBpm(&clock, bpm);
+    startClock(&clock);
+
+    u16 offsets[MAX_TICKS_PER_BLOCK];
+
+    int    next_step = 1; // clock step the sequencer's next step falls on
+    double start     = nowSeconds();
+    for (u32 block = 0; block < n_blocks; block++) {
+        int ticks = advanceClock(&clock, RENDER_BLOCK_FRAMES, offsets, MAX_TICKS_PER_BLOCK);
+        for (int i = 0; i < ticks; i++) {
+            advanceMusicalTime(&clock);
+            if (time.steps < next_step) {
+                continue;
+            }
+            const StepParameters *step = updateSequencer(&track->seq);
+            next_step                  = sequencerNextStepTick(&track->seq, time.steps);
+            next_step                  = next_step > 0 ? next_step : INT_MAX;
+            if (step && !track->track.is_muted) {
+                scheduleStep(&track->schedule, block, offsets[i], track->type, step);
+            }
+        }
+        float *dest = &track->stem[(size_t) block * RENDER_BLOCK_FRAMES * NCHANNELS];
+        renderTrackBlock(&track->track, &track->schedule, dest, RENDER_BLOCK_FRAMES,
+                         applyTrackStep, mixTrackSegment);
+    }
+    track->render_sec = nowSeconds() - start;
+}
+
+static void *renderWorker(void *arg) {
+    RenderJobs *jobs = (RenderJobs *) arg;
+    int         job;
+    while ((job = atomic_fetch_add(&jobs->next_job, 1)) < N_TRACKS) {
+        renderTrack(&jobs->tracks[job], jobs->bpm, jobs->n_blocks);
+    }
+    return NULL;
+}
+
+static int parseTrackArg(const char *arg, const char **value) {
+    char *end;
+    long  track = strtol(arg, &end, 10);
+    if (end == arg || *end != ':' || track < 0 || track >= N_TRACKS) {
+        return -1;
+    }
+    *value = end + 1;
+    return (int) track;
+}
+
+// "lp:800" or "hp:2000:-3", the optional last field being the envelope sweep in octaves
+static bool parseFilterArg(const char *value, RenderTrack *track) {
+    static const char *modes[] = { "lp", "bp", "hp" };
+    for (int m = 0; m < 3; m++) {
+        size_t len = strlen(modes[m]);
+        if (strncmp(value, modes[m], len) != 0 || value[len] != ':') {
+            continue;
+        }
+        char *end;
+        track->svf_mode   = SVF_LOWPASS + m;
+        track->svf_cutoff = strtof(value + len + 1, &end);
+        if (*end == ':') {
+            track->svf_env_amount = strtof(end + 1, &end);
+        }
+        return *end == '\0' && track->svf_cutoff > 0.0f;
+    }
+    return false;
+}
+
+static void usage(void) {
+    fprintf(stderr, "usage: soir-render [-b bars] [-t bpm] [-o mix.wav] [-S stem_prefix] "
+                    "[-j jobs] [-g mix_gain]\n"
+                    "                   [-p track:x...x...] [-s track:sample.wav]\n"
+                    "                   [-f track:lp|bp|hp:cutoff[:env_octaves]]\n");
+}
+
+int main(int argc, char **argv) {
+    static RenderTrack tracks[N_TRACKS];
+    int                bars        = 4;
+    float              bpm         = 127.0f;
+    int                n_jobs      = N_TRACKS;
+    float              mix_gain    = 1.0f / N_TRACKS; // every track at full scale stays in range
+    const char        *out_path    = "soir_render.wav";
+    const char        *stem_prefix = NULL;
+
+    for (int i = 0; i < N_TRACKS; i++) {
+        tracks[i].type    = track_types[i];
+        tracks[i].pattern = default_patterns[i];
+    }
+
+    for (int i = 1; i < argc; i++) {
+        const char *opt = argv[i];
+        if (opt[0] != '-' || opt[1] == '\0' || opt[2] != '\0' || i + 1 >= argc) {
+            usage();
+            return 1;
+        }
+        const char *arg = argv[++i];
+        const char *value;
+        int         track;
+        switch (opt[1]) {
+        case 'b':
+            bars = atoi(arg);
+            break;
+        case 't':
+            bpm = strtof(arg, NULL);
+            break;
+        case 'o':
+            out_path = arg;
+            break;
+        case 'S':
+            stem_prefix = arg;
+            break;
+        case 'j':
+            n_jobs = atoi(arg);
+            break;
+        case 'g':
+            mix_gain = strtof(arg, NULL);
+            break;
+        case 'p':
+        case 's':
+        case 'f':
+            if ((track = parseTrackArg(arg, &value)) < 0) {
+                usage();
+                return 1;
+            }
+            if (opt[1] == 'p') {
+                tracks[track].pattern = value;
+            } else if (opt[1] == 'f') {
+                if (!parseFilterArg(value, &tracks[track])) {
+                    usage();
+                    return 1;
+                }
+            } else if (tracks[track].type == OPUS_SAMPLER) {
+                tracks[track].sample_path = value;
+            } else {
+                fprintf(stderr, "soir-render: track %d is not a sampler\n", track);
+                return 1;
+            }
+            break;
+        default:
+            usage();
+            return 1;
+        }
+    }
+    if (bars <= 0 || bpm < 20.0f || bpm > 200.0f || mix_gain <= 0.0f) {
+        fprintf(stderr, "soir-render: need bars > 0, 20 <= bpm <= 200 and mix_gain > 0\n");
+        return 1;
+    }
+    n_jobs = n_jobs < 1 ? 1 : (n_jobs > RENDER_MAX_JOBS ? RENDER_MAX_JOBS : n_jobs);
+
+    initSineTable();
+    u32 total_frames = (u32) lrint(bars * RENDER_BEATS_PER_BAR * 60.0 / bpm * RENDER_RATE);
+    u32 n_blocks     = (total_frames + RENDER_BLOCK_FRAMES - 1) / RENDER_BLOCK_FRAMES;
+    for (int i = 0; i < N_TRACKS; i++) {
+        tracks[i].stem = calloc((size_t) n_blocks * RENDER_BLOCK_FRAMES * NCHANNELS, sizeof(float));
+        if (!tracks[i].stem || !setupTrack(&tracks[i], i)) {
+            return 1;
+        }
+    }
+
+    RenderJobs jobs = { .tracks = tracks, .bpm = bpm, .n_blocks = n_blocks };
+    atomic_init(&jobs.next_job, 0);
+    pthread_t workers[RENDER_MAX_JOBS];
+    double    start = nowSeconds();
+    for (int i = 0; i < n_jobs; i++) {
+        pthread_create(&workers[i], NULL, renderWorker, &jobs);
+    }
+    for (int i = 0; i < n_jobs; i++) {
+        pthread_join(workers[i], NULL);
+    }
+    double render_sec = nowSeconds() - start;
+
+    float *mix = calloc((size_t) total_frames * NCHANNELS, sizeof(float));
+    if (!mix) {
+        return 1;
+    }
+    for (int t = 0; t < N_TRACKS; t++) {
+        for (size_t i = 0; i < (size_t) total_frames * NCHANNELS; i++) {
+            mix[i] += tracks[t].stem[i] * mix_gain;
+        }
+        if (stem_prefix) {
+            char path[512];
+            snprintf(path, sizeof(path), "%s_track%d.wav", stem_prefix, t);
+            if (!writeWav(path, tracks[t].stem, total_frames)) {
+                return 1;
+            }
+        }
+    }
+    if (!writeWav(out_path, mix, total_frames)) {
+        return 1;
+    }
+    float peak = 0.0f;
+    for (size_t i = 0; i < (size_t) total_frames * NCHANNELS; i++) {
+        peak = fabsf(mix[i]) > peak ? fabsf(mix[i]) : peak;
+    }
+
+    double audio_sec = (double) total_frames / RENDER_RATE;
+    printf("rendered %d bars at %.1f bpm: %.2f s of audio in %.3f s (%.1fx realtime, %d jobs)\n",
+           bars, bpm, audio_sec, render_sec, audio_sec / render_sec, n_jobs);
+    printf("  mix gain %.3f, peak %.1f dBFS\n", mix_gain, 20.0f * log10f(peak + 1e-9f));
+    for (int t = 0; t < N_TRACKS; t++) {
+        printf("  track %d  %-16s  %8.1fx realtime  %4lu/%lu blocks skipped\n", t,
+               tracks[t].pattern, audio_sec / tracks[t].render_sec,
+               (unsigned long) tracks[t].track.skipped_blocks, (unsigned long) n_blocks);
+    }
+
+    for (int t = 0; t < N_TRACKS; t++) {
+        free(tracks[t].stem);
+        cleanupSequencer(&tracks[t].seq);
+        free(tracks[t].sample.pcm_data);
+    }
+    free(mix);
+    return 0;
+}